@@ -1,13 +1,178 @@
+/*
+A simple header include library like Sean Barret's stb libraries. 
+
+Flip book animation for 2d sprites. An animation is a list of frames, and a controller plays a queue of animations one after the other.
+A frame is a 32 bit id you give each sprite when you load them (an EasyAnimation_Frame), so finding what to draw is an array index
+rather than looking up a texture from a file name every frame.
+
+You have to #define EASY_ANIMATION_2D_IMPLEMENTATION before including the file to add the implementation part of it. 
+It uses easy_string_utf8.h to compare names, so define EASY_STRING_IMPLEMENTATION somewhere too.
+
+////////////////////////////////////////////////////////////////////
+
+How to use:
+
+////////////////////////////////////////////////////////////////////
+
+easyAnimation_initAnimation(Animation *animation, EasyAnimation_Frame *frames, int frameCount, EasyAnimation_Uv *uvs, char *name) 
+	- copies the frames, and the uvs if they aren't null (one for each frame, where it is in its atlas). The name isn't copied.
+easyAnimation_freeAnimation(Animation *animation) - frees the copies. Not for animations made with the _arena version.
+easyAnimation_initController(EasyAnimation_Controller *controller)
+
+easyAnimation_addAnimationToController(controller, &freeList, animation, period) - queue an animation, period is the seconds each frame is shown for
+easyAnimation_updateAnimation(controller, &freeList, dt, NextAnimation, period) - call every frame, returns the frame to draw. 
+NextAnimation (can be null) takes over once the frame that's showing finishes.
+Time left over from a frame carries on into the next one, and a dt longer than a frame skips however many frames it covers, 
+so animations keep time with the game when the frame rate drops. A period of 0 or less moves on one frame each update.
+easyAnimation_getUvOn(controller) - the uv of the frame showing, null if the animation has no uvs
+
+The frame ids are yours to pick. The usual thing is an index into a table of your sprites, or easyAnimation_makeFrame(atlas, sprite) 
+to put which atlas it's in in the top 8 bits. If you load animations by file name, turn the names into ids once when you load them:
+
+	EasyAnimation_Frame frames[8];
+	for(int i = 0; i < frameCount; ++i) { frames[i] = findSprite(&atlas, fileNames[i]); }
+	easyAnimation_initAnimation(&walkAnimation, frames, frameCount, 0, "walk");
+
+	//every frame
+	EasyAnimation_Frame frame = easyAnimation_updateAnimation(&controller, &freeList, dt, 0, 0);
+	drawSprite(&atlas.sprites[frame], position);
+
+The list items the controller uses are kept on your free list (an EasyAnimation_ListItem * that starts null) when they're done with, 
+so after a while nothing is allocated.
+
+////////////////////////////////////////////////////////////////////
+With an arena (see easy_arena.h):
+
+easyAnimation_initAnimation_arena(EasyArena *arena, animation, frames, frameCount, uvs, name) - the copy of the uvs comes out of the arena
+easyAnimation_addAnimationToController_arena(EasyArena *arena, controller, animation, period)
+easyAnimation_updateAnimation_arena(EasyArena *arena, controller, dt, NextAnimation, period)
+
+The list items come out of the arena instead of a free list, so a controller only used with the _arena functions 
+is all freed by resetting the arena. Call easyAnimation_initController on it again after the reset.
+Don't mix the two on the same controller, the free list would end up holding arena memory.
+
+	EasyArena frameArena = {0};
+	EasyAnimation_Controller hitEffect;
+
+	while(running) {
+		easyAnimation_initController(&hitEffect);
+		easyAnimation_addAnimationToController_arena(&frameArena, &hitEffect, &sparksAnimation, 0.05f);
+		EasyAnimation_Frame frame = easyAnimation_updateAnimation_arena(&frameArena, &hitEffect, dt, 0, 0);
+		...
+		easyArena_reset(&frameArena);
+	}
+
+////////////////////////////////////////////////////////////////////
+Events:
+
+To find out when an animation gets to a frame (i.e. a footstep or the frame a hit lands) without checking every controller, 
+give the controller (or the world) an EasyAnimation_EventBuffer, and the updates add an EasyAnimation_Event to it for:
+
+EASY_ANIMATION_EVENT_FRAME - moved on to frameIndex. count is how many frames it moved, more than 1 if it skipped some, 
+	so the frames it went past are the count before frameIndex (going round the end).
+EASY_ANIMATION_EVENT_LOOPED - went past the end and back round to the start, count times
+EASY_ANIMATION_EVENT_FINISHED - stopped playing on frameIndex because NextAnimation took over. A FRAME event for what's playing now comes after it.
+
+Empty the buffer (set count to 0) when you've gone through it. Events that don't fit are left out and counted in dropped.
+
+	EasyAnimation_Event events[256];
+	EasyAnimation_EventBuffer eventBuffer = {events, 0, 256, 0};
+	easyAnimation_initController(&player.controller);
+	player.controller.events = &eventBuffer;
+	player.controller.id = playerId; //put in each event, so you know whose it is
+
+	//every frame
+	eventBuffer.count = 0;
+	easyAnimation_updateAnimation(&player.controller, &freeList, dt, 0, 0);
+	for(int i = 0; i < eventBuffer.count; ++i) { 
+		if(events[i].type == EASY_ANIMATION_EVENT_FRAME && events[i].animation == attackAnimation && events[i].frameIndex == 3) { ... }
+	}
+
+easyAnimation_initController and easyAnimation_initWorld clear them, so set them after.
+
+////////////////////////////////////////////////////////////////////
+Lots of animations:
+
+Loading every animation with easyAnimation_initAnimation gives each one its own allocation for its frames. 
+An EasyAnimation_Library packs all their frames into one pool instead, and each Animation is a range of it (frameOffset, frameCount). 
+The names go in a hash table, so finding one by name doesn't go through the other animations.
+
+easyAnimation_initLibrary(EasyAnimation_Library *library, int frameCapacity) - frameCapacity is how many frames to make room for, 
+	0 for the default. If you know the total when you load, the pool is only allocated once.
+easyAnimation_addToLibrary(library, name, frames, frameCount, uvs) - copies the frames (and uvs if not null) into the pool and returns the Animation. 
+	The name isn't copied.
+easyAnimation_addManyToLibrary(library, EasyAnimation_LibraryEntry *entries, int count) - the same for lots at once, only grows things once
+easyAnimation_findInLibrary(library, name) - null if there isn't one
+easyAnimation_findIdInLibrary(library, name) - -1 if there isn't one. Ids go up from 0 in the order they were added.
+easyAnimation_getFromLibrary(library, id)
+easyAnimation_replaceInLibrary(library, name, frames, frameCount, uvs) - for hot reloading. The Animation keeps its address and id and gets the new frames.
+easyAnimation_freeLibrary(library)
+
+Names should be different, replace an animation rather than adding it again. 
+The Animation pointers stay good until the library is freed, even when the pool grows or they're replaced, so you can keep them in 
+controllers and worlds. Controllers and worlds playing one that's replaced pick up the new frames on their next update, and start 
+again from the first frame if the one they were on isn't there anymore.
+
+Look names up when you load and keep the ids (or Animation pointers), so nothing has to hash a string every frame. 
+
+	EasyAnimation_Library library;
+	easyAnimation_initLibrary(&library, totalFrames);
+	for(int i = 0; i < animationCount; ++i) { easyAnimation_addToLibrary(&library, loaded[i].name, loaded[i].frames, loaded[i].frameCount, 0); }
+	...
+	int walkId = easyAnimation_findIdInLibrary(&library, "walk");
+	...
+	easyAnimation_addAnimationToController(&controller, &freeList, easyAnimation_getFromLibrary(&library, walkId), 0.1f);
+
+For animations that come in a direction each, an EasyAnimation_Directions finds them all when you load, 
+and then picking one from a velocity is a table lookup:
+
+easyAnimation_initDirections(EasyAnimation_Directions *directions, library, baseName, char **suffixes, int count) 
+	- finds baseName + suffix for each suffix, going anticlockwise from +x like easyAnimation_getDirectionInRadians (y is up). 
+	Returns how many it found, the ones missing are null.
+easyAnimation_getDirectionAnimation(directions, x, y) - the animation for the direction closest to (x, y). (0, 0) is +x.
+
+	char *compass[4] = {"_E", "_N", "_W", "_S"};
+	EasyAnimation_Directions walk;
+	easyAnimation_initDirections(&walk, &library, "walk", compass, 4);
+	...
+	Animation *next = easyAnimation_getDirectionAnimation(&walk, velocity.x, -velocity.y); //screen y is down
+
+////////////////////////////////////////////////////////////////////
+Lots of sprites at once:
+
+If you've got thousands of things animating, put them in an EasyAnimation_World instead of giving each one a controller. 
+It keeps what each one is playing in flat arrays (one array per field) and moves them all on with one loop, 
+rather than following each controller's list to its animation.
+
+easyAnimation_initWorld(EasyAnimation_World *world)
+easyAnimation_addToWorld(world, animation, period) - returns the id. It loops the animation, period is the seconds each frame is shown for.
+easyAnimation_setWorldAnimation(world, id, animation, period) - switch to another animation straight away, from its first frame
+easyAnimation_removeFromWorld(world, id) - the id gets used again by the next easyAnimation_addToWorld
+easyAnimation_updateWorld(world, dt) - call every frame, then world->frameOn[id] is the frame to draw for each one. 
+	It keeps time the same way as easyAnimation_updateAnimation. With world->events set the ids are the world ids.
+	(and world->animation[id]->uvs[world->frameIndex[id]] its uv, if the animation has uvs)
+easyAnimation_freeWorld(world)
+
+	for(int i = 0; i < enemyCount; ++i) { enemies[i].animationId = easyAnimation_addToWorld(&world, &walkAnimation, 0.1f); }
+
+	//every frame
+	easyAnimation_updateWorld(&world, dt);
+	for(int i = 0; i < enemyCount; ++i) { drawSprite(world.frameOn[enemies[i].animationId], enemies[i].position); }
+
+The arrays come from EASY_HEADERS_ALLOC/EASY_HEADERS_FREE and double in size when they fill up.
+Without events the update goes 4 at a time with SSE2. With events it goes one at a time, so only give a world events if you need them.
+
+*/
 #ifndef EASY_ANIMATION_2D_H
-#define EASY_STRING_UTF8_H
+#define EASY_ANIMATION_2D_H
 
 
 #ifndef EASY_ANIMATION_2D_IMPLEMENTATION
-#define EASY_STRING_IMPLEMENTATION 0
+#define EASY_ANIMATION_2D_IMPLEMENTATION 0
 #endif
 
-#ifndef EASY_HEADERS_EASY_HEADERS_ASSERT
-#define EASY_HEADERS_EASY_HEADERS_ASSERT(statement) if(!(statement)) { int *i_ptr = 0; *(i_ptr) = 0; }
+#ifndef EASY_HEADERS_ASSERT
+#define EASY_HEADERS_ASSERT(statement) if(!(statement)) { int *i_ptr = 0; *(i_ptr) = 0; }
 #endif
 
 #ifndef EASY_HEADERS_ALLOC
@@ -20,8 +185,41 @@
 #define EASY_HEADERS_FREE(ptr) free(ptr)
 #endif
 
+#include <math.h>
+#include <string.h>
+
+#include "easy_arena.h"
+#include "easy_string_utf8.h"
+
+#define easyAnimation_arrayCount(array1) (sizeof(array1) / sizeof(array1[0]))
+
+//NOTE: every x64 cpu has SSE2, so unlike easy_string there's no checking the cpu at runtime. #define EASY_ANIMATION_NO_SIMD to leave it out.
+#if !defined(EASY_ANIMATION_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define EASY_ANIMATION_SSE2 1
+#include <emmintrin.h>
+#else
+#define EASY_ANIMATION_SSE2 0
+#endif
+
+//NOTE: whatever id you use for the sprite, e.g. an index into your own table of sprites
+typedef unsigned int EasyAnimation_Frame;
+
+//NOTE: what a removed id in an EasyAnimation_World shows
+#define EASY_ANIMATION_NO_FRAME 0xFFFFFFFF
+
+//NOTE: for ids of sprites packed into atlases, the atlas goes in the top 8 bits and the sprite in the bottom 24
+#define easyAnimation_makeFrame(atlas, sprite) ((EasyAnimation_Frame)(((unsigned int)(atlas) << 24) | ((unsigned int)(sprite) & 0xFFFFFF)))
+#define easyAnimation_frameAtlas(frame) ((unsigned int)(frame) >> 24)
+#define easyAnimation_frameSprite(frame) ((unsigned int)(frame) & 0xFFFFFF)
+
 typedef struct {
-    char *frames[256];
+    float minU, minV, maxU, maxV;
+} EasyAnimation_Uv;
+
+typedef struct {
+    EasyAnimation_Frame *frames; //frameCount of them, in a library's pool or allocated by easyAnimation_initAnimation
+    EasyAnimation_Uv *uvs; //one for each frame, null if there aren't any
+    int frameOffset; //where the frames start in the library's pool, 0 if it isn't in one
     int frameCount;
     char *name;
 }  Animation;
@@ -39,23 +237,116 @@ typedef struct EasyAnimation_ListItem {
     EasyAnimation_ListItem *next;
 } EasyAnimation_ListItem;
 
+typedef enum {
+    EASY_ANIMATION_EVENT_FRAME,
+    EASY_ANIMATION_EVENT_LOOPED,
+    EASY_ANIMATION_EVENT_FINISHED,
+} EasyAnimation_EventType;
+
+typedef struct {
+    Animation *animation;
+    int id; //the controller's id, or the world id
+    int frameIndex;
+    int count; //frames moved on for EASY_ANIMATION_EVENT_FRAME, times round for EASY_ANIMATION_EVENT_LOOPED
+    EasyAnimation_EventType type;
+} EasyAnimation_Event;
+
+//NOTE: you own the events array
+typedef struct {
+    EasyAnimation_Event *events;
+    int count;
+    int capacity;
+    int dropped; //how many didn't fit
+} EasyAnimation_EventBuffer;
+
+//NOTE: the most frames an update can move on, so a huge dt can't overflow the frame index. The rest of the time is kept for the next update.
+#ifndef EASY_ANIMATION_MAX_SKIP
+#define EASY_ANIMATION_MAX_SKIP 1048576.0f
+#endif
+
 typedef struct {
     EasyAnimation_ListItem parent;
+
+    EasyAnimation_EventBuffer *events; //can be null
+    int id;
 } EasyAnimation_Controller;
 
+//NOTE: the frames of every animation in one pool, and the names kept apart from the animations
+typedef struct {
+    int count;
+    int capacity;
+    char **names;
+    unsigned int *nameHashes; //so a lookup only compares strings when the hashes match
+    Animation **animations; //the Animations are allocated in blocks of EASY_ANIMATION_LIBRARY_BLOCK that never move
+
+    int *slots; //the hash table, id + 1 for each slot in use and 0 for empty
+    int slotCount; //a power of two, at least twice count
+
+    int frameCount;
+    int frameCapacity;
+    EasyAnimation_Frame *frames;
+    EasyAnimation_Uv *uvs; //null until an animation with uvs is added
+} EasyAnimation_Library;
+
+#ifndef EASY_ANIMATION_LIBRARY_BLOCK
+#define EASY_ANIMATION_LIBRARY_BLOCK 64
+#endif
+
+//NOTE: for easyAnimation_addManyToLibrary
+typedef struct {
+    char *name;
+    EasyAnimation_Frame *frames;
+    int frameCount;
+    EasyAnimation_Uv *uvs; //can be null
+} EasyAnimation_LibraryEntry;
+
+#ifndef EASY_ANIMATION_MAX_DIRECTIONS
+#define EASY_ANIMATION_MAX_DIRECTIONS 16
+#endif
+
+typedef struct {
+    int count;
+    Animation *animations[EASY_ANIMATION_MAX_DIRECTIONS]; //anticlockwise from +x
+} EasyAnimation_Directions;
+
+//NOTE: Everything is an array with an entry for each id, so the update is one straight loop over each of them
+typedef struct {
+    int count; //ids go from 0 to count - 1, including removed ones
+    int capacity;
+    int firstFree; //removed ids to use again, -1 when there are none
+
+    float *timerAt;
+    float *timerPeriod;
+    int *frameIndex;
+    int *frameCount;
+    Animation **animation;
+    int *nextFree;
+
+    EasyAnimation_Frame *frameOn; //filled in by easyAnimation_updateWorld, the frame each one is showing
+
+    EasyAnimation_EventBuffer *events; //can be null
+} EasyAnimation_World;
+
 ///////////////////////************ Header definitions start here *************////////////////////
 
 //Constructor functions
 void easyAnimation_initController(EasyAnimation_Controller *controller);
-void easyAnimation_initAnimation(Animation *animation, char **FileNames, int FileNameCount, char *name);
+void easyAnimation_initAnimation(Animation *animation, EasyAnimation_Frame *frames, int frameCount, EasyAnimation_Uv *uvs, char *name);
+void easyAnimation_initAnimation_arena(EasyArena *arena, Animation *animation, EasyAnimation_Frame *frames, int frameCount, EasyAnimation_Uv *uvs, char *name);
+void easyAnimation_freeAnimation(Animation *animation);
 
 
 //Two workhorse functions
 void easyAnimation_addAnimationToController(EasyAnimation_Controller *controller, EasyAnimation_ListItem **AnimationItemFreeListPtr, Animation *animation, float period);
-char *easyAnimation_updateAnimation(EasyAnimation_Controller *controller, EasyAnimation_ListItem **AnimationItemFreeListPtr, float dt, Animation *NextAnimation, float period);
+EasyAnimation_Frame easyAnimation_updateAnimation(EasyAnimation_Controller *controller, EasyAnimation_ListItem **AnimationItemFreeListPtr, float dt, Animation *NextAnimation, float period);
+
+//The same but the list items come out of an arena, so they're all freed when it's reset
+void easyAnimation_addAnimationToController_arena(EasyArena *arena, EasyAnimation_Controller *controller, Animation *animation, float period);
+EasyAnimation_Frame easyAnimation_updateAnimation_arena(EasyArena *arena, EasyAnimation_Controller *controller, float dt, Animation *NextAnimation, float period);
 
 //Get the animation the controller is currently on
-char *easyAnimation_getFrameOn(EasyAnimation_ListItem *AnimationListSentintel);
+EasyAnimation_Frame easyAnimation_getFrameOn(EasyAnimation_ListItem *AnimationListSentintel);
+EasyAnimation_Uv *easyAnimation_getUvOn(EasyAnimation_ListItem *AnimationListSentintel);
 
 //Helper functions
 //Find an animation in a list
@@ -69,46 +360,136 @@ void easyAnimation_emptyAnimationContoller(EasyAnimation_Controller *controller,
 //Get the direction in radians of velocity. This could be used to find the correct animation
 float easyAnimation_getDirectionInRadians(float x, float y);
 
-#if EASY_ANIMATION_2D_IMPLEMENTATION
+//Lots of animations with their frames in one pool
+void easyAnimation_initLibrary(EasyAnimation_Library *library, int frameCapacity);
+void easyAnimation_freeLibrary(EasyAnimation_Library *library);
+Animation *easyAnimation_addToLibrary(EasyAnimation_Library *library, char *name, EasyAnimation_Frame *frames, int frameCount, EasyAnimation_Uv *uvs);
+void easyAnimation_addManyToLibrary(EasyAnimation_Library *library, EasyAnimation_LibraryEntry *entries, int count);
+Animation *easyAnimation_findInLibrary(EasyAnimation_Library *library, char *name);
+int easyAnimation_findIdInLibrary(EasyAnimation_Library *library, char *name);
+Animation *easyAnimation_getFromLibrary(EasyAnimation_Library *library, int id);
+Animation *easyAnimation_replaceInLibrary(EasyAnimation_Library *library, char *name, EasyAnimation_Frame *frames, int frameCount, EasyAnimation_Uv *uvs);
 
-static char *easyAnimation2d_copyString(char *str) {
+//Pick an animation by which way something's going
+int easyAnimation_initDirections(EasyAnimation_Directions *directions, EasyAnimation_Library *library, char *baseName, char **suffixes, int count);
+Animation *easyAnimation_getDirectionAnimation(EasyAnimation_Directions *directions, float x, float y);
 
-    int sizeOfString = 0;
-    unsigned char *at = (char *)str;
-    while(*at) {
-        sizeOfString++;
-        at++;
-    }
+//Lots of animations updated together
+void easyAnimation_initWorld(EasyAnimation_World *world);
+void easyAnimation_freeWorld(EasyAnimation_World *world);
+int easyAnimation_addToWorld(EasyAnimation_World *world, Animation *animation, float period);
+void easyAnimation_setWorldAnimation(EasyAnimation_World *world, int id, Animation *animation, float period);
+void easyAnimation_removeFromWorld(EasyAnimation_World *world, int id);
+void easyAnimation_updateWorld(EasyAnimation_World *world, float dt);
 
-    char *result = EASY_HEADERS_ALLOC(sizeOfString + 1);
-    result[sizeOfString] = '\0';
+#if EASY_ANIMATION_2D_IMPLEMENTATION
 
-    //Now copy the string
-    char *src = (char *)str;
-    char *dest = (char *)dest;
-    while(*src) {
-        *dest = *src;
-        src++;
-        dest++;
+//NOTE: from the arena if there is one, otherwise EASY_HEADERS_ALLOC
+static void *easyAnimation2d_copy(EasyArena *arena, void *data, size_t size) {
+    void *result = 0;
+    if(arena) {
+        result = easyArena_push(arena, size, EASY_ARENA_DEFAULT_ALIGNMENT);
+    } else {
+        result = EASY_HEADERS_ALLOC(size);
     }
+    EASY_HEADERS_ASSERT(result);
+
+    memcpy(result, data, size);
 
     return result;
 }
 
-static void easyAnimation_initController(EasyAnimation_Controller *controller) {
+void easyAnimation_initController(EasyAnimation_Controller *controller) {
     controller->parent.next = controller->parent.prev = &controller->parent;
+    controller->events = 0;
+    controller->id = 0;
+}
+
+static void easyAnimation_pushEvent_(EasyAnimation_EventBuffer *buffer, EasyAnimation_EventType type, int id, Animation *animation, int frameIndex, int count) {
+    if(buffer) {
+        if(buffer->count < buffer->capacity) {
+            EasyAnimation_Event *event = buffer->events + buffer->count++;
+            event->animation = animation;
+            event->id = id;
+            event->frameIndex = frameIndex;
+            event->count = count;
+            event->type = type;
+        } else {
+            buffer->dropped++;
+        }
+    }
+}
+
+//NOTE: how many frames the timer has gone past. Takes them off the timer so what's left carries on into the next frame.
+//More than one is a divide, so a long dt costs the same as a short one.
+static int easyAnimation_framesPassed_(float *timerAt, float period) {
+    int result = 0;
+    float timer = *timerAt;
+    if(period <= 0) {
+        //NOTE: a frame every update, like before there was any skipping
+        result = 1;
+        timer = 0;
+    } else if(timer >= period) {
+        //NOTE: nearly always just the one, so it only divides when it's more
+        result = 1;
+        if(timer >= 2.0f*period) {
+            float steps = timer / period;
+            if(!(steps < EASY_ANIMATION_MAX_SKIP)) steps = EASY_ANIMATION_MAX_SKIP;
+            result = (int)steps;
+        }
+        timer -= (float)result*period;
+        if(timer < 0) timer = 0; //rounding
+    }
+    *timerAt = timer;
+    return result;
 }
 
-static void easyAnimation_initAnimation(Animation *animation, char **FileNames, int FileNameCount, char *name) {
+//NOTE: moves the item on however many frames the timer's gone past, going round to the start when it gets to the end
+static void easyAnimation_advanceItem_(EasyAnimation_Controller *controller, EasyAnimation_ListItem *Item) {
+    int steps = easyAnimation_framesPassed_(&Item->timerAt, Item->timerPeriod);
+    if(steps > 0) {
+        int frameCount = Item->animation->frameCount;
+        int index = Item->frameIndex + steps;
+        int loops = index / frameCount;
+        Item->frameIndex = index - loops*frameCount;
+        if(loops > 0) {
+            easyAnimation_pushEvent_(controller->events, EASY_ANIMATION_EVENT_LOOPED, controller->id, Item->animation, Item->frameIndex, loops);
+        }
+        easyAnimation_pushEvent_(controller->events, EASY_ANIMATION_EVENT_FRAME, controller->id, Item->animation, Item->frameIndex, steps);
+    }
+}
+
+static void easyAnimation_initAnimation_(EasyArena *arena, Animation *animation, EasyAnimation_Frame *frames, int frameCount, EasyAnimation_Uv *uvs, char *name) {
+    EASY_HEADERS_ASSERT(frameCount > 0);
+
     animation->name = name;
-    animation->frameCount = 0;
+    animation->frameOffset = 0;
+    animation->frameCount = frameCount;
+    animation->frames = (EasyAnimation_Frame *)easyAnimation2d_copy(arena, frames, frameCount*sizeof(EasyAnimation_Frame));
 
-    for(int i = 0; i < FileNameCount; ++i) {
-        EASY_HEADERS_ASSERT(animation->frameCount < arrayCount(animation->frames));
-        animation->frames[animation->frameCount++] = easyAnimation2d_copyString(FileNames[i]);
+    animation->uvs = 0;
+    if(uvs) {
+        animation->uvs = (EasyAnimation_Uv *)easyAnimation2d_copy(arena, uvs, frameCount*sizeof(EasyAnimation_Uv));
     }
 }
 
+void easyAnimation_initAnimation(Animation *animation, EasyAnimation_Frame *frames, int frameCount, EasyAnimation_Uv *uvs, char *name) {
+    easyAnimation_initAnimation_(0, animation, frames, frameCount, uvs, name);
+}
+
+void easyAnimation_initAnimation_arena(EasyArena *arena, Animation *animation, EasyAnimation_Frame *frames, int frameCount, EasyAnimation_Uv *uvs, char *name) {
+    EASY_HEADERS_ASSERT(arena);
+    easyAnimation_initAnimation_(arena, animation, frames, frameCount, uvs, name);
+}
+
+void easyAnimation_freeAnimation(Animation *animation) {
+    if(animation->frames) EASY_HEADERS_FREE(animation->frames);
+    if(animation->uvs) EASY_HEADERS_FREE(animation->uvs);
+    animation->frames = 0;
+    animation->uvs = 0;
+    animation->frameCount = 0;
+}
+
 // static Animation *easyAnimation_findAnimationWithId(Animation *animations, int AnimationsCount, int id) {
 //     Animation *Result = 0;
 //     for(int i = 0; i < AnimationsCount; i++) {
@@ -122,7 +503,7 @@ static void easyAnimation_initAnimation(Animation *animation, char **FileNames,
 //     return Result;
 // }
 
-static Animation *easyAnimation_findAnimation(Animation *Animations, int AnimationsCount, char *name) {
+Animation *easyAnimation_findAnimation(Animation *Animations, int AnimationsCount, char *name) {
     Animation *Result = 0;
     for(int i = 0; i < AnimationsCount; ++i) {
         Animation *Anim = Animations + i;
@@ -135,13 +516,14 @@ static Animation *easyAnimation_findAnimation(Animation *Animations, int Animati
     return Result;
 }
 
-
-static void easyAnimation_addAnimationToController(EasyAnimation_Controller *controller, EasyAnimation_ListItem **AnimationItemFreeListPtr, Animation *animation, float period) {
-    EasyAnimation_ListItem *AnimationItemFreeList = *AnimationItemFreeListPtr;
+//NOTE: With an arena the item comes out of it and the free list isn't touched
+static void easyAnimation_addAnimationToController_(EasyAnimation_Controller *controller, EasyArena *arena, EasyAnimation_ListItem **AnimationItemFreeListPtr, Animation *animation, float period) {
     EasyAnimation_ListItem *Item = 0;
-    if(AnimationItemFreeList) {
-        Item = AnimationItemFreeList;
-        *AnimationItemFreeListPtr = AnimationItemFreeList->next;
+    if(arena) {
+        Item = easyArena_pushStruct(arena, EasyAnimation_ListItem);
+    } else if(*AnimationItemFreeListPtr) {
+        Item = *AnimationItemFreeListPtr;
+        *AnimationItemFreeListPtr = Item->next;
     } else {
         Item = (EasyAnimation_ListItem *)EASY_HEADERS_ALLOC(sizeof(EasyAnimation_ListItem));
     }
@@ -166,7 +548,16 @@ static void easyAnimation_addAnimationToController(EasyAnimation_Controller *con
     
 }
 
-static void easyAnimation_emptyAnimationContoller(EasyAnimation_Controller *controller, EasyAnimation_ListItem **AnimationItemFreeListPtr) {
+void easyAnimation_addAnimationToController(EasyAnimation_Controller *controller, EasyAnimation_ListItem **AnimationItemFreeListPtr, Animation *animation, float period) {
+    easyAnimation_addAnimationToController_(controller, 0, AnimationItemFreeListPtr, animation, period);
+}
+
+void easyAnimation_addAnimationToController_arena(EasyArena *arena, EasyAnimation_Controller *controller, Animation *animation, float period) {
+    EASY_HEADERS_ASSERT(arena);
+    easyAnimation_addAnimationToController_(controller, arena, 0, animation, period);
+}
+
+void easyAnimation_emptyAnimationContoller(EasyAnimation_Controller *controller, EasyAnimation_ListItem **AnimationItemFreeListPtr) {
     //NOTE(ollie): While still things on the list
     EasyAnimation_ListItem *AnimationListSentintel = &controller->parent;
 
@@ -183,7 +574,7 @@ static void easyAnimation_emptyAnimationContoller(EasyAnimation_Controller *cont
     
 }
 
-static char *easyAnimation_updateAnimation(EasyAnimation_Controller *controller, EasyAnimation_ListItem **AnimationItemFreeListPtr, float dt, Animation *NextAnimation, float period) {
+static EasyAnimation_Frame easyAnimation_updateAnimation_(EasyAnimation_Controller *controller, EasyArena *arena, EasyAnimation_ListItem **AnimationItemFreeListPtr, float dt, Animation *NextAnimation, float period) {
     EasyAnimation_ListItem *AnimationListSentintel = &controller->parent;
 
     EasyAnimation_ListItem *Item = AnimationListSentintel->next;
@@ -193,54 +584,505 @@ static char *easyAnimation_updateAnimation(EasyAnimation_Controller *controller,
 
     Item->timerAt += dt;    
 
+    //NOTE: the animation might have been replaced in a library with fewer frames
+    if(Item->frameIndex >= Item->animation->frameCount) {
+        Item->frameIndex = 0;
+    }
+
     if(Item->timerAt >= Item->timerPeriod) {
-        Item->frameIndex++;
-        Item->timerAt = 0;
-        
-        if((NextAnimation && NextAnimation != Item->animation) || Item->frameIndex >= Item->animation->frameCount)
-        { 
-            //finished animation
-            Item->frameIndex = 0;
+        if(NextAnimation && NextAnimation != Item->animation) {
+            //NOTE: the frame showing has finished, so the next animation takes over with the time that's left
+            float timeLeft = (Item->timerPeriod > 0) ? Item->timerAt - Item->timerPeriod : 0;
+            easyAnimation_pushEvent_(controller->events, EASY_ANIMATION_EVENT_FINISHED, controller->id, Item->animation, Item->frameIndex, 0);
+
+            //Remove from linked list
+            AnimationListSentintel->next = Item->next;
+            Item->next->prev = AnimationListSentintel;
             
-            if(NextAnimation) {
-                //Remove from linked list
-                AnimationListSentintel->next = Item->next;
-                Item->next->prev = AnimationListSentintel;
-                
-                //Add to free list
+            //Add to free list. Arena items are just dropped, the reset frees them.
+            if(!arena) {
                 Item->next = *AnimationItemFreeListPtr;
                 *AnimationItemFreeListPtr = Item;
-                
-                //Add new animation
-                easyAnimation_addAnimationToController(controller, AnimationItemFreeListPtr, NextAnimation, period);
-            } 
+            }
+            
+            //Add new animation
+            easyAnimation_addAnimationToController_(controller, arena, AnimationItemFreeListPtr, NextAnimation, period);
+
+            //NOTE: whatever's at the front now, which is NextAnimation unless there were others queued up
+            Item = AnimationListSentintel->next;
+            easyAnimation_pushEvent_(controller->events, EASY_ANIMATION_EVENT_FRAME, controller->id, Item->animation, Item->frameIndex, 1);
+            Item->timerAt += timeLeft;
+            if(Item->timerPeriod > 0 && Item->timerAt >= Item->timerPeriod) {
+                easyAnimation_advanceItem_(controller, Item);
+            }
+        } else {
+            easyAnimation_advanceItem_(controller, Item);
         }
-        
     }
 
-    char *result = Item->animation->frames[Item->frameIndex];
+    EasyAnimation_Frame result = Item->animation->frames[Item->frameIndex];
     return result;
 }
 
-inline static int easyAnimation_isControllerEmpty(EasyAnimation_Controller *c) {
+EasyAnimation_Frame easyAnimation_updateAnimation(EasyAnimation_Controller *controller, EasyAnimation_ListItem **AnimationItemFreeListPtr, float dt, Animation *NextAnimation, float period) {
+    return easyAnimation_updateAnimation_(controller, 0, AnimationItemFreeListPtr, dt, NextAnimation, period);
+}
+
+EasyAnimation_Frame easyAnimation_updateAnimation_arena(EasyArena *arena, EasyAnimation_Controller *controller, float dt, Animation *NextAnimation, float period) {
+    EASY_HEADERS_ASSERT(arena);
+    return easyAnimation_updateAnimation_(controller, arena, 0, dt, NextAnimation, period);
+}
+
+int easyAnimation_isControllerEmpty(EasyAnimation_Controller *c) {
     int Result = c->parent.next == &c->parent;
     return Result;
 }
 
-inline static float easyAnimation_getDirectionInRadians(float x, float y) {
+float easyAnimation_getDirectionInRadians(float x, float y) {
     float DirectionValue = 0;
     if(x != 0 || y != 0) {
         //V2 EntityVelocity = normalizeV2(dp);
-        DirectionValue = ATan2_0toTau(y, x);
+        //NOTE: atan2 is -pi to pi, move it to 0 to 2pi
+        DirectionValue = atan2f(y, x);
+        if(DirectionValue < 0) {
+            DirectionValue += 2.0f*3.14159265358979f;
+        }
     }
     return DirectionValue;
 }
 
-inline static char *easyAnimation_getFrameOn(EasyAnimation_ListItem *AnimationListSentintel) {
-    char *currentFrame = AnimationListSentintel->next->animation->frames[AnimationListSentintel->next->frameIndex];
+//NOTE: the first frame if the animation's been replaced with fewer frames than the one it's on
+static int easyAnimation_getFrameIndexOn_(EasyAnimation_ListItem *Item) {
+    int result = (Item->frameIndex < Item->animation->frameCount) ? Item->frameIndex : 0;
+    return result;
+}
+
+EasyAnimation_Frame easyAnimation_getFrameOn(EasyAnimation_ListItem *AnimationListSentintel) {
+    EasyAnimation_ListItem *Item = AnimationListSentintel->next;
+    EasyAnimation_Frame currentFrame = Item->animation->frames[easyAnimation_getFrameIndexOn_(Item)];
     return currentFrame;
 }
 
+EasyAnimation_Uv *easyAnimation_getUvOn(EasyAnimation_ListItem *AnimationListSentintel) {
+    EasyAnimation_ListItem *Item = AnimationListSentintel->next;
+    EasyAnimation_Uv *result = 0;
+    if(Item->animation->uvs) {
+        result = Item->animation->uvs + easyAnimation_getFrameIndexOn_(Item);
+    }
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////
+
+//NOTE: what removed ids play, so the update doesn't need to check for them
+static EasyAnimation_Frame easyAnimation_noFrames_[1] = {EASY_ANIMATION_NO_FRAME};
+static Animation easyAnimation_noAnimation_ = {easyAnimation_noFrames_, 0, 0, 1, 0};
+
+void easyAnimation_initWorld(EasyAnimation_World *world) {
+    memset(world, 0, sizeof(EasyAnimation_World));
+    world->firstFree = -1;
+}
+
+void easyAnimation_freeWorld(EasyAnimation_World *world) {
+    if(world->timerAt) EASY_HEADERS_FREE(world->timerAt);
+    if(world->timerPeriod) EASY_HEADERS_FREE(world->timerPeriod);
+    if(world->frameIndex) EASY_HEADERS_FREE(world->frameIndex);
+    if(world->frameCount) EASY_HEADERS_FREE(world->frameCount);
+    if(world->animation) EASY_HEADERS_FREE(world->animation);
+    if(world->nextFree) EASY_HEADERS_FREE(world->nextFree);
+    if(world->frameOn) EASY_HEADERS_FREE(world->frameOn);
+    easyAnimation_initWorld(world);
+}
+
+static void *easyAnimation_growArray_(void *array, int oldCapacity, int newCapacity, size_t elementSize) {
+    void *result = EASY_HEADERS_ALLOC(newCapacity*elementSize);
+    EASY_HEADERS_ASSERT(result);
+    if(array) {
+        memcpy(result, array, oldCapacity*elementSize);
+        EASY_HEADERS_FREE(array);
+    }
+    return result;
+}
+
+int easyAnimation_addToWorld(EasyAnimation_World *world, Animation *animation, float period) {
+    int id = world->firstFree;
+    if(id >= 0) {
+        world->firstFree = world->nextFree[id];
+    } else {
+        if(world->count == world->capacity) {
+            int oldCapacity = world->capacity;
+            int newCapacity = oldCapacity ? oldCapacity*2 : 64;
+            world->timerAt = (float *)easyAnimation_growArray_(world->timerAt, oldCapacity, newCapacity, sizeof(float));
+            world->timerPeriod = (float *)easyAnimation_growArray_(world->timerPeriod, oldCapacity, newCapacity, sizeof(float));
+            world->frameIndex = (int *)easyAnimation_growArray_(world->frameIndex, oldCapacity, newCapacity, sizeof(int));
+            world->frameCount = (int *)easyAnimation_growArray_(world->frameCount, oldCapacity, newCapacity, sizeof(int));
+            world->animation = (Animation **)easyAnimation_growArray_(world->animation, oldCapacity, newCapacity, sizeof(Animation *));
+            world->nextFree = (int *)easyAnimation_growArray_(world->nextFree, oldCapacity, newCapacity, sizeof(int));
+            world->frameOn = (EasyAnimation_Frame *)easyAnimation_growArray_(world->frameOn, oldCapacity, newCapacity, sizeof(EasyAnimation_Frame));
+            world->capacity = newCapacity;
+        }
+        id = world->count++;
+    }
+    world->nextFree[id] = -1;
+    easyAnimation_setWorldAnimation(world, id, animation, period);
+    return id;
+}
+
+void easyAnimation_setWorldAnimation(EasyAnimation_World *world, int id, Animation *animation, float period) {
+    EASY_HEADERS_ASSERT(id >= 0 && id < world->count);
+    EASY_HEADERS_ASSERT(animation && animation->frameCount > 0);
+    world->timerAt[id] = 0;
+    world->timerPeriod[id] = period;
+    world->frameIndex[id] = 0;
+    world->frameCount[id] = animation->frameCount;
+    world->animation[id] = animation;
+    world->frameOn[id] = animation->frames[0];
+}
+
+void easyAnimation_removeFromWorld(EasyAnimation_World *world, int id) {
+    EASY_HEADERS_ASSERT(id >= 0 && id < world->count && world->animation[id] != &easyAnimation_noAnimation_);
+    //NOTE: left in the arrays stuck on EASY_ANIMATION_NO_FRAME, so the update can go over it like any other
+    world->timerAt[id] = 0;
+    world->timerPeriod[id] = HUGE_VALF;
+    world->frameIndex[id] = 0;
+    world->frameCount[id] = 1;
+    world->animation[id] = &easyAnimation_noAnimation_;
+    world->frameOn[id] = EASY_ANIMATION_NO_FRAME;
+    world->nextFree[id] = world->firstFree;
+    world->firstFree = id;
+}
+
+void easyAnimation_updateWorld(EasyAnimation_World *world, float dt) {
+    int count = world->count;
+    float *timerAt = world->timerAt;
+    float *timerPeriod = world->timerPeriod;
+    int *frameIndex = world->frameIndex;
+    int *frameCount = world->frameCount;
+
+    //NOTE: the same as easyAnimation_updateAnimation for an animation that loops, but written as selects instead of ifs 
+    //so it can be done 4 at a time. Events need an if for each one, so they go one at a time.
+    int i = 0;
+    EasyAnimation_EventBuffer *events = world->events;
+    if(events) {
+        Animation **animation = world->animation;
+        for(; i < count; ++i) {
+            float timer = timerAt[i] + dt;
+            int steps = easyAnimation_framesPassed_(&timer, timerPeriod[i]);
+            timerAt[i] = timer;
+            if(steps > 0) {
+                int index = frameIndex[i] + steps;
+                int loops = index / frameCount[i];
+                index -= loops*frameCount[i];
+                frameIndex[i] = index;
+                if(loops > 0) {
+                    easyAnimation_pushEvent_(events, EASY_ANIMATION_EVENT_LOOPED, i, animation[i], index, loops);
+                }
+                easyAnimation_pushEvent_(events, EASY_ANIMATION_EVENT_FRAME, i, animation[i], index, steps);
+            }
+        }
+    }
+#if EASY_ANIMATION_SSE2
+    __m128 dt4 = _mm_set1_ps(dt);
+    __m128 zero = _mm_setzero_ps();
+    __m128 maxSkip = _mm_set1_ps(EASY_ANIMATION_MAX_SKIP);
+    __m128i one = _mm_set1_epi32(1);
+    for(; i + 4 <= count; i += 4) {
+        //NOTE: easyAnimation_framesPassed_. The divide is only done when one of the four has gone past more than one frame.
+        __m128 timer = _mm_add_ps(_mm_loadu_ps(timerAt + i), dt4);
+        __m128 period = _mm_loadu_ps(timerPeriod + i);
+        __m128 noPeriod = _mm_cmple_ps(period, zero);
+        __m128 finished = _mm_or_ps(_mm_cmpge_ps(timer, period), noPeriod);
+        __m128 skipping = _mm_andnot_ps(noPeriod, _mm_cmpge_ps(timer, _mm_add_ps(period, period)));
+        int anySkipping = _mm_movemask_ps(skipping);
+
+        __m128i steps = _mm_and_si128(_mm_castps_si128(finished), one);
+        if(anySkipping) {
+            __m128i skipSteps = _mm_cvttps_epi32(_mm_min_ps(_mm_div_ps(timer, period), maxSkip));
+            steps = _mm_or_si128(_mm_and_si128(_mm_castps_si128(skipping), skipSteps), _mm_andnot_si128(_mm_castps_si128(skipping), steps));
+        }
+        __m128 timerLeft = _mm_max_ps(_mm_sub_ps(timer, _mm_mul_ps(_mm_cvtepi32_ps(steps), period)), zero);
+        timer = _mm_or_ps(_mm_and_ps(finished, timerLeft), _mm_andnot_ps(finished, timer));
+        _mm_storeu_ps(timerAt + i, _mm_andnot_ps(noPeriod, timer));
+
+        __m128i frames = _mm_loadu_si128((__m128i *)(frameCount + i));
+        __m128i index = _mm_add_epi32(_mm_loadu_si128((__m128i *)(frameIndex + i)), steps);
+        if(anySkipping) {
+            //NOTE: no integer divide in SSE2, so going round is done in floats. That's exact while the index is under 2^24,
+            //which MAX_SKIP keeps it. The compares after fix up the divide rounding to either side of a whole number.
+            __m128 framesF = _mm_cvtepi32_ps(frames);
+            __m128 indexF = _mm_cvtepi32_ps(index);
+            __m128 loops = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_div_ps(indexF, framesF)));
+            index = _mm_cvttps_epi32(_mm_sub_ps(indexF, _mm_mul_ps(loops, framesF)));
+            index = _mm_add_epi32(index, _mm_and_si128(_mm_cmplt_epi32(index, _mm_setzero_si128()), frames));
+        }
+        index = _mm_sub_epi32(index, _mm_andnot_si128(_mm_cmplt_epi32(index, frames), frames));
+        _mm_storeu_si128((__m128i *)(frameIndex + i), index);
+    }
+#endif
+    for(; i < count; ++i) {
+        float timer = timerAt[i] + dt;
+        int steps = easyAnimation_framesPassed_(&timer, timerPeriod[i]);
+        timerAt[i] = timer;
+        frameIndex[i] = (frameIndex[i] + steps) % frameCount[i];
+    }
+
+    //NOTE: looking the frames up is a gather, so it gets its own loop rather than stopping the one above being simd.
+    //It goes through the Animation so a library's pool can move, or an animation be replaced, without the world knowing.
+    //The frame count comes from the Animation too, so a replaced one with fewer frames starts again from its first.
+    Animation **animation = world->animation;
+    EasyAnimation_Frame *frameOn = world->frameOn;
+    for(i = 0; i < count; ++i) {
+        Animation *playing = animation[i];
+        EasyAnimation_Frame *frames = playing->frames;
+        int playingFrameCount = playing->frameCount;
+        int index = frameIndex[i];
+        if(index >= playingFrameCount) {
+            index = 0;
+            frameIndex[i] = 0;
+        }
+        frameOn[i] = frames[index];
+        frameCount[i] = playingFrameCount;
+    }
+}
+
+////////////////////////////////////////////////////////////////////
+
+void easyAnimation_initLibrary(EasyAnimation_Library *library, int frameCapacity) {
+    memset(library, 0, sizeof(EasyAnimation_Library));
+    if(frameCapacity > 0) {
+        library->frameCapacity = frameCapacity;
+        library->frames = (EasyAnimation_Frame *)EASY_HEADERS_ALLOC(frameCapacity*sizeof(EasyAnimation_Frame));
+        EASY_HEADERS_ASSERT(library->frames);
+    }
+}
+
+void easyAnimation_freeLibrary(EasyAnimation_Library *library) {
+    //NOTE: the first animation of each block is the start of its allocation
+    for(int i = 0; i < library->count; i += EASY_ANIMATION_LIBRARY_BLOCK) {
+        EASY_HEADERS_FREE(library->animations[i]);
+    }
+    if(library->names) EASY_HEADERS_FREE(library->names);
+    if(library->nameHashes) EASY_HEADERS_FREE(library->nameHashes);
+    if(library->animations) EASY_HEADERS_FREE(library->animations);
+    if(library->slots) EASY_HEADERS_FREE(library->slots);
+    if(library->frames) EASY_HEADERS_FREE(library->frames);
+    if(library->uvs) EASY_HEADERS_FREE(library->uvs);
+    memset(library, 0, sizeof(EasyAnimation_Library));
+}
+
+//NOTE: easyString_hash64 folded to 32 bits, the same as easy_string's intern table
+static unsigned int easyAnimation_hashName_(char *name) {
+    unsigned long long hash = easyString_hash64(name, easyString_byteLength_utf8(name), 0);
+    return (unsigned int)(hash ^ (hash >> 32));
+}
+
+static void easyAnimation_insertSlot_(EasyAnimation_Library *library, int id) {
+    unsigned int mask = (unsigned int)library->slotCount - 1;
+    unsigned int at = library->nameHashes[id] & mask;
+    while(library->slots[at]) {
+        at = (at + 1) & mask;
+    }
+    library->slots[at] = id + 1;
+}
+
+//NOTE: make room for animationCount more animations, and keep the hash table at most half full
+static void easyAnimation_reserveLibraryAnimations_(EasyAnimation_Library *library, int animationCount) {
+    int needed = library->count + animationCount;
+    if(needed > library->capacity) {
+        int oldCapacity = library->capacity;
+        int newCapacity = oldCapacity ? oldCapacity : EASY_ANIMATION_LIBRARY_BLOCK;
+        while(needed > newCapacity) newCapacity *= 2;
+        library->names = (char **)easyAnimation_growArray_(library->names, oldCapacity, newCapacity, sizeof(char *));
+        library->nameHashes = (unsigned int *)easyAnimation_growArray_(library->nameHashes, oldCapacity, newCapacity, sizeof(unsigned int));
+        library->animations = (Animation **)easyAnimation_growArray_(library->animations, oldCapacity, newCapacity, sizeof(Animation *));
+        library->capacity = newCapacity;
+    }
+
+    if(needed*2 > library->slotCount) {
+        int slotCount = library->slotCount ? library->slotCount : 2*EASY_ANIMATION_LIBRARY_BLOCK;
+        while(needed*2 > slotCount) slotCount *= 2;
+        if(library->slots) EASY_HEADERS_FREE(library->slots);
+        library->slots = (int *)EASY_HEADERS_ALLOC(slotCount*sizeof(int));
+        EASY_HEADERS_ASSERT(library->slots);
+        memset(library->slots, 0, slotCount*sizeof(int));
+        library->slotCount = slotCount;
+        for(int id = 0; id < library->count; ++id) {
+            easyAnimation_insertSlot_(library, id);
+        }
+    }
+}
+
+//NOTE: make room for frameCount more frames in the pool, and point the animations at where it's moved to
+static void easyAnimation_reserveLibraryFrames_(EasyAnimation_Library *library, int frameCount, int needUvs) {
+    int oldCapacity = library->frameCapacity;
+    int newCapacity = oldCapacity;
+    if(newCapacity == 0) newCapacity = 1024;
+    while(library->frameCount + frameCount > newCapacity) newCapacity *= 2;
+
+    if(newCapacity != oldCapacity) {
+        library->frames = (EasyAnimation_Frame *)easyAnimation_growArray_(library->frames, oldCapacity, newCapacity, sizeof(EasyAnimation_Frame));
+        if(library->uvs) library->uvs = (EasyAnimation_Uv *)easyAnimation_growArray_(library->uvs, oldCapacity, newCapacity, sizeof(EasyAnimation_Uv));
+        library->frameCapacity = newCapacity;
+    }
+    if(needUvs && !library->uvs) {
+        library->uvs = (EasyAnimation_Uv *)EASY_HEADERS_ALLOC(library->frameCapacity*sizeof(EasyAnimation_Uv));
+        EASY_HEADERS_ASSERT(library->uvs);
+    }
+
+    if(newCapacity != oldCapacity) {
+        for(int i = 0; i < library->count; ++i) {
+            Animation *animation = library->animations[i];
+            animation->frames = library->frames + animation->frameOffset;
+            if(animation->uvs) animation->uvs = library->uvs + animation->frameOffset;
+        }
+    }
+}
+
+//NOTE: puts the frames on the end of the pool. There has to be room already.
+static void easyAnimation_setLibraryFrames_(EasyAnimation_Library *library, Animation *animation, EasyAnimation_Frame *frames, int frameCount, EasyAnimation_Uv *uvs) {
+    EASY_HEADERS_ASSERT(library->frameCount + frameCount <= library->frameCapacity);
+    animation->frameOffset = library->frameCount;
+    animation->frameCount = frameCount;
+    animation->frames = library->frames + animation->frameOffset;
+    memcpy(animation->frames, frames, frameCount*sizeof(EasyAnimation_Frame));
+    animation->uvs = 0;
+    if(uvs) {
+        animation->uvs = library->uvs + animation->frameOffset;
+        memcpy(animation->uvs, uvs, frameCount*sizeof(EasyAnimation_Uv));
+    }
+    library->frameCount += frameCount;
+}
+
+//NOTE: there has to be room already
+static Animation *easyAnimation_addToLibrary_(EasyAnimation_Library *library, char *name, EasyAnimation_Frame *frames, int frameCount, EasyAnimation_Uv *uvs) {
+    EASY_HEADERS_ASSERT(frameCount > 0);
+    int id = library->count++;
+
+    Animation *animation = 0;
+    if((id % EASY_ANIMATION_LIBRARY_BLOCK) == 0) {
+        animation = (Animation *)EASY_HEADERS_ALLOC(EASY_ANIMATION_LIBRARY_BLOCK*sizeof(Animation));
+        EASY_HEADERS_ASSERT(animation);
+    } else {
+        animation = library->animations[id - 1] + 1;
+    }
+
+    animation->name = name;
+    easyAnimation_setLibraryFrames_(library, animation, frames, frameCount, uvs);
+
+    library->names[id] = name;
+    library->nameHashes[id] = easyAnimation_hashName_(name);
+    library->animations[id] = animation;
+    easyAnimation_insertSlot_(library, id);
+
+    return animation;
+}
+
+Animation *easyAnimation_addToLibrary(EasyAnimation_Library *library, char *name, EasyAnimation_Frame *frames, int frameCount, EasyAnimation_Uv *uvs) {
+    easyAnimation_reserveLibraryAnimations_(library, 1);
+    easyAnimation_reserveLibraryFrames_(library, frameCount, uvs != 0);
+    return easyAnimation_addToLibrary_(library, name, frames, frameCount, uvs);
+}
+
+void easyAnimation_addManyToLibrary(EasyAnimation_Library *library, EasyAnimation_LibraryEntry *entries, int count) {
+    int frameCount = 0;
+    int needUvs = 0;
+    for(int i = 0; i < count; ++i) {
+        frameCount += entries[i].frameCount;
+        needUvs |= (entries[i].uvs != 0);
+    }
+    easyAnimation_reserveLibraryAnimations_(library, count);
+    easyAnimation_reserveLibraryFrames_(library, frameCount, needUvs);
+
+    for(int i = 0; i < count; ++i) {
+        EasyAnimation_LibraryEntry *entry = entries + i;
+        easyAnimation_addToLibrary_(library, entry->name, entry->frames, entry->frameCount, entry->uvs);
+    }
+}
+
+int easyAnimation_findIdInLibrary(EasyAnimation_Library *library, char *name) {
+    int result = -1;
+    if(library->slotCount) {
+        unsigned int hash = easyAnimation_hashName_(name);
+        unsigned int mask = (unsigned int)library->slotCount - 1;
+        for(unsigned int at = hash & mask; library->slots[at]; at = (at + 1) & mask) {
+            int id = library->slots[at] - 1;
+            if(library->nameHashes[id] == hash && easyString_stringsMatch_nullTerminated(library->names[id], name)) {
+                result = id;
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+Animation *easyAnimation_findInLibrary(EasyAnimation_Library *library, char *name) {
+    int id = easyAnimation_findIdInLibrary(library, name);
+    Animation *result = (id >= 0) ? library->animations[id] : 0;
+    return result;
+}
+
+Animation *easyAnimation_getFromLibrary(EasyAnimation_Library *library, int id) {
+    EASY_HEADERS_ASSERT(id >= 0 && id < library->count);
+    return library->animations[id];
+}
+
+Animation *easyAnimation_replaceInLibrary(EasyAnimation_Library *library, char *name, EasyAnimation_Frame *frames, int frameCount, EasyAnimation_Uv *uvs) {
+    EASY_HEADERS_ASSERT(frameCount > 0);
+    int id = easyAnimation_findIdInLibrary(library, name);
+    if(id < 0) {
+        return easyAnimation_addToLibrary(library, name, frames, frameCount, uvs);
+    }
+
+    Animation *animation = library->animations[id];
+    if(frameCount <= animation->frameCount) {
+        //NOTE: fits where the old frames were. The uv pool lines up with the frames, so there's room for uvs too once it exists.
+        easyAnimation_reserveLibraryFrames_(library, 0, uvs != 0);
+        animation->frameCount = frameCount;
+        memcpy(animation->frames, frames, frameCount*sizeof(EasyAnimation_Frame));
+        animation->uvs = 0;
+        if(uvs) {
+            animation->uvs = library->uvs + animation->frameOffset;
+            memcpy(animation->uvs, uvs, frameCount*sizeof(EasyAnimation_Uv));
+        }
+    } else {
+        //NOTE: the old frames stay in the pool unused until the library is freed
+        easyAnimation_reserveLibraryFrames_(library, frameCount, uvs != 0);
+        easyAnimation_setLibraryFrames_(library, animation, frames, frameCount, uvs);
+    }
+    return animation;
+}
+
+////////////////////////////////////////////////////////////////////
+
+int easyAnimation_initDirections(EasyAnimation_Directions *directions, EasyAnimation_Library *library, char *baseName, char **suffixes, int count) {
+    EASY_HEADERS_ASSERT(count > 0 && count <= EASY_ANIMATION_MAX_DIRECTIONS);
+    directions->count = count;
+
+    char name[256];
+    size_t baseLength = strlen(baseName);
+    EASY_HEADERS_ASSERT(baseLength < sizeof(name));
+    memcpy(name, baseName, baseLength);
+
+    int found = 0;
+    for(int i = 0; i < count; ++i) {
+        size_t suffixLength = strlen(suffixes[i]);
+        EASY_HEADERS_ASSERT(baseLength + suffixLength < sizeof(name));
+        memcpy(name + baseLength, suffixes[i], suffixLength + 1); //with the null terminator
+
+        directions->animations[i] = easyAnimation_findInLibrary(library, name);
+        if(directions->animations[i]) found++;
+    }
+    return found;
+}
+
+Animation *easyAnimation_getDirectionAnimation(EasyAnimation_Directions *directions, float x, float y) {
+    float angle = easyAnimation_getDirectionInRadians(x, y);
+    //NOTE: + 0.5 so each direction is in the middle of its bucket, and the last half bucket goes round to the first
+    int bucket = (int)(angle*((float)directions->count / (2.0f*3.14159265358979f)) + 0.5f);
+    if(bucket >= directions->count) bucket -= directions->count;
+    return directions->animations[bucket];
+}
+
 #endif // END OF IMPLEMENTATION
 #endif // END OF HEADER INCLUDE
 
@@ -0,0 +1,342 @@
+/*
+A simple header include library like Sean Barret's stb libraries.
+
+A bump allocator (arena) for the other easy_headers. Allocating is moving a pointer along, and you free everything at once
+by resetting the arena (or back to a mark), so things that only live for a frame cost nothing to throw away.
+The arena grabs memory in chunks through EASY_HEADERS_ALLOC, and keeps the chunks around after a reset to use again,
+so once it has grown to what a frame needs it stops calling malloc at all.
+
+The arena itself doesn't need an implementation, you can just include the file. Only the thread local scratch arena does,
+#define EASY_ARENA_IMPLEMENTATION in one file before including it if you use easyArena_getScratch.
+
+easy_string_utf8.h and easy_animation_2d.h include this file, and their allocating functions have a version ending in _arena
+that takes an arena instead of calling EASY_HEADERS_ALLOC.
+
+////////////////////////////////////////////////////////////////////
+
+How to use:
+
+////////////////////////////////////////////////////////////////////
+
+easyArena_init(EasyArena *arena, size_t chunkSize) - chunkSize is the size of the first chunk, 0 for the default (64KB). A zeroed EasyArena works too.
+easyArena_free(EasyArena *arena) - gives all the chunks back
+
+easyArena_push(EasyArena *arena, size_t size, size_t alignment) - alignment has to be a power of two. Never returns null (asserts if out of memory).
+easyArena_pushStruct(arena, type) / easyArena_pushArray(arena, type, count) - same thing, aligned to EASY_ARENA_DEFAULT_ALIGNMENT
+easyArena_pushCopy(EasyArena *arena, void *data, size_t size)
+easyArena_pushString(EasyArena *arena, char *string) - copies a null terminated string
+
+easyArena_reset(EasyArena *arena) - frees everything pushed. Keeps the chunks.
+easyArena_getMark(EasyArena *arena) / easyArena_popToMark(EasyArena *arena, EasyArena_Mark mark) - frees everything pushed after the mark
+
+Neither of these touch what was pushed, they just move the pointer back (and put any chunks added since on the arena's free list),
+so you can't run anything like a destructor on the way out.
+
+	EasyArena frameArena = {0};
+
+	while(running) {
+		unsigned int *text = easyUnicode_utf8StreamToUtf32Stream_arena(&frameArena, "გამარჯობა");
+		easyAnimation_addAnimationToController_arena(&frameArena, &controller, &walkAnimation, 0.1f);
+		...
+		easyArena_reset(&frameArena); //everything from this frame is gone
+	}
+
+	easyArena_free(&frameArena);
+
+////////////////////////////////////////////////////////////////////
+Scratch memory:
+
+easyArena_getScratch() - an arena for each thread. Take a mark at the start of what you're doing and pop back to it at the end,
+so functions can use it without knowing who else is.
+
+	EasyArena *scratch = easyArena_getScratch();
+	EasyArena_Mark mark = easyArena_getMark(scratch);
+	char *temp = easyArena_pushString(scratch, name);
+	...
+	easyArena_popToMark(scratch, mark);
+
+easyArena_freeScratch() - call before a thread exits to give its scratch chunks back
+
+The scratch arena uses thread_local/_Thread_local/__thread/__declspec(thread), whichever the compiler has.
+If it has none of them there is one scratch arena shared by every thread, so don't use it from more than one.
+
+*/
+#ifndef EASY_ARENA_H
+#define EASY_ARENA_H
+
+
+#ifndef EASY_ARENA_IMPLEMENTATION
+#define EASY_ARENA_IMPLEMENTATION 0
+#endif
+
+#ifndef EASY_HEADERS_ASSERT
+#define EASY_HEADERS_ASSERT(statement) if(!(statement)) { int *i_ptr = 0; *(i_ptr) = 0; }
+#endif
+
+#ifndef EASY_HEADERS_ALLOC
+#include <stdlib.h>
+#define EASY_HEADERS_ALLOC(size) malloc(size)
+#endif
+
+#ifndef EASY_HEADERS_FREE
+#include <stdlib.h>
+#define EASY_HEADERS_FREE(ptr) free(ptr)
+#endif
+
+#include <stddef.h>
+#include <string.h>
+
+#ifndef EASY_ARENA_DEFAULT_CHUNK_SIZE
+#define EASY_ARENA_DEFAULT_CHUNK_SIZE (64*1024)
+#endif
+
+//NOTE: every new chunk is twice the size of the last one up to this, so a big frame only takes a few mallocs
+#ifndef EASY_ARENA_MAX_CHUNK_SIZE
+#define EASY_ARENA_MAX_CHUNK_SIZE (64*1024*1024)
+#endif
+
+//NOTE: same as malloc
+#ifndef EASY_ARENA_DEFAULT_ALIGNMENT
+#define EASY_ARENA_DEFAULT_ALIGNMENT 16
+#endif
+
+#if defined(__cplusplus) && (__cplusplus >= 201103L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201103L))
+#define EASY_ARENA_THREAD_LOCAL thread_local
+#elif defined(_MSC_VER)
+#define EASY_ARENA_THREAD_LOCAL __declspec(thread)
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_THREADS__)
+#define EASY_ARENA_THREAD_LOCAL _Thread_local
+#elif defined(__GNUC__) || defined(__clang__)
+#define EASY_ARENA_THREAD_LOCAL __thread
+#else
+#define EASY_ARENA_THREAD_LOCAL
+#endif
+
+///////////////////////************ Header definitions start here *************////////////////////
+
+typedef struct EasyArena_Chunk EasyArena_Chunk;
+struct EasyArena_Chunk {
+	EasyArena_Chunk *prev; //the chunk before this one, or the next chunk on the free list
+	size_t size; //bytes after this header
+};
+
+typedef struct {
+	unsigned char *at; //next free byte in the current chunk
+	unsigned char *end;
+	EasyArena_Chunk *chunk; //the newest chunk, at and end point into it. The older ones hang off it.
+	EasyArena_Chunk *freeChunks; //chunks given back by a reset, used again before allocating new ones
+	size_t chunkSize; //0 means EASY_ARENA_DEFAULT_CHUNK_SIZE
+} EasyArena;
+
+typedef struct {
+	EasyArena_Chunk *chunk;
+	unsigned char *at;
+} EasyArena_Mark;
+
+#define easyArena_pushStruct(arena, type) ((type *)easyArena_push(arena, sizeof(type), EASY_ARENA_DEFAULT_ALIGNMENT))
+#define easyArena_pushArray(arena, type, count) ((type *)easyArena_push(arena, (count)*sizeof(type), EASY_ARENA_DEFAULT_ALIGNMENT))
+
+EasyArena *easyArena_getScratch(void);
+void easyArena_freeScratch(void);
+
+//NOTE: The rest is small enough to live in the header, so the other headers can use arenas without you having to define EASY_ARENA_IMPLEMENTATION
+
+inline static void easyArena_init(EasyArena *arena, size_t chunkSize) {
+	memset(arena, 0, sizeof(EasyArena));
+	arena->chunkSize = chunkSize;
+}
+
+inline static unsigned char *easyArena_chunkData_(EasyArena_Chunk *chunk) {
+	return (unsigned char *)(chunk + 1);
+}
+
+inline static unsigned char *easyArena_alignUp_(unsigned char *at, size_t alignment) {
+	return (unsigned char *)(((size_t)at + (alignment - 1)) & ~(alignment - 1));
+}
+
+//NOTE: the slow path of easyArena_push, when the current chunk is full
+inline static void *easyArena_pushNewChunk_(EasyArena *arena, size_t size, size_t alignment) {
+	//NOTE: room for the worst case alignment as well
+	size_t needed = size + alignment - 1;
+	EASY_HEADERS_ASSERT(needed >= size);
+
+	EasyArena_Chunk *chunk = 0;
+
+	//NOTE: first one on the free list that's big enough
+	EasyArena_Chunk **link = &arena->freeChunks;
+	while(*link) {
+		if((*link)->size >= needed) {
+			chunk = *link;
+			*link = chunk->prev;
+			break;
+		}
+		link = &(*link)->prev;
+	}
+
+	if(!chunk) {
+		size_t chunkSize = arena->chunkSize ? arena->chunkSize : EASY_ARENA_DEFAULT_CHUNK_SIZE;
+		if(arena->chunk) {
+			size_t grown = (arena->chunk->size < EASY_ARENA_MAX_CHUNK_SIZE / 2) ? arena->chunk->size*2 : EASY_ARENA_MAX_CHUNK_SIZE;
+			if(grown > chunkSize) { chunkSize = grown; }
+		}
+		if(chunkSize < needed) { chunkSize = needed; }
+
+		chunk = (EasyArena_Chunk *)EASY_HEADERS_ALLOC(sizeof(EasyArena_Chunk) + chunkSize);
+		EASY_HEADERS_ASSERT(chunk);
+		chunk->size = chunkSize;
+	}
+
+	chunk->prev = arena->chunk;
+	arena->chunk = chunk;
+	arena->end = easyArena_chunkData_(chunk) + chunk->size;
+
+	unsigned char *result = easyArena_alignUp_(easyArena_chunkData_(chunk), alignment);
+	arena->at = result + size;
+	return result;
+}
+
+inline static void *easyArena_push(EasyArena *arena, size_t size, size_t alignment) {
+	EASY_HEADERS_ASSERT(alignment && (alignment & (alignment - 1)) == 0);
+	unsigned char *result = easyArena_alignUp_(arena->at, alignment);
+
+	//NOTE: compare sizes not pointers, so a huge size can't wrap around past end
+	if(arena->chunk && result <= arena->end && size <= (size_t)(arena->end - result)) {
+		arena->at = result + size;
+		return result;
+	}
+	return easyArena_pushNewChunk_(arena, size, alignment);
+}
+
+inline static void *easyArena_pushCopy(EasyArena *arena, void *data, size_t size) {
+	void *result = easyArena_push(arena, size, 1);
+	memcpy(result, data, size);
+	return result;
+}
+
+inline static char *easyArena_pushString(EasyArena *arena, char *string) {
+	return (char *)easyArena_pushCopy(arena, string, strlen(string) + 1);
+}
+
+inline static EasyArena_Mark easyArena_getMark(EasyArena *arena) {
+	EasyArena_Mark result;
+	result.chunk = arena->chunk;
+	result.at = arena->at;
+	return result;
+}
+
+//NOTE: Doesn't look at what was pushed, only at the chunks added after the mark (usually none), which go on the free list
+inline static void easyArena_popToMark(EasyArena *arena, EasyArena_Mark mark) {
+	while(arena->chunk != mark.chunk) {
+		EasyArena_Chunk *chunk = arena->chunk;
+		EASY_HEADERS_ASSERT(chunk); //mark isn't from this arena, or is from before a reset
+		arena->chunk = chunk->prev;
+
+		chunk->prev = arena->freeChunks;
+		arena->freeChunks = chunk;
+	}
+
+	arena->at = mark.at;
+	arena->end = mark.chunk ? easyArena_chunkData_(mark.chunk) + mark.chunk->size : 0;
+}
+
+//NOTE: Keeps the biggest chunk as the current one and puts the rest on the free list. Only walks the chunks,
+//which stops growing once the arena is big enough for a frame.
+inline static void easyArena_reset(EasyArena *arena) {
+	EasyArena_Chunk *biggest = 0;
+	EasyArena_Chunk *chunk = arena->chunk;
+	while(chunk) {
+		EasyArena_Chunk *prev = chunk->prev;
+		if(!biggest || chunk->size > biggest->size) {
+			if(biggest) {
+				biggest->prev = arena->freeChunks;
+				arena->freeChunks = biggest;
+			}
+			biggest = chunk;
+		} else {
+			chunk->prev = arena->freeChunks;
+			arena->freeChunks = chunk;
+		}
+		chunk = prev;
+	}
+
+	arena->chunk = biggest;
+	if(biggest) {
+		biggest->prev = 0;
+		arena->at = easyArena_chunkData_(biggest);
+		arena->end = arena->at + biggest->size;
+	} else {
+		arena->at = arena->end = 0;
+	}
+}
+
+inline static void easyArena_free(EasyArena *arena) {
+	EasyArena_Chunk *lists[2] = { arena->chunk, arena->freeChunks };
+	for(int i = 0; i < 2; ++i) {
+		EasyArena_Chunk *chunk = lists[i];
+		while(chunk) {
+			EasyArena_Chunk *prev = chunk->prev;
+			EASY_HEADERS_FREE(chunk);
+			chunk = prev;
+		}
+	}
+	size_t chunkSize = arena->chunkSize;
+	easyArena_init(arena, chunkSize);
+}
+
+#if EASY_ARENA_IMPLEMENTATION
+
+static EASY_ARENA_THREAD_LOCAL EasyArena easyArena_scratch_;
+
+EasyArena *easyArena_getScratch(void) {
+	return &easyArena_scratch_;
+}
+
+void easyArena_freeScratch(void) {
+	easyArena_free(&easyArena_scratch_);
+}
+
+#endif // END OF IMPLEMENTATION
+#endif // END OF HEADER INCLUDE
+
+
+/*
+------------------------------------------------------------------------------
+This software is available under 2 licenses -- choose whichever you prefer.
+------------------------------------------------------------------------------
+ALTERNATIVE A - MIT License
+Copyright (c) 2017 Sean Barrett
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+------------------------------------------------------------------------------
+ALTERNATIVE B - Public Domain (www.unlicense.org)
+This is free and unencumbered software released into the public domain.
+Anyone is free to copy, modify, publish, use, compile, sell, or distribute this
+software, either in source code form or as a compiled binary, for any purpose,
+commercial or non-commercial, and by any means.
+In jurisdictions that recognize copyright laws, the author or authors of this
+software dedicate any and all copyright interest in the software to the public
+domain. We make this dedication for the benefit of the public at large and to
+the detriment of our heirs and successors. We intend this dedication to be an
+overt act of relinquishment in perpetuity of all present and future rights to
+this software under copyright law.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------
+*/
@@ -7,7 +7,12 @@ i.e.
 #include "easy_gjk.h"
 
 You can also pound define your own assert function with GJK_ASSERT
- 
+
+Only one file should have GJK_IMPLEMENTATION, every other file just includes the header. It builds as C99 or C++.
+The small vector functions (gjk_V2, gjk_dot, gjk_perp2D...) are inline static in the header part, so they inline in every file.
+#define GJK_DOUBLE_PRECISION before including it (in every file) to make gjk_real a double instead of a float.
+That turns the simd support functions off since they only do floats.
+
 This header file implementation provides two functions to use. These are:
 
 bool gjk_objectsCollide(gjk_v2 *a, int aCount, gjk_v2 *b, int bCount);
@@ -17,16 +22,167 @@ Gjk_EPA_Info gjk_objectsCollide_withEPA(gjk_v2 *a, int aCount, gjk_v2 *b, int bC
 2. Provide you with the info from above, but also a penetration vector which you can offset the polygons accordingly. 
    By adding the pentration vector (normal*distance) to the first shapes position will resolve the collision. NOTE: The order of the shapes matters on what you add the pentration vector. 
 
-*/
+If you have lots of shapes, instead of testing every pair yourself put them in a Gjk_World. It sorts their bounding boxes along x 
+(sweep and prune) and only runs GJK/EPA on the pairs whose boxes overlap:
+
+void gjk_initWorld(Gjk_World *world);
+int gjk_addBody(Gjk_World *world, gjk_v2 *points, int count); - returns the id of the body. The points aren't copied, they have to stay around.
+void gjk_updateBody(Gjk_World *world, int id, gjk_v2 *points, int count); - call when the body moves (or its points move) so its bounding box is right
+void gjk_removeBody(Gjk_World *world, int id); - the id gets used again by the next gjk_addBody
+int gjk_findPairs(Gjk_World *world); - just the broadphase. The pairs whose boxes overlap end up in world->pairs. 
+int gjk_collideWorld(Gjk_World *world, Gjk_Contact *contacts, int contactCapacity, bool withEPA); - broadphase then GJK (and EPA if you want the 
+   penetration vector) on every pair. Writes the pairs that collide into contacts and returns how many collided, which can be more than contactCapacity.
+void gjk_freeWorld(Gjk_World *world);
+
+The bodies are kept sorted between calls, and since things don't move much from one tick to the next the sort is almost free.
+
+    Gjk_World world;
+    gjk_initWorld(&world);
+    for(int i = 0; i < shapeCount; ++i) { shapes[i].bodyId = gjk_addBody(&world, shapes[i].worldPoints, shapes[i].count); }
+
+    //every tick
+    for(int i = 0; i < shapeCount; ++i) { gjk_updateBody(&world, shapes[i].bodyId, shapes[i].worldPoints, shapes[i].count); }
+    int hits = gjk_collideWorld(&world, contacts, arrayCount(contacts), true);
+    for(int i = 0; i < hits && i < arrayCount(contacts); ++i) { 
+        //move contacts[i].a by contacts[i].normal*contacts[i].distance
+    }
+
+The world's arrays come from EASY_HEADERS_ALLOC/EASY_HEADERS_FREE like the other easy headers.
+
+Big polygons:
+
+Most of the time goes into finding the furthest point of each shape in a direction (the support function), which looks at every point.
+That runs 4 points at a time with SSE2, and 8 at a time with AVX when the cpu has it (picked at runtime). #define GJK_NO_SIMD to turn it off. 
+It's only worth it from about 16 points up, below that it's the plain loop, and AVX only takes over from 512 on gjk_v2 arrays (64 for Gjk_SoaPolygon). examples/gjk_support_bench.c 
+times each kernel on its own if you want to check where they cross over on your machine.
+
+For shapes with lots of points you can also keep them as a Gjk_SoaPolygon (all the x's then all the y's), which skips shuffling the points apart:
+
+void gjk_initSoaPolygon(Gjk_SoaPolygon *polygon, gjk_v2 *points, int count); - copies the points, do it once when you load the shape
+void gjk_freeSoaPolygon(Gjk_SoaPolygon *polygon);
+
+Then test any two shapes with:
+
+Gjk_Shape gjk_polygonShape(gjk_v2 *points, int count);
+Gjk_Shape gjk_soaPolygonShape(Gjk_SoaPolygon *polygon);
+bool gjk_shapesCollide(Gjk_Shape *a, Gjk_Shape *b);
+Gjk_EPA_Info gjk_shapesCollide_withEPA(Gjk_Shape *a, Gjk_Shape *b);
+
+gjk_objectsCollide(a, aCount, b, bCount) is the same as gjk_shapesCollide on two gjk_polygonShapes.
+
+gjk_getSimdLevel() - the instruction set the support function is using
+gjk_setSimdLevel(level) - force a lower level, i.e. GJK_SIMD_NONE to compare against the plain loop
+
+Shapes that aren't a list of world space points:
+
+Gjk_Transform gjk_transform(gjk_v2 position, gjk_real angle); - rotate by angle (radians) then move to position
+Gjk_Shape gjk_circleShape(gjk_real radius, Gjk_Transform transform);
+Gjk_Shape gjk_capsuleShape(gjk_real halfLength, gjk_real radius, Gjk_Transform transform); - along the local x axis
+Gjk_Shape gjk_boxShape(gjk_v2 halfSize, Gjk_Transform transform);
+Gjk_Shape gjk_localPolygonShape(gjk_v2 *points, int count, Gjk_Transform transform); - points are in the shape's own space
+Gjk_Shape gjk_customShape(Gjk_SupportFunction *support, void *userData, Gjk_Transform transform); - support(userData, d) gives back the 
+   point furthest along d in the shape's own space
+void gjk_setShapeTransform(Gjk_Shape *shape, Gjk_Transform transform); - call when it moves, works on any shape
+
+Circles and capsules don't get cut into points, and polygons don't have all their points moved each frame. The direction the 
+support function is looking in gets rotated into the shape's space, and only the one point it finds gets moved back out. 
+They all work with the cached and batch versions. Only polygons and boxes have points the cache can remember, so for circles, 
+capsules and custom shapes it just remembers the separating direction.
+
+Pairs you test every frame:
+
+If the same two shapes get tested every frame and only move a bit, keep a Gjk_PairCache for the pair (zero it to start) and use
+
+bool gjk_shapesCollide_cached(Gjk_Shape *a, Gjk_Shape *b, Gjk_PairCache *cache);
+Gjk_EPA_Info gjk_shapesCollide_withEPA_cached(Gjk_Shape *a, Gjk_Shape *b, Gjk_PairCache *cache);
+bool gjk_objectsCollide_cached(gjk_v2 *a, int aCount, gjk_v2 *b, int bCount, Gjk_PairCache *cache);
+Gjk_EPA_Info gjk_objectsCollide_withEPA_cached(gjk_v2 *a, int aCount, gjk_v2 *b, int bCount, Gjk_PairCache *cache);
+
+The cache remembers which points were furthest last time and how the test ended. If they were overlapping it rebuilds last frame's 
+triangle from the same points, and if that still holds the origin it's done without looking for any new points. If they were apart 
+it tries last frame's separating direction first, which usually settles it with one support point. 
+Support points are found by walking from the last one to a neighbour that's further along, instead of looking at every point.
+
+EPA's polygon has no size limit, it starts on the stack and moves to EASY_HEADERS_ALLOC if it gets past 32 edges. If it hasn't found the 
+edge after GJK_EPA_MAX_ITERATIONS (256, #define it before including to change it) new points it gives back the closest edge it has, 
+which can be slightly short. That only happens with round shapes with hundreds of points sunk deep into each other.
+
+Touching:
+
+Gjk_Result gjk_shapesTest(Gjk_Shape *a, Gjk_Shape *b); - GJK_SEPARATED, GJK_OVERLAPPING or GJK_TOUCHING
+Gjk_Result gjk_shapesTest_cached(Gjk_Shape *a, Gjk_Shape *b, Gjk_PairCache *cache);
+Gjk_Result gjk_objectsTest(gjk_v2 *a, int aCount, gjk_v2 *b, int bCount);
+
+GJK stops when a new support point doesn't get at least GJK_RELATIVE_EPSILON (1e-5 of how big the shapes' difference is) closer to
+the origin, when it gets the same point again, or after GJK_MAX_ITERATIONS (64) points. Any of those means the shapes are within
+that much of just touching, which is GJK_TOUCHING. The bool and EPA versions count touching as not colliding.
+Shapes sharing an edge, a corner sitting on an edge and points all in a line give an answer rather than going round forever.
+EPA stops on a quarter of the same relative tolerance, so tiny and huge shapes get the same accuracy.
+
+Contact points for a solver:
+
+Gjk_Manifold gjk_shapesManifold(Gjk_Shape *a, Gjk_Shape *b);
+Gjk_Manifold gjk_shapesManifold_cached(Gjk_Shape *a, Gjk_Shape *b, Gjk_PairCache *cache);
+Gjk_Manifold gjk_objectsManifold(gjk_v2 *a, int aCount, gjk_v2 *b, int bCount);
+
+Runs EPA, then clips the edge of one shape against the edge of the other that faces it most, which gives 1 or 2 contact points 
+each with its own depth. Two boxes resting on each other get a point at each corner instead of one wobbling about in the middle. 
+Each point has an id made from the edges and points that made it, so you can tell it's the same contact as last frame. 
+The depths are the real ones. The distance in Gjk_EPA_Info has GJK_EPA_SEPARATION (0.001) added on, so moving by it leaves them just apart.
+
+How far apart, and when they'll hit:
+
+Gjk_Distance_Info gjk_shapesDistance(Gjk_Shape *a, Gjk_Shape *b); - the gap between them and the closest point on each. 
+   If they overlap (or are within a tenth of GJK_RELATIVE_EPSILON of their size of touching) it only sets overlapping, use EPA for how far in they are.
+Gjk_Distance_Info gjk_objectsDistance(gjk_v2 *a, int aCount, gjk_v2 *b, int bCount);
+Gjk_TOI_Info gjk_shapesTimeOfImpact(Gjk_Shape *a, gjk_v2 moveA, Gjk_Shape *b, gjk_v2 moveB); - a moves by moveA and b by moveB 
+   this tick (no turning). If they touch on the way, hit is set and t says how far through the move, 0 to 1. 
+
+Time of impact stops when they're GJK_TOI_TOLERANCE apart, so moving both by t leaves them just short of touching. If a step lands 
+them overlapping (rounding, when they're big or fast enough that a float can't place them that finely) it halves back towards the last 
+t they were apart at, and gives that t if it can't get any closer. Fast things can't go through thin walls between ticks with it, 
+so there's no need to take smaller steps. Also, if the distance between two shapes is more than how far they move towards each other 
+this tick they can't hit, so you can skip them until they're closer.
+
+Lots of pairs at once:
+
+If you already have the list of pairs to test (i.e. from your own broadphase), hand them over in one go and they get split across threads:
+
+void gjk_initThreadPool(Gjk_ThreadPool *pool, int threadCount); - threadCount includes the thread you call gjk_collideBatch from, 0 means one per cpu
+void gjk_collideBatch(Gjk_ShapePair *pairs, int pairCount, Gjk_EPA_Info *results, Gjk_ThreadPool *pool); - results[i] is always the answer for pairs[i], 
+   however many threads there are. pool can be null to do it all on the calling thread.
+void gjk_freeThreadPool(Gjk_ThreadPool *pool);
+
+The threads sleep between batches. Each one starts with an even share of the pairs in chunks of GJK_BATCH_CHUNK (32) and steals chunks 
+off the others when it runs out, and keeps its own EPA scratch memory, so there are no locks or allocations while pairs are being tested.
+It uses pthreads, or Win32 threads on windows. #define GJK_NO_THREADS to leave them out, then the pool is always one thread.
+examples/gjk_batch_bench.c times 1, 2, 4... threads on the same pairs and checks the results don't change.
+
+If you've got your own job system use it instead of the pool:
+
+void gjk_collideBatch_withRunner(Gjk_ShapePair *pairs, int pairCount, Gjk_EPA_Info *results, Gjk_TaskRunner *runner);
+
+where runner->runTasks(runner->userData, task, taskData, taskCount) has to call task(taskData, i) for every i below taskCount and only return once 
+they're all done.
+
+IMPORTANT: for the cached versions the points have to go around a convex polygon in order (either way round) with no point repeated, 
+otherwise the walk can stop early. Zero the cache again if a shape's points change (not just move).
 
-/*
-TODO:
-- Make support function for circles
-- implement a stretch buffer for the simplex point count. Doens't have to be complex (or type safe? if we are the only ones using it.)
 */
 
+#ifndef EASY_GJK_H
+#define EASY_GJK_H
+
 #define gjk_arrayCount(array1) (sizeof(array1) / sizeof(array1[0]))
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#ifndef __cplusplus
+#include <stdbool.h>
+#endif
+
 #ifndef GJK_ASSERT
 #define GJK_ASSERT(statement) if(!(statement)) {printf("Something went wrong at line number: %d in %s\n", __LINE__, __FILE__); exit(0);}
 #endif
@@ -35,309 +191,2443 @@ TODO:
 #define GJK_IMPLEMENTATION 0
 #endif
 
+#ifndef EASY_HEADERS_ALLOC
+#define EASY_HEADERS_ALLOC(size) malloc(size)
+#endif
+
+#ifndef EASY_HEADERS_FREE
+#define EASY_HEADERS_FREE(ptr) free(ptr)
+#endif
+
+//NOTE: Every translation unit that includes this has to agree on GJK_DOUBLE_PRECISION, it changes the size of gjk_v2.
+#ifdef GJK_DOUBLE_PRECISION
+typedef double gjk_real;
+#define gjk_sqrt(x) sqrt(x)
+#define gjk_abs(x) fabs(x)
+#define gjk_cos(x) cos(x)
+#define gjk_sin(x) sin(x)
+#ifndef GJK_NO_SIMD
+#define GJK_NO_SIMD //the simd support functions only do floats
+#endif
+#else
+typedef float gjk_real;
+#define gjk_sqrt(x) sqrtf(x)
+#define gjk_abs(x) fabsf(x)
+#define gjk_cos(x) cosf(x)
+#define gjk_sin(x) sinf(x)
+#endif
+
 typedef struct {
-    float x, y;
+    gjk_real x, y;
 } gjk_v2;
 
-gjk_v2 gjk_V2(float x, float y) {
-    gjk_v2 result = {};
+//NOTE: The little vector functions are inline static so every file that includes the header can inline them, 
+//not just the one with the implementation.
+inline static gjk_v2 gjk_V2(gjk_real x, gjk_real y) {
+    gjk_v2 result;
     result.x = x;
     result.y = y;
     return result;
 }
 
+inline static gjk_real gjk_dot(gjk_v2 a, gjk_v2 b) {
+    gjk_real result = a.x*b.x + a.y*b.y;
+    return result;
+}
+
+inline static gjk_v2 gjk_negate_v2(gjk_v2 a) {
+    gjk_v2 result = gjk_V2(-a.x, -a.y);
+    return result;
+}
+
+inline static gjk_v2 gjk_perp2D(gjk_v2 a) {
+    gjk_v2 result = gjk_V2(-a.y, a.x);
+    return result;
+}
+
+inline static gjk_v2 gjk_normalize_2D(gjk_v2 a) {
+  gjk_real length = gjk_sqrt(a.x*a.x + a.y*a.y);
+  if(length == 0) {
+    length = 1;
+    printf("gjk length was equal to zero\n");
+  }
+  gjk_v2 result = gjk_V2(a.x/length, a.y/length);
+  return result;
+}
+
 typedef struct {
-    //Our simplex is no longer confined to size of three since we use it for the EPA routine as well. 
-    gjk_v2 p[32]; //TODO(ollie): change this to using a stretchy buffer so we can have abritarily big shapes!!
+    //NOTE: EPA builds its own polygon (Gjk_EpaPolytope_) from this, so GJK only ever needs a triangle
+    gjk_v2 p[3];
     int count;
-} Simplex;
+} Gjk_Simplex;
 
 typedef struct {
   bool collided;
-  Simplex simplex;
-} GjkInfo;
+  Gjk_Simplex simplex;
+} Gjk_Info;
 
 typedef struct {
   bool collided;
   gjk_v2 normal;
-  float distance;
+  gjk_real distance;
 } Gjk_EPA_Info;
 
+//NOTE: An edge of EPA's polygon. Its normal points away from the origin. 
 typedef struct {
+  gjk_v2 a;
+  gjk_v2 b;
   gjk_v2 normal;
-  int index;
-  float distance;
-} EPA_Edge;
+  gjk_real distance;
+} Gjk_EpaEdge_;
+
+#define GJK_EPA_INLINE_EDGES 32
+//NOTE: The edges of EPA's polygon kept as a min heap on distance, so the closest one is always edges[0]. 
+//Starts on the inline array and moves to EASY_HEADERS_ALLOC if it gets bigger than that.
+typedef struct {
+  Gjk_EpaEdge_ *edges;
+  int count;
+  int capacity;
+  Gjk_EpaEdge_ inlineEdges[GJK_EPA_INLINE_EDGES];
+} Gjk_EpaPolytope_;
+
+#ifndef GJK_EPA_MAX_ITERATIONS
+//NOTE: After this many points EPA gives back the closest edge it has instead of carrying on. Only round shapes
+//with lots of points get near it.
+#define GJK_EPA_MAX_ITERATIONS 256
+#endif
 
 bool gjk_objectsCollide(gjk_v2 *a, int aCount, gjk_v2 *b, int bCount);
 Gjk_EPA_Info gjk_objectsCollide_withEPA(gjk_v2 *a, int aCount, gjk_v2 *b, int bCount);
+gjk_v2 gjk_support(gjk_v2 d, gjk_v2 *a, int aCount, gjk_v2 *b, int bCount);
 
-#if GJK_IMPLEMENTATION 
+typedef enum {
+  GJK_SIMD_NONE = 0,
+  GJK_SIMD_SSE2,
+  GJK_SIMD_AVX,
+} Gjk_SimdLevel;
 
-float gjk_dot(gjk_v2 a, gjk_v2 b) {
-    float result = a.x*b.x + a.y*b.y;
-    return result;
-}
+Gjk_SimdLevel gjk_getSimdLevel(void);
+void gjk_setSimdLevel(Gjk_SimdLevel level);
 
-gjk_v2 gjk_negate_v2(gjk_v2 a) {
-    gjk_v2 result = gjk_V2(-a.x, -a.y);
-    return result;
-}
+typedef struct {
+  gjk_real *x; //count rounded up to a multiple of 8, the extra ones repeat the last point so they never win
+  gjk_real *y;
+  int count;
+  void *memory_; //what was allocated, x and y are aligned to 32 inside it
+} Gjk_SoaPolygon;
 
-gjk_v2 gjk_normalize_2D(gjk_v2 a) {
-  float length = sqrt(a.x*a.x + a.y*a.y);
-  if(length == 0) {
-    length = 1;
-    printf("gjk length was equal to zero\n");
-  }
-  gjk_v2 result = gjk_V2(a.x/length, a.y/length);
-  return result;
+void gjk_initSoaPolygon(Gjk_SoaPolygon *polygon, gjk_v2 *points, int count);
+void gjk_freeSoaPolygon(Gjk_SoaPolygon *polygon);
 
-}
+typedef enum {
+  GJK_SHAPE_POLYGON, //a gjk_v2 array
+  GJK_SHAPE_SOA_POLYGON,
+  GJK_SHAPE_CIRCLE, //radius round the origin
+  GJK_SHAPE_CAPSULE, //a line from (-halfLength, 0) to (halfLength, 0) with radius round it
+  GJK_SHAPE_BOX, //halfSize each way from the origin
+  GJK_SHAPE_CUSTOM, //your own support function
+} Gjk_ShapeType;
 
-void gjk_addPointAt(Simplex *simplex, gjk_v2 p, int insertAt) {
-    if(simplex->count >= gjk_arrayCount(simplex->p)) {
-      //TODO: change this to using a stretchy buffer!
-      GJK_ASSERT(!"we went over our limit");
-    }
-    //move all points foward by one to fit new point in
-    for(int i = simplex->count - 1; i >= insertAt; --i) {
-      simplex->p[i + 1] = simplex->p[i];
-      GJK_ASSERT((i + 1) < gjk_arrayCount(simplex->p));
-    }
-    ///
+//NOTE: a rotation then a move. Kept as cos/sin so the support functions don't do any trig.
+typedef struct {
+  gjk_v2 position;
+  gjk_real cosAngle;
+  gjk_real sinAngle;
+} Gjk_Transform;
 
-    //////add the new point
-    simplex->count++;
-    simplex->p[insertAt] = p;
-    ///
-}
+//NOTE: the point of your shape furthest along d, both in the shape's local space. d isn't normalized and can be zero.
+typedef gjk_v2 Gjk_SupportFunction(void *userData, gjk_v2 d);
+
+typedef struct {
+  Gjk_ShapeType type;
+  gjk_v2 *points; //GJK_SHAPE_POLYGON
+  int count; //how many points the shape has that the cache can index, 0 for the round ones and custom
+  Gjk_SoaPolygon *soa; //GJK_SHAPE_SOA_POLYGON
+  gjk_real radius; //GJK_SHAPE_CIRCLE, GJK_SHAPE_CAPSULE
+  gjk_real halfLength; //GJK_SHAPE_CAPSULE
+  gjk_v2 halfSize; //GJK_SHAPE_BOX
+  Gjk_SupportFunction *support; //GJK_SHAPE_CUSTOM
+  void *userData; //GJK_SHAPE_CUSTOM
+
+  //NOTE: if transformed is set the shape is in local space and gets moved by transform. The direction gets turned into 
+  //local space instead of moving every point.
+  bool transformed;
+  Gjk_Transform transform;
+} Gjk_Shape;
+
+Gjk_Transform gjk_transform(gjk_v2 position, gjk_real angle);
+Gjk_Shape gjk_polygonShape(gjk_v2 *points, int count);
+Gjk_Shape gjk_soaPolygonShape(Gjk_SoaPolygon *polygon);
+Gjk_Shape gjk_localPolygonShape(gjk_v2 *points, int count, Gjk_Transform transform);
+Gjk_Shape gjk_circleShape(gjk_real radius, Gjk_Transform transform);
+Gjk_Shape gjk_capsuleShape(gjk_real halfLength, gjk_real radius, Gjk_Transform transform);
+Gjk_Shape gjk_boxShape(gjk_v2 halfSize, Gjk_Transform transform);
+Gjk_Shape gjk_customShape(Gjk_SupportFunction *support, void *userData, Gjk_Transform transform);
+void gjk_setShapeTransform(Gjk_Shape *shape, Gjk_Transform transform);
+bool gjk_shapesCollide(Gjk_Shape *a, Gjk_Shape *b);
+Gjk_EPA_Info gjk_shapesCollide_withEPA(Gjk_Shape *a, Gjk_Shape *b);
+
+//NOTE: zero it before the first test. All indexes are into the shapes' points.
+typedef struct {
+  int supportA, supportB; //where the walk starts for each shape
+  gjk_v2 direction; //the separating direction from last time, zero if they overlapped
+  int simplexCount; //3 if they overlapped last time, then these are the points of the triangle that held the origin
+  int simplexA[3];
+  int simplexB[3];
+} Gjk_PairCache;
+
+bool gjk_shapesCollide_cached(Gjk_Shape *a, Gjk_Shape *b, Gjk_PairCache *cache);
+Gjk_EPA_Info gjk_shapesCollide_withEPA_cached(Gjk_Shape *a, Gjk_Shape *b, Gjk_PairCache *cache);
+bool gjk_objectsCollide_cached(gjk_v2 *a, int aCount, gjk_v2 *b, int bCount, Gjk_PairCache *cache);
+Gjk_EPA_Info gjk_objectsCollide_withEPA_cached(gjk_v2 *a, int aCount, gjk_v2 *b, int bCount, Gjk_PairCache *cache);
+
+typedef enum {
+  GJK_SEPARATED = 0,
+  GJK_OVERLAPPING,
+  GJK_TOUCHING, //within GJK_RELATIVE_EPSILON of touching, either way. The bool versions count this as not colliding.
+} Gjk_Result;
+
+Gjk_Result gjk_shapesTest(Gjk_Shape *a, Gjk_Shape *b);
+Gjk_Result gjk_shapesTest_cached(Gjk_Shape *a, Gjk_Shape *b, Gjk_PairCache *cache);
+Gjk_Result gjk_objectsTest(gjk_v2 *a, int aCount, gjk_v2 *b, int bCount);
+
+#ifndef GJK_MAX_ITERATIONS
+//NOTE: GJK gives up and says GJK_TOUCHING after this many support points. Polygons never get near it, it's there so 
+//round shapes that are only just touching can't go round forever.
+#define GJK_MAX_ITERATIONS 64
+#endif
+
+#ifndef GJK_RELATIVE_EPSILON
+//NOTE: how close counts as touching, as a fraction of how far the points of the shapes' difference are from the origin. 
+//A new support point has to get at least this much further towards the origin or GJK stops.
+#ifdef GJK_DOUBLE_PRECISION
+#define GJK_RELATIVE_EPSILON 1e-10
+#else
+#define GJK_RELATIVE_EPSILON 1e-5f
+#endif
+#endif
+
+typedef struct {
+  bool overlapping; //if so distance is 0 and the points don't mean anything, use EPA for how far in they are
+  gjk_real distance;
+  gjk_v2 pointA; //the closest point on a
+  gjk_v2 pointB; //the closest point on b
+  gjk_v2 normal; //from a towards b
+} Gjk_Distance_Info;
+
+typedef struct {
+  bool hit;
+  gjk_real t; //how far through the move they touch, 0 to 1
+  gjk_v2 normal; //from a towards b when they touch
+  gjk_v2 point; //where they touch, with both moved on by t
+} Gjk_TOI_Info;
+
+#ifndef GJK_DISTANCE_MAX_ITERATIONS
+#define GJK_DISTANCE_MAX_ITERATIONS 32
+#endif
+
+#ifndef GJK_TOI_MAX_ITERATIONS
+#define GJK_TOI_MAX_ITERATIONS 32
+#endif
+
+#ifndef GJK_TOI_TOLERANCE
+//NOTE: time of impact stops once they're this close, so they end up just apart rather than just touching
+#define GJK_TOI_TOLERANCE 0.001f
+#endif
+
+Gjk_Distance_Info gjk_shapesDistance(Gjk_Shape *a, Gjk_Shape *b);
+Gjk_Distance_Info gjk_objectsDistance(gjk_v2 *a, int aCount, gjk_v2 *b, int bCount);
+Gjk_TOI_Info gjk_shapesTimeOfImpact(Gjk_Shape *a, gjk_v2 moveA, Gjk_Shape *b, gjk_v2 moveB);
+
+//NOTE: A contact point's id packs which features made it: the reference edge (the index of its first point) in bits 0-14, 
+//the incident point (or the reference point it got clipped to) in bits 15-29, bit 30 if it got clipped and bit 31 if b 
+//had the reference edge. It stays the same from frame to frame while the same features are touching, so you can match 
+//points up to carry over things like the solver's impulses.
+typedef struct {
+  gjk_v2 point; //on the surface of the shape that's poking in (the incident one)
+  gjk_real depth;
+  unsigned int id;
+} Gjk_ContactPoint;
+
+typedef struct {
+  bool collided;
+  gjk_v2 normal; //same way round as Gjk_EPA_Info, moving a along normal*depth separates them
+  gjk_real depth; //the deepest point, no GJK_EPA_SEPARATION added on
+  int pointCount; //1 or 2 when they collided
+  Gjk_ContactPoint points[2];
+  bool referenceIsB; //which shape's edge the points got clipped against
+  int referenceEdge; //index of the reference edge's first point, -1 if it isn't a shape with points
+  int incidentEdge; //same for the other shape's edge, -1 if that was a single point (i.e. a circle)
+} Gjk_Manifold;
+
+Gjk_Manifold gjk_shapesManifold(Gjk_Shape *a, Gjk_Shape *b);
+Gjk_Manifold gjk_shapesManifold_cached(Gjk_Shape *a, Gjk_Shape *b, Gjk_PairCache *cache);
+Gjk_Manifold gjk_objectsManifold(gjk_v2 *a, int aCount, gjk_v2 *b, int bCount);
+
+typedef struct {
+  gjk_real minX, minY, maxX, maxY;
+} Gjk_Aabb;
 
-void gjk_addPoint(Simplex *simplex, gjk_v2 p) {
-    if(simplex->count >= gjk_arrayCount(simplex->p)) {
-      //TODO: change this to a stretchy buffer!
+typedef struct {
+  gjk_v2 *points; //not owned. null when the body has been removed
+  int count;
+  Gjk_Aabb aabb;
+  int nextFree; //next removed body when this one is removed
+} Gjk_Body;
+
+//NOTE: what the sweep runs over. A copy of the box so sorting and sweeping never touch the bodies.
+typedef struct {
+  Gjk_Aabb aabb;
+  int id;
+} Gjk_SweepEntry;
+
+typedef struct {
+  int a, b; //body ids, a < b
+} Gjk_Pair;
+
+typedef struct {
+  int a, b; //body ids, a < b
+  gjk_v2 normal; //only with EPA. Moving a by normal*distance separates them.
+  gjk_real distance;
+} Gjk_Contact;
+
+typedef struct {
+  Gjk_Body *bodies;
+  int bodyCount;
+  int bodyCapacity;
+  int firstFree; //-1 if none
+
+  Gjk_SweepEntry *sweep; //sorted by aabb.minX, kept between calls
+  int sweepCount;
+  int sweepCapacity;
+  bool sweepDirty; //bodies were added or removed, so sort from scratch
+
+  Gjk_Pair *pairs; //filled by gjk_findPairs
+  int pairCount;
+  int pairCapacity;
+} Gjk_World;
+
+void gjk_initWorld(Gjk_World *world);
+void gjk_freeWorld(Gjk_World *world);
+int gjk_addBody(Gjk_World *world, gjk_v2 *points, int count);
+void gjk_updateBody(Gjk_World *world, int id, gjk_v2 *points, int count);
+void gjk_removeBody(Gjk_World *world, int id);
+int gjk_findPairs(Gjk_World *world);
+int gjk_collideWorld(Gjk_World *world, Gjk_Contact *contacts, int contactCapacity, bool withEPA);
+
+//////////////////////////////////////////////// Batches ////////////////////////////////////////////////
+
+typedef struct {
+  Gjk_Shape *a;
+  Gjk_Shape *b;
+} Gjk_ShapePair;
+
+//NOTE: Your job system runs these. taskIndex goes from 0 to taskCount - 1.
+typedef void Gjk_TaskFunction(void *taskData, int taskIndex);
+
+typedef struct {
+  //NOTE: has to call task(taskData, i) for every i from 0 to taskCount - 1, on whatever threads it likes, and only return once they've all finished
+  void (*runTasks)(void *userData, Gjk_TaskFunction *task, void *taskData, int taskCount);
+  void *userData;
+} Gjk_TaskRunner;
+
+//NOTE: What's in here is up to the platform (threads, the ranges of work each one has and how they wait), see gjk_initThreadPool
+typedef struct {
+  int threadCount; //including the thread that calls gjk_collideBatch
+  void *internal_;
+} Gjk_ThreadPool;
+
+#ifndef GJK_BATCH_CHUNK
+//NOTE: how many pairs a thread takes at a time. Threads steal whole chunks off each other.
+#define GJK_BATCH_CHUNK 32
+#endif
+
+void gjk_initThreadPool(Gjk_ThreadPool *pool, int threadCount);
+void gjk_freeThreadPool(Gjk_ThreadPool *pool);
+void gjk_collideBatch(Gjk_ShapePair *pairs, int pairCount, Gjk_EPA_Info *results, Gjk_ThreadPool *pool);
+void gjk_collideBatch_withRunner(Gjk_ShapePair *pairs, int pairCount, Gjk_EPA_Info *results, Gjk_TaskRunner *runner);
+
+#if GJK_IMPLEMENTATION 
+
+static void gjk_addPoint_(Gjk_Simplex *simplex, gjk_v2 p) {
+    if(simplex->count >= (int)gjk_arrayCount(simplex->p)) {
       GJK_ASSERT(!"we went over our limit");
     }
     simplex->p[simplex->count++] = p;
 }
 
-gjk_v2 gjk_perp2D(gjk_v2 a) {
-    gjk_v2 result = {-a.y, a.x};
+//////////////////////////////////////////////// Support function ////////////////////////////////////////////////
+
+#if !defined(GJK_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86))
+#define GJK_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define GJK_TARGET(isa)
+#else
+#define GJK_TARGET(isa) __attribute__((target(isa)))
+#endif
+#else
+#define GJK_X86 0
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define GJK_NOINLINE __declspec(noinline)
+#else
+#define GJK_NOINLINE __attribute__((noinline))
+#endif
+
+//NOTE: below this many points the plain loop wins. sse2 beats avx until there are a lot more, there's less to set up and reduce, 
+//and avx on gjk_v2 arrays has to shuffle twice as much, on some cpus it only breaks even around 512.
+#define GJK_SIMD_MIN_POINTS 16
+#define GJK_AVX_MIN_POINTS 512
+#define GJK_AVX_MIN_POINTS_SOA 64
+
+static int gjk_simdLevel_ = -1; //-1 means we haven't looked at the cpu yet
+
+static Gjk_SimdLevel gjk_detectSimdLevel(void) {
+    Gjk_SimdLevel result = GJK_SIMD_NONE;
+#if GJK_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    if(info[3] & (1 << 26)) { result = GJK_SIMD_SSE2; }
+    //NOTE: avx also needs the os to save the ymm registers (osxsave + xgetbv)
+    if((info[2] & (1 << 28)) && (info[2] & (1 << 27)) && ((_xgetbv(0) & 6) == 6)) { result = GJK_SIMD_AVX; }
+#else
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("sse2")) { result = GJK_SIMD_SSE2; }
+    if(__builtin_cpu_supports("avx")) { result = GJK_SIMD_AVX; }
+#endif
+#endif
     return result;
 }
 
-gjk_v2 gjk_support(gjk_v2 d, gjk_v2 *a, int aCount, gjk_v2 *b, int bCount) {
-    float maxDistA = 0; //set in loop
-    gjk_v2 maxA = {};
-    float maxDistB = 0; //set in loop
-    gjk_v2 maxB = {};
-    
-    for(int i = 0; i < aCount; ++i) {
-        gjk_v2 aPoint = a[i];
-        float dist = gjk_dot(aPoint, d);
-        if (dist > maxDistA || i == 0) { //or first element
-            maxDistA = dist;
-            maxA = aPoint;
-        }
+Gjk_SimdLevel gjk_getSimdLevel(void) {
+    if(gjk_simdLevel_ < 0) {
+        gjk_simdLevel_ = (int)gjk_detectSimdLevel();
     }
-    
-    for(int j = 0; j < bCount; ++j) {
-        gjk_v2 bPoint = b[j];
-        float dist = gjk_dot(bPoint, gjk_V2(-d.x, -d.y));
-        if (dist > maxDistB || j == 0) { //or first element
-            maxDistB = dist;
-            maxB = bPoint;
+    return (Gjk_SimdLevel)gjk_simdLevel_;
+}
+
+void gjk_setSimdLevel(Gjk_SimdLevel level) {
+    //NOTE: Can't go higher than what the cpu actually supports
+    Gjk_SimdLevel supported = gjk_detectSimdLevel();
+    if(level > supported) { level = supported; }
+    gjk_simdLevel_ = (int)level;
+}
+
+//NOTE: All of these return the index of the point furthest along d. If there's a tie it's the first one, same as the plain loop,
+//so every level gives back the same point.
+static int gjk_furthestPoint_scalar(gjk_v2 *points, int count, gjk_v2 d) {
+    gjk_real maxDist = 0; //set in loop
+    int result = 0;
+    for(int i = 0; i < count; ++i) {
+        gjk_real dist = gjk_dot(points[i], d);
+        if (dist > maxDist || i == 0) { //or first element
+            maxDist = dist;
+            result = i;
         }
     }
-
-    gjk_v2 result = gjk_V2(maxA.x - maxB.x, maxA.y - maxB.y); //do our Minksowski difference (can decompose the function based on Caesy's video)
     return result;
 }
 
-bool doSimplex(Simplex *simplex, gjk_v2 *d) { //update both of these
-  bool result = false;
-  switch(simplex->count) {
-      case 1: {
-          GJK_ASSERT(!"Shouldn't ever be one point");
-      } break;
-      case 2: { //line
-          gjk_v2 a = simplex->p[1];
-          gjk_v2 b = simplex->p[0];
-          gjk_v2 ao = gjk_V2(-a.x, -a.y);
-          gjk_v2 ab = gjk_V2(b.x - a.x, b.y - a.y);
-          if(gjk_dot(ab, ao)) {  //is inside the line boundary
-              //don't have to update simplex
-              gjk_v2 dir = gjk_perp2D(ab);
-              if(gjk_dot(dir, ao) < 0) { //pointing the wrong direction 
-                  dir = gjk_negate_v2(dir); //negate vector to point in right direction
-                  GJK_ASSERT(gjk_dot(dir, ao) >= 0);
-                  //make the winding clockwise
-                  simplex->p[0] = a;
-                  simplex->p[1] = b;
-              } 
-              *d = dir;
-          } else {
-              simplex->p[0] = a;
-              simplex->count = 1;
-              *d = ao;
-          }
-      } break;
-      case 3: { //triangle
-        gjk_v2 a = simplex->p[2];
-        gjk_v2 b = simplex->p[1];
-        gjk_v2 c = simplex->p[0];
-        gjk_v2 ao = gjk_V2(-a.x, -a.y);
-        gjk_v2 ab = gjk_V2(b.x - a.x, b.y - a.y);
-        gjk_v2 ac = gjk_V2(c.x - a.x, c.y - a.y);
-        //make sure there is consistent winding (clockwise)
-        if(gjk_dot(gjk_perp2D(ac), ab) > 0) { 
-            //the simplex should always be clockwise. Made sure of this in the 'line' case
-            GJK_ASSERT(!"invalid code path");
-            b = simplex->p[0];
-            c = simplex->p[1];
-            gjk_v2 temp = ab;
-            ab = ac;
-            ac = temp;
-            GJK_ASSERT(gjk_dot(gjk_perp2D(ab), ac) > 0);
-        }
-        /////
-        gjk_v2 perpAc = gjk_perp2D(ac);
-        bool onLeft = (gjk_dot(perpAc, ao) > 0);
-        
-        gjk_v2 perpAb = gjk_negate_v2(gjk_perp2D(ab));
-        bool onRight = (gjk_dot(perpAb, ao) > 0);
-        
-        bool simpleCase = false;
-        if(!onLeft && !onRight) {
-          result = true;
-          break;
-        } else if(onLeft) {
-          GJK_ASSERT(!onRight);
-          if(gjk_dot(ac, ao) > 0) {
-            *d = perpAc;
-            simplex->p[0] = c;
-            simplex->p[1] = a;
-            simplex->count = 2;
-          } else {
-            simpleCase = true;
-          }
-        } else if(onRight) {
-          GJK_ASSERT(!onLeft);
-          if(gjk_dot(ab, ao) > 0) {
-            *d = perpAb;
-            simplex->p[1] = b;
-            simplex->p[0] = a;
-            simplex->count = 2;
-          } else {
-            simpleCase = true;
-          }
-        } 
-          if(simpleCase) {
-            simplex->p[0] = a;
-            simplex->count = 1;
-            *d = ao;
-          }			
-        } break;
-        default: {
-          GJK_ASSERT(!"invalid code path");
+#if GJK_X86
+//NOTE: each lane keeps the best it has seen, then the lanes are compared. Ties go to the lower index so it matches the plain loop.
+static int gjk_pickBestLane_(float *dists, float *indexes, int laneCount) {
+    int best = 0;
+    for(int i = 1; i < laneCount; ++i) {
+        if(dists[i] > dists[best] || (dists[i] == dists[best] && indexes[i] < indexes[best])) {
+            best = i;
         }
-      }
-  return result;
+    }
+    return best;
 }
 
-GjkInfo gjk_objectsCollide_(gjk_v2 *a, int aCount, gjk_v2 *b, int bCount) {
-  bool result = false;
-  GjkInfo info = {};
-  if(aCount < 3 || bCount < 3) return info; //early out if not a full shape
-  
-  gjk_v2 s = gjk_support(gjk_V2(1, 0), a, aCount, b, bCount);
-  Simplex simplex = {};
-  simplex.p[0] = s;
-  simplex.count = 1;
-  gjk_v2 d = gjk_V2(-s.x, -s.y);
-  while(true) {
-    gjk_v2 p = gjk_support(d, a, aCount, b, bCount);
-    if(gjk_dot(p, d) < 0) {
-      result = false;
-      break;
+//NOTE: One step of the argmax. indexes are kept as floats so it's all one register type, they're exact up to 16 million points.
+//The kernels run two of these side by side, otherwise every step waits on the max from the step before.
+#define GJK_ARGMAX_STEP_SSE2(dist, bestDist, bestIndex, index) { \
+        __m128 better = _mm_cmpgt_ps(dist, bestDist); \
+        bestDist = _mm_max_ps(dist, bestDist); \
+        bestIndex = _mm_or_ps(_mm_and_ps(better, index), _mm_andnot_ps(better, bestIndex)); \
     }
-    gjk_addPoint(&simplex, p);
-    GJK_ASSERT(simplex.count >= 2 && simplex.count <= 3); //make sure we haven't gone over
-    if(doSimplex(&simplex, &d)) {
-      result = true;
-      break;
+
+#define GJK_ARGMAX_STEP_AVX(dist, bestDist, bestIndex, index) { \
+        __m256 better = _mm256_cmp_ps(dist, bestDist, _CMP_GT_OQ); \
+        bestDist = _mm256_max_ps(dist, bestDist); \
+        bestIndex = _mm256_or_ps(_mm256_and_ps(better, index), _mm256_andnot_ps(better, bestIndex)); \
     }
-  }
-  
-  info.collided = result;
-  info.simplex = simplex;
 
-  return info;
+//NOTE: finishes off the points the simd loop didn't get to, they all come after the ones it did so only a bigger one wins
+static int gjk_furthestPointTail_(gjk_v2 *points, int start, int count, gjk_v2 d, float maxDist, int result) {
+    for(int i = start; i < count; ++i) {
+        float dist = gjk_dot(points[i], d);
+        if(dist > maxDist) {
+            maxDist = dist;
+            result = i;
+        }
+    }
+    return result;
 }
 
-EPA_Edge GJK_EPA_findClosestEdge(Simplex *simplex) {
-  //We assume our simplex is wound clockwise 
-  EPA_Edge result = {};
-  for(int i = 0; i < simplex->count; ++i) {
-    int aIndex = i;
-    int bIndex = (i == (simplex->count - 1)) ? 0 : i + 1; //wrap the index around 
-    gjk_v2 pointA = simplex->p[aIndex];
-    gjk_v2 pointB = simplex->p[bIndex];
-
-    gjk_v2 ao = gjk_V2(-pointA.x, -pointA.y);
-    //assume clockwise winding
-    gjk_v2 ab = gjk_V2(pointB.x - pointA.x, pointB.y - pointA.y);  //goes from a -> b
-    gjk_v2 edgeNormal = gjk_normalize_2D(gjk_perp2D(ab)); //This will be pointing away from the origin with clockwise winding
-    float dist = gjk_dot(edgeNormal, ao); //find dist from the edge. NOTE: The closest distance is always the perpindicular distance from the edge. This is why it works. (I was getting confused about this.)
-    GJK_ASSERT(dist <= 0); //this is to assert for colckwise winding, and therefore normal is towards the origin. 
-    dist *= -1; //Make distance negative 
-    GJK_ASSERT(dist >= 0);
-    if(dist < result.distance || i == 0) { //or first edge to initialize struct 
-      //shorter edge is found
-      result.distance = dist;
-      result.index = bIndex;
-      result.normal = edgeNormal;
+GJK_TARGET("sse2") static int gjk_furthestPoint_sse2(gjk_v2 *points, int count, gjk_v2 d) {
+    __m128 dx = _mm_set1_ps(d.x);
+    __m128 dy = _mm_set1_ps(d.y);
+    __m128 bestDist[2] = { _mm_set1_ps(-INFINITY), _mm_set1_ps(-INFINITY) };
+    __m128 bestIndex[2] = { _mm_setzero_ps(), _mm_setzero_ps() };
+    __m128 index0 = _mm_setr_ps(0, 1, 2, 3);
+    __m128 index1 = _mm_setr_ps(4, 5, 6, 7);
+    __m128 eight = _mm_set1_ps(8);
+    int i = 0;
+    for(; i + 8 <= count; i += 8) {
+        //NOTE: x0 y0 x1 y1, x2 y2 x3 y3 -> x0 x1 x2 x3, y0 y1 y2 y3
+        __m128 p01 = _mm_loadu_ps(&points[i].x);
+        __m128 p23 = _mm_loadu_ps(&points[i + 2].x);
+        __m128 p45 = _mm_loadu_ps(&points[i + 4].x);
+        __m128 p67 = _mm_loadu_ps(&points[i + 6].x);
+        __m128 x0 = _mm_shuffle_ps(p01, p23, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 y0 = _mm_shuffle_ps(p01, p23, _MM_SHUFFLE(3, 1, 3, 1));
+        __m128 x1 = _mm_shuffle_ps(p45, p67, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 y1 = _mm_shuffle_ps(p45, p67, _MM_SHUFFLE(3, 1, 3, 1));
+        __m128 dist0 = _mm_add_ps(_mm_mul_ps(x0, dx), _mm_mul_ps(y0, dy));
+        __m128 dist1 = _mm_add_ps(_mm_mul_ps(x1, dx), _mm_mul_ps(y1, dy));
+        GJK_ARGMAX_STEP_SSE2(dist0, bestDist[0], bestIndex[0], index0);
+        GJK_ARGMAX_STEP_SSE2(dist1, bestDist[1], bestIndex[1], index1);
+        index0 = _mm_add_ps(index0, eight);
+        index1 = _mm_add_ps(index1, eight);
     }
-  }
+    float dists[8], indexes[8];
+    _mm_storeu_ps(dists, bestDist[0]);
+    _mm_storeu_ps(dists + 4, bestDist[1]);
+    _mm_storeu_ps(indexes, bestIndex[0]);
+    _mm_storeu_ps(indexes + 4, bestIndex[1]);
+    int lane = gjk_pickBestLane_(dists, indexes, 8);
+    return gjk_furthestPointTail_(points, i, count, d, dists[lane], (int)indexes[lane]);
+}
 
-  return result;
+GJK_TARGET("avx") static int gjk_furthestPoint_avx(gjk_v2 *points, int count, gjk_v2 d) {
+    __m256 dx = _mm256_set1_ps(d.x);
+    __m256 dy = _mm256_set1_ps(d.y);
+    __m256 bestDist[2] = { _mm256_set1_ps(-INFINITY), _mm256_set1_ps(-INFINITY) };
+    __m256 bestIndex[2] = { _mm256_setzero_ps(), _mm256_setzero_ps() };
+    //NOTE: the shuffles work inside each 128 bit half, so the points come out in the order 0 1 4 5 2 3 6 7
+    __m256 index0 = _mm256_setr_ps(0, 1, 4, 5, 2, 3, 6, 7);
+    __m256 index1 = _mm256_setr_ps(8, 9, 12, 13, 10, 11, 14, 15);
+    __m256 sixteen = _mm256_set1_ps(16);
+    int i = 0;
+    for(; i + 16 <= count; i += 16) {
+        __m256 p0 = _mm256_loadu_ps(&points[i].x); //x0 y0 x1 y1 | x2 y2 x3 y3
+        __m256 p1 = _mm256_loadu_ps(&points[i + 4].x); //x4 y4 x5 y5 | x6 y6 x7 y7
+        __m256 p2 = _mm256_loadu_ps(&points[i + 8].x);
+        __m256 p3 = _mm256_loadu_ps(&points[i + 12].x);
+        __m256 x0 = _mm256_shuffle_ps(p0, p1, _MM_SHUFFLE(2, 0, 2, 0));
+        __m256 y0 = _mm256_shuffle_ps(p0, p1, _MM_SHUFFLE(3, 1, 3, 1));
+        __m256 x1 = _mm256_shuffle_ps(p2, p3, _MM_SHUFFLE(2, 0, 2, 0));
+        __m256 y1 = _mm256_shuffle_ps(p2, p3, _MM_SHUFFLE(3, 1, 3, 1));
+        __m256 dist0 = _mm256_add_ps(_mm256_mul_ps(x0, dx), _mm256_mul_ps(y0, dy));
+        __m256 dist1 = _mm256_add_ps(_mm256_mul_ps(x1, dx), _mm256_mul_ps(y1, dy));
+        GJK_ARGMAX_STEP_AVX(dist0, bestDist[0], bestIndex[0], index0);
+        GJK_ARGMAX_STEP_AVX(dist1, bestDist[1], bestIndex[1], index1);
+        index0 = _mm256_add_ps(index0, sixteen);
+        index1 = _mm256_add_ps(index1, sixteen);
+    }
+    float dists[16], indexes[16];
+    _mm256_storeu_ps(dists, bestDist[0]);
+    _mm256_storeu_ps(dists + 8, bestDist[1]);
+    _mm256_storeu_ps(indexes, bestIndex[0]);
+    _mm256_storeu_ps(indexes + 8, bestIndex[1]);
+    int lane = gjk_pickBestLane_(dists, indexes, 16);
+    return gjk_furthestPointTail_(points, i, count, d, dists[lane], (int)indexes[lane]);
 }
 
-#define GJK_TOLERANCE 0.00001
-Gjk_EPA_Info gjk_objectsCollide_withEPA(gjk_v2 *a, int aCount, gjk_v2 *b, int bCount) {
-    Gjk_EPA_Info result = {};
-    GjkInfo info = gjk_objectsCollide_(a, aCount, b, bCount);
-    result.collided = info.collided;
-    if(result.collided) { //if there is a collision, find the penetration vector to resolve the collision
+//NOTE: Soa polygons are padded to 8 with copies of the last point, so there's no tail to do
+GJK_TARGET("sse2") static int gjk_furthestPointSoa_sse2(float *xs, float *ys, int paddedCount, gjk_v2 d) {
+    __m128 dx = _mm_set1_ps(d.x);
+    __m128 dy = _mm_set1_ps(d.y);
+    __m128 bestDist[2] = { _mm_set1_ps(-INFINITY), _mm_set1_ps(-INFINITY) };
+    __m128 bestIndex[2] = { _mm_setzero_ps(), _mm_setzero_ps() };
+    __m128 index0 = _mm_setr_ps(0, 1, 2, 3);
+    __m128 index1 = _mm_setr_ps(4, 5, 6, 7);
+    __m128 eight = _mm_set1_ps(8);
+    for(int i = 0; i < paddedCount; i += 8) {
+        __m128 dist0 = _mm_add_ps(_mm_mul_ps(_mm_load_ps(xs + i), dx), _mm_mul_ps(_mm_load_ps(ys + i), dy));
+        __m128 dist1 = _mm_add_ps(_mm_mul_ps(_mm_load_ps(xs + i + 4), dx), _mm_mul_ps(_mm_load_ps(ys + i + 4), dy));
+        GJK_ARGMAX_STEP_SSE2(dist0, bestDist[0], bestIndex[0], index0);
+        GJK_ARGMAX_STEP_SSE2(dist1, bestDist[1], bestIndex[1], index1);
+        index0 = _mm_add_ps(index0, eight);
+        index1 = _mm_add_ps(index1, eight);
+    }
+    float dists[8], indexes[8];
+    _mm_storeu_ps(dists, bestDist[0]);
+    _mm_storeu_ps(dists + 4, bestDist[1]);
+    _mm_storeu_ps(indexes, bestIndex[0]);
+    _mm_storeu_ps(indexes + 4, bestIndex[1]);
+    return (int)indexes[gjk_pickBestLane_(dists, indexes, 8)];
+}
 
-      while (true) {
-        // obtain the feature (edge for 2D) closest to the 
+GJK_TARGET("avx") static int gjk_furthestPointSoa_avx(float *xs, float *ys, int paddedCount, gjk_v2 d) {
+    __m256 dx = _mm256_set1_ps(d.x);
+    __m256 dy = _mm256_set1_ps(d.y);
+    __m256 bestDist[2] = { _mm256_set1_ps(-INFINITY), _mm256_set1_ps(-INFINITY) };
+    __m256 bestIndex[2] = { _mm256_setzero_ps(), _mm256_setzero_ps() };
+    __m256 index0 = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256 index1 = _mm256_setr_ps(8, 9, 10, 11, 12, 13, 14, 15);
+    __m256 sixteen = _mm256_set1_ps(16);
+    int i = 0;
+    for(; i + 16 <= paddedCount; i += 16) {
+        __m256 dist0 = _mm256_add_ps(_mm256_mul_ps(_mm256_load_ps(xs + i), dx), _mm256_mul_ps(_mm256_load_ps(ys + i), dy));
+        __m256 dist1 = _mm256_add_ps(_mm256_mul_ps(_mm256_load_ps(xs + i + 8), dx), _mm256_mul_ps(_mm256_load_ps(ys + i + 8), dy));
+        GJK_ARGMAX_STEP_AVX(dist0, bestDist[0], bestIndex[0], index0);
+        GJK_ARGMAX_STEP_AVX(dist1, bestDist[1], bestIndex[1], index1);
+        index0 = _mm256_add_ps(index0, sixteen);
+        index1 = _mm256_add_ps(index1, sixteen);
+    }
+    if(i < paddedCount) {
+        //NOTE: one block of 8 left over
+        __m256 dist0 = _mm256_add_ps(_mm256_mul_ps(_mm256_load_ps(xs + i), dx), _mm256_mul_ps(_mm256_load_ps(ys + i), dy));
+        GJK_ARGMAX_STEP_AVX(dist0, bestDist[0], bestIndex[0], index0);
+    }
+    float dists[16], indexes[16];
+    _mm256_storeu_ps(dists, bestDist[0]);
+    _mm256_storeu_ps(dists + 8, bestDist[1]);
+    _mm256_storeu_ps(indexes, bestIndex[0]);
+    _mm256_storeu_ps(indexes + 8, bestIndex[1]);
+    return (int)indexes[gjk_pickBestLane_(dists, indexes, 16)];
+}
+#endif
+
+static int gjk_furthestPoint_(gjk_v2 *points, int count, gjk_v2 d) {
+#if GJK_X86
+    if(count >= GJK_SIMD_MIN_POINTS) {
+        Gjk_SimdLevel level = gjk_getSimdLevel();
+        if(level == GJK_SIMD_AVX && count >= GJK_AVX_MIN_POINTS) return gjk_furthestPoint_avx(points, count, d);
+        if(level >= GJK_SIMD_SSE2) return gjk_furthestPoint_sse2(points, count, d);
+    }
+#endif
+    return gjk_furthestPoint_scalar(points, count, d);
+}
+
+static int gjk_paddedCount_(int count) {
+    return (count + 7) & ~7;
+}
+
+static int gjk_furthestPointSoa_(Gjk_SoaPolygon *polygon, gjk_v2 d) {
+#if GJK_X86
+    if(polygon->count >= GJK_SIMD_MIN_POINTS) {
+        Gjk_SimdLevel level = gjk_getSimdLevel();
+        if(level == GJK_SIMD_AVX && polygon->count >= GJK_AVX_MIN_POINTS_SOA) return gjk_furthestPointSoa_avx(polygon->x, polygon->y, gjk_paddedCount_(polygon->count), d);
+        if(level >= GJK_SIMD_SSE2) return gjk_furthestPointSoa_sse2(polygon->x, polygon->y, gjk_paddedCount_(polygon->count), d);
+    }
+#endif
+    gjk_real maxDist = 0; //set in loop
+    int result = 0;
+    for(int i = 0; i < polygon->count; ++i) {
+        gjk_real dist = polygon->x[i]*d.x + polygon->y[i]*d.y;
+        if (dist > maxDist || i == 0) { //or first element
+            maxDist = dist;
+            result = i;
+        }
+    }
+    return result;
+}
+
+void gjk_initSoaPolygon(Gjk_SoaPolygon *polygon, gjk_v2 *points, int count) {
+    GJK_ASSERT(count > 0);
+    int padded = gjk_paddedCount_(count);
+    polygon->memory_ = EASY_HEADERS_ALLOC(2*padded*sizeof(gjk_real) + 31);
+    GJK_ASSERT(polygon->memory_);
+    polygon->x = (gjk_real *)(((size_t)polygon->memory_ + 31) & ~(size_t)31);
+    polygon->y = polygon->x + padded;
+    polygon->count = count;
+    for(int i = 0; i < padded; ++i) {
+        gjk_v2 p = points[(i < count) ? i : count - 1];
+        polygon->x[i] = p.x;
+        polygon->y[i] = p.y;
+    }
+}
+
+void gjk_freeSoaPolygon(Gjk_SoaPolygon *polygon) {
+    if(polygon->memory_) EASY_HEADERS_FREE(polygon->memory_);
+    memset(polygon, 0, sizeof(Gjk_SoaPolygon));
+}
+
+//NOTE: The polygon ones only fill in what polygons use. gjk_objectsCollide makes two of these every call, and zeroing 
+//the whole struct cost more than some of the tests.
+Gjk_Shape gjk_polygonShape(gjk_v2 *points, int count) {
+    Gjk_Shape result;
+    result.type = GJK_SHAPE_POLYGON;
+    result.points = points;
+    result.count = count;
+    result.soa = 0;
+    result.transformed = false;
+    return result;
+}
+
+Gjk_Shape gjk_soaPolygonShape(Gjk_SoaPolygon *polygon) {
+    Gjk_Shape result;
+    result.type = GJK_SHAPE_SOA_POLYGON;
+    result.points = 0;
+    result.soa = polygon;
+    result.count = polygon->count;
+    result.transformed = false;
+    return result;
+}
+
+Gjk_Transform gjk_transform(gjk_v2 position, gjk_real angle) {
+    Gjk_Transform result;
+    result.position = position;
+    result.cosAngle = gjk_cos(angle);
+    result.sinAngle = gjk_sin(angle);
+    return result;
+}
+
+void gjk_setShapeTransform(Gjk_Shape *shape, Gjk_Transform transform) {
+    shape->transformed = true;
+    shape->transform = transform;
+}
+
+Gjk_Shape gjk_localPolygonShape(gjk_v2 *points, int count, Gjk_Transform transform) {
+    Gjk_Shape result = gjk_polygonShape(points, count);
+    gjk_setShapeTransform(&result, transform);
+    return result;
+}
+
+Gjk_Shape gjk_circleShape(gjk_real radius, Gjk_Transform transform) {
+    Gjk_Shape result;
+    memset(&result, 0, sizeof(result));
+    result.type = GJK_SHAPE_CIRCLE;
+    result.radius = radius;
+    gjk_setShapeTransform(&result, transform);
+    return result;
+}
+
+Gjk_Shape gjk_capsuleShape(gjk_real halfLength, gjk_real radius, Gjk_Transform transform) {
+    Gjk_Shape result;
+    memset(&result, 0, sizeof(result));
+    result.type = GJK_SHAPE_CAPSULE;
+    result.halfLength = halfLength;
+    result.radius = radius;
+    gjk_setShapeTransform(&result, transform);
+    return result;
+}
+
+Gjk_Shape gjk_boxShape(gjk_v2 halfSize, Gjk_Transform transform) {
+    Gjk_Shape result;
+    memset(&result, 0, sizeof(result));
+    result.type = GJK_SHAPE_BOX;
+    result.halfSize = halfSize;
+    result.count = 4; //the corners, so the cache can remember them
+    gjk_setShapeTransform(&result, transform);
+    return result;
+}
+
+Gjk_Shape gjk_customShape(Gjk_SupportFunction *support, void *userData, Gjk_Transform transform) {
+    GJK_ASSERT(support);
+    Gjk_Shape result;
+    memset(&result, 0, sizeof(result));
+    result.type = GJK_SHAPE_CUSTOM;
+    result.support = support;
+    result.userData = userData;
+    gjk_setShapeTransform(&result, transform);
+    return result;
+}
+
+//NOTE: past this many steps the walk gives up and looks at every point instead, so a big turn never costs more than a scan
+#define GJK_HILL_CLIMB_MAX_STEPS 16
+
+static gjk_real gjk_maxAbs_(gjk_v2 a) {
+    gjk_real x = gjk_abs(a.x);
+    gjk_real y = gjk_abs(a.y);
+    return (x > y) ? x : y;
+}
+
+//NOTE: For a convex polygon the distance along d goes up to the furthest point and back down again as you go round, 
+//so from any point you can walk to a neighbour that's further until neither is. Works for points in either order.
+//x and y are every stride gjk_reals (2 for gjk_v2 arrays, 1 for soa). Returns -1 when it should scan instead.
+static int gjk_hillClimb_(gjk_real *xs, gjk_real *ys, int stride, int count, int start, gjk_v2 d) {
+    int i = start;
+    gjk_real best = xs[i*stride]*d.x + ys[i*stride]*d.y;
+    int next = (i + 1 == count) ? 0 : i + 1;
+    int prev = (i == 0) ? count - 1 : i - 1;
+    gjk_real nextDist = xs[next*stride]*d.x + ys[next*stride]*d.y;
+    gjk_real prevDist = xs[prev*stride]*d.x + ys[prev*stride]*d.y;
+
+    int step = 0;
+    gjk_real startDist = best;
+    gjk_real otherDist = 0;
+    if(nextDist > best && nextDist >= prevDist) {
+        step = 1;
+        i = next;
+        best = nextDist;
+        otherDist = prevDist;
+    } else if(prevDist > best) {
+        step = -1;
+        i = prev;
+        best = prevDist;
+        otherDist = nextDist;
+    } else if(nextDist == best && prevDist == best) {
+        //NOTE: in the middle of a flat run, which could be the nearest edge rather than the furthest
+        return -1;
+    } else {
+        return i;
+    }
+    //NOTE: same again when nearly in a line. Rounding can make one neighbour look a hair further along the nearest edge, 
+    //and the walk would stop at its other end.
+    gjk_real tolerance = GJK_RELATIVE_EPSILON*gjk_maxAbs_(d)*gjk_maxAbs_(gjk_V2(xs[start*stride], ys[start*stride]));
+    if(best - startDist <= tolerance && otherDist >= startDist - tolerance) {
+        return -1;
+    }
+
+    for(int steps = 0; steps < GJK_HILL_CLIMB_MAX_STEPS; ++steps) {
+        int j = i + step;
+        if(j == count) j = 0;
+        if(j < 0) j = count - 1;
+        gjk_real dist = xs[j*stride]*d.x + ys[j*stride]*d.y;
+        if(dist > best) {
+            i = j;
+            best = dist;
+        } else {
+            return i;
+        }
+    }
+    return -1;
+}
+
+//NOTE: box corners go round anticlockwise from (-x, -y) so the hill climb and the cache can use them like a polygon's points
+static gjk_v2 gjk_boxCorner_(gjk_v2 halfSize, int index) {
+    gjk_v2 result = gjk_V2((index == 1 || index == 2) ? halfSize.x : -halfSize.x, (index >= 2) ? halfSize.y : -halfSize.y);
+    return result;
+}
+
+static gjk_v2 gjk_toWorld_(Gjk_Transform *transform, gjk_v2 p) {
+    gjk_v2 result = gjk_V2(transform->cosAngle*p.x - transform->sinAngle*p.y + transform->position.x, 
+                           transform->sinAngle*p.x + transform->cosAngle*p.y + transform->position.y);
+    return result;
+}
+
+//NOTE: the inverse rotation, which is all a direction needs
+static gjk_v2 gjk_directionToLocal_(Gjk_Transform *transform, gjk_v2 d) {
+    gjk_v2 result = gjk_V2(transform->cosAngle*d.x + transform->sinAngle*d.y, -transform->sinAngle*d.x + transform->cosAngle*d.y);
+    return result;
+}
+
+//NOTE: radius along d, or nothing if d is zero
+static gjk_v2 gjk_roundOut_(gjk_v2 p, gjk_v2 d, gjk_real radius) {
+    gjk_real length = gjk_sqrt(d.x*d.x + d.y*d.y);
+    if(length > 0) {
+        gjk_real scale = radius / length;
+        p.x += d.x*scale;
+        p.y += d.y*scale;
+    }
+    return p;
+}
+
+//NOTE: the shapes without a list of points. Kept out of line, otherwise the polygon path pays for their registers and stack on every call.
+static GJK_NOINLINE gjk_v2 gjk_implicitSupport_(Gjk_Shape *shape, gjk_v2 d, int *found) {
+    gjk_v2 result = gjk_V2(0, 0);
+    *found = -1;
+    switch(shape->type) {
+        case GJK_SHAPE_CIRCLE: {
+            result = gjk_roundOut_(gjk_V2(0, 0), d, shape->radius);
+        } break;
+        case GJK_SHAPE_CAPSULE: {
+            result = gjk_roundOut_(gjk_V2((d.x >= 0) ? shape->halfLength : -shape->halfLength, 0), d, shape->radius);
+        } break;
+        case GJK_SHAPE_BOX: {
+            //NOTE: ties go to the lower index like the polygon scan
+            if(d.y > 0) {
+                *found = (d.x > 0) ? 2 : 3;
+            } else {
+                *found = (d.x > 0) ? 1 : 0;
+            }
+            result = gjk_boxCorner_(shape->halfSize, *found);
+        } break;
+        case GJK_SHAPE_CUSTOM: {
+            result = shape->support(shape->userData, d);
+        } break;
+        default: {
+            GJK_ASSERT(!"invalid code path");
+        }
+    }
+    return result;
+}
+
+//NOTE: the point of the shape furthest along d, ignoring its transform. index can be null. If it isn't, and is a point of the shape, 
+//we walk from there instead of looking at every point, and it gets the index of the point we found (-1 for shapes without points).
+static gjk_v2 gjk_localSupport_(Gjk_Shape *shape, gjk_v2 d, int *index) {
+    gjk_v2 result = gjk_V2(0, 0);
+    int start = (index && *index >= 0 && *index < shape->count) ? *index : -1;
+    int found = -1;
+    switch(shape->type) {
+        case GJK_SHAPE_POLYGON: {
+            if(start >= 0) found = gjk_hillClimb_(&shape->points[0].x, &shape->points[0].y, 2, shape->count, start, d);
+            if(found < 0) found = gjk_furthestPoint_(shape->points, shape->count, d);
+            result = shape->points[found];
+        } break;
+        case GJK_SHAPE_SOA_POLYGON: {
+            if(start >= 0) found = gjk_hillClimb_(shape->soa->x, shape->soa->y, 1, shape->count, start, d);
+            if(found < 0) found = gjk_furthestPointSoa_(shape->soa, d);
+            result = gjk_V2(shape->soa->x[found], shape->soa->y[found]);
+        } break;
+        default: {
+            result = gjk_implicitSupport_(shape, d, &found);
+        }
+    }
+    if(index) *index = found;
+    return result;
+}
+
+static GJK_NOINLINE gjk_v2 gjk_transformedSupport_(Gjk_Shape *shape, gjk_v2 d, int *index) {
+    gjk_v2 result = gjk_localSupport_(shape, gjk_directionToLocal_(&shape->transform, d), index);
+    result = gjk_toWorld_(&shape->transform, result);
+    return result;
+}
+
+//NOTE: the same as gjk_localSupport_ but in world space. Transformed shapes go off to their own function so 
+//world space polygons, the common case, don't pay for it.
+static gjk_v2 gjk_shapeSupport_(Gjk_Shape *shape, gjk_v2 d, int *index) {
+    if(shape->transformed) return gjk_transformedSupport_(shape, d, index);
+    return gjk_localSupport_(shape, d, index);
+}
+
+static gjk_v2 gjk_shapePoint_(Gjk_Shape *shape, int index) {
+    gjk_v2 result = gjk_V2(0, 0);
+    switch(shape->type) {
+        case GJK_SHAPE_POLYGON: {
+            result = shape->points[index];
+        } break;
+        case GJK_SHAPE_SOA_POLYGON: {
+            result = gjk_V2(shape->soa->x[index], shape->soa->y[index]);
+        } break;
+        case GJK_SHAPE_BOX: {
+            result = gjk_boxCorner_(shape->halfSize, index);
+        } break;
+        default: {
+            GJK_ASSERT(!"invalid code path");
+        }
+    }
+    if(shape->transformed) result = gjk_toWorld_(&shape->transform, result);
+    return result;
+}
+
+//NOTE: polygons need at least 3 points to have an inside. The others always do.
+static bool gjk_shapeIsEmpty_(Gjk_Shape *shape) {
+    bool result = (shape->type == GJK_SHAPE_POLYGON || shape->type == GJK_SHAPE_SOA_POLYGON) && shape->count < 3;
+    return result;
+}
+
+//NOTE: where the walk starts on each shape, null to always look at every point
+typedef struct {
+    int a, b;
+} Gjk_SupportHint_;
+
+static gjk_v2 gjk_supportShapes_(gjk_v2 d, Gjk_Shape *a, Gjk_Shape *b, Gjk_SupportHint_ *hint) {
+    gjk_v2 maxA = gjk_shapeSupport_(a, d, hint ? &hint->a : 0);
+    gjk_v2 maxB = gjk_shapeSupport_(b, gjk_V2(-d.x, -d.y), hint ? &hint->b : 0);
+    gjk_v2 result = gjk_V2(maxA.x - maxB.x, maxA.y - maxB.y); //do our Minksowski difference (can decompose the function based on Caesy's video)
+    return result;
+}
+
+gjk_v2 gjk_support(gjk_v2 d, gjk_v2 *a, int aCount, gjk_v2 *b, int bCount) {
+    gjk_v2 maxA = a[gjk_furthestPoint_(a, aCount, d)];
+    gjk_v2 maxB = b[gjk_furthestPoint_(b, bCount, gjk_V2(-d.x, -d.y))];
+
+    gjk_v2 result = gjk_V2(maxA.x - maxB.x, maxA.y - maxB.y); //do our Minksowski difference (can decompose the function based on Caesy's video)
+    return result;
+}
+
+static bool gjk_doSimplex_(Gjk_Simplex *simplex, gjk_v2 *d) { //update both of these
+  bool result = false;
+  switch(simplex->count) {
+      case 1: {
+          GJK_ASSERT(!"Shouldn't ever be one point");
+      } break;
+      case 2: { //line
+          gjk_v2 a = simplex->p[1];
+          gjk_v2 b = simplex->p[0];
+          gjk_v2 ao = gjk_V2(-a.x, -a.y);
+          gjk_v2 ab = gjk_V2(b.x - a.x, b.y - a.y);
+          if(gjk_dot(ab, ao) > 0) {  //is inside the line boundary
+              //don't have to update simplex
+              gjk_v2 dir = gjk_perp2D(ab);
+              if(gjk_dot(dir, ao) < 0) { //pointing the wrong direction 
+                  dir = gjk_negate_v2(dir); //negate vector to point in right direction
+                  GJK_ASSERT(gjk_dot(dir, ao) >= 0);
+                  //make the winding clockwise
+                  simplex->p[0] = a;
+                  simplex->p[1] = b;
+              } 
+              *d = dir;
+          } else {
+              simplex->p[0] = a;
+              simplex->count = 1;
+              *d = ao;
+          }
+      } break;
+      case 3: { //triangle
+        gjk_v2 a = simplex->p[2];
+        gjk_v2 b = simplex->p[1];
+        gjk_v2 c = simplex->p[0];
+        gjk_v2 ao = gjk_V2(-a.x, -a.y);
+        gjk_v2 ab = gjk_V2(b.x - a.x, b.y - a.y);
+        gjk_v2 ac = gjk_V2(c.x - a.x, c.y - a.y);
+        //make sure there is consistent winding (clockwise)
+        if(gjk_dot(gjk_perp2D(ac), ab) > 0) { 
+            //NOTE: the 'line' case leaves it clockwise, so this is only when rounding has made the triangle almost flat
+            b = simplex->p[0];
+            c = simplex->p[1];
+            gjk_v2 temp = ab;
+            ab = ac;
+            ac = temp;
+        }
+        /////
+        gjk_v2 perpAc = gjk_perp2D(ac);
+        bool onLeft = (gjk_dot(perpAc, ao) > 0);
+        
+        gjk_v2 perpAb = gjk_negate_v2(gjk_perp2D(ab));
+        bool onRight = (gjk_dot(perpAb, ao) > 0);
+        
+        //NOTE: the origin can be outside both edges past a when the triangle is almost flat, so don't count on only one being set
+        if(!onLeft && !onRight) {
+          result = true;
+          break;
+        } else if(onLeft && gjk_dot(ac, ao) > 0) {
+          *d = perpAc;
+          simplex->p[0] = c;
+          simplex->p[1] = a;
+          simplex->count = 2;
+        } else if(onRight && gjk_dot(ab, ao) > 0) {
+          *d = perpAb;
+          simplex->p[1] = b;
+          simplex->p[0] = a;
+          simplex->count = 2;
+        } else {
+          simplex->p[0] = a;
+          simplex->count = 1;
+          *d = ao;
+        }
+        } break;
+        default: {
+          GJK_ASSERT(!"invalid code path");
+        }
+      }
+  return result;
+}
+
+static gjk_real gjk_cross2D_(gjk_v2 a, gjk_v2 b) {
+    return a.x*b.y - a.y*b.x;
+}
+
+//NOTE: true if the origin is strictly inside the triangle, and if it is winds it the way gjk_doSimplex_ leaves it (clockwise), which EPA needs.
+//flipped is set if p[0] and p[1] were swapped to do that.
+static bool gjk_triangleHoldsOrigin_(Gjk_Simplex *simplex, bool *flipped) {
+    *flipped = false;
+    gjk_v2 p0 = simplex->p[0];
+    gjk_v2 p1 = simplex->p[1];
+    gjk_v2 p2 = simplex->p[2];
+    gjk_real area = gjk_cross2D_(gjk_V2(p1.x - p0.x, p1.y - p0.y), gjk_V2(p2.x - p0.x, p2.y - p0.y));
+    if(area == 0) return false;
+    gjk_real c0 = gjk_cross2D_(gjk_V2(p1.x - p0.x, p1.y - p0.y), gjk_negate_v2(p0));
+    gjk_real c1 = gjk_cross2D_(gjk_V2(p2.x - p1.x, p2.y - p1.y), gjk_negate_v2(p1));
+    gjk_real c2 = gjk_cross2D_(gjk_V2(p0.x - p2.x, p0.y - p2.y), gjk_negate_v2(p2));
+    bool inside = (area > 0) ? (c0 > 0 && c1 > 0 && c2 > 0) : (c0 < 0 && c1 < 0 && c2 < 0);
+    if(inside && area > 0) {
+        //NOTE: gjk_doSimplex_ has p[2] as a, p[1] as b and p[0] as c with ab x ac >= 0
+        simplex->p[0] = p1;
+        simplex->p[1] = p0;
+        *flipped = true;
+    }
+    return inside;
+}
+
+//NOTE: the support points found in this test, so we can tell which points of each shape made the final triangle
+#define GJK_SEEN_POINTS 16
+typedef struct {
+    gjk_v2 p[GJK_SEEN_POINTS];
+    int a[GJK_SEEN_POINTS];
+    int b[GJK_SEEN_POINTS];
+    int count;
+} Gjk_SeenPoints_;
+
+static void gjk_addSeenPoint_(Gjk_SeenPoints_ *seen, gjk_v2 p, Gjk_SupportHint_ *hint) {
+    int at = seen->count++ % GJK_SEEN_POINTS;
+    seen->p[at] = p;
+    seen->a[at] = hint->a;
+    seen->b[at] = hint->b;
+}
+
+static void gjk_saveSimplexToCache_(Gjk_PairCache *cache, Gjk_Simplex *simplex, Gjk_SeenPoints_ *seen) {
+    cache->simplexCount = 0;
+    int seenCount = (seen->count < GJK_SEEN_POINTS) ? seen->count : GJK_SEEN_POINTS;
+    for(int k = 0; k < 3; ++k) {
+        int match = -1;
+        for(int i = 0; i < seenCount; ++i) {
+            if(seen->p[i].x == simplex->p[k].x && seen->p[i].y == simplex->p[k].y) { match = i; break; }
+        }
+        if(match < 0) return;
+        cache->simplexA[k] = seen->a[match];
+        cache->simplexB[k] = seen->b[match];
+    }
+    cache->simplexCount = 3;
+}
+
+//NOTE: cache can be null. 
+//IMPORTANT: The triangle from last frame proves they overlap, but its points can end up inside the shape's difference rather than on 
+//its edge once they've moved, and EPA's polygon goes concave if it starts from those. So forEPA skips it.
+//NOTE: Fills in simplex rather than returning a Gjk_Info, the simplex is big enough that copying it around costs more than the cached test.
+static Gjk_Result gjk_shapesCollideWithCache_(Gjk_Shape *a, Gjk_Shape *b, Gjk_PairCache *cache, bool forEPA, Gjk_Simplex *simplex) {
+  Gjk_Result result = GJK_SEPARATED;
+  simplex->count = 0;
+  if(gjk_shapeIsEmpty_(a) || gjk_shapeIsEmpty_(b)) return GJK_SEPARATED; //early out if not a full shape
+
+  Gjk_SupportHint_ hintStorage;
+  memset(&hintStorage, 0, sizeof(hintStorage));
+  Gjk_SupportHint_ *hint = 0;
+  Gjk_SeenPoints_ seen;
+  seen.count = 0;
+  gjk_v2 firstDirection = gjk_V2(1, 0);
+  if(cache) {
+    hint = &hintStorage;
+    hint->a = cache->supportA;
+    hint->b = cache->supportB;
+
+    if(cache->simplexCount == 3 && !forEPA) {
+      //NOTE: last frame's triangle, made from the same points where they are now
+      bool indexesOk = true;
+      for(int k = 0; k < 3; ++k) {
+        int ia = cache->simplexA[k];
+        int ib = cache->simplexB[k];
+        if(ia < 0 || ia >= a->count || ib < 0 || ib >= b->count) { indexesOk = false; break; }
+        gjk_v2 pa = gjk_shapePoint_(a, ia);
+        gjk_v2 pb = gjk_shapePoint_(b, ib);
+        gjk_addPoint_(simplex, gjk_V2(pa.x - pb.x, pa.y - pb.y));
+      }
+      bool flipped = false;
+      if(indexesOk && gjk_triangleHoldsOrigin_(simplex, &flipped)) {
+        if(flipped) {
+          int temp = cache->simplexA[0]; cache->simplexA[0] = cache->simplexA[1]; cache->simplexA[1] = temp;
+          temp = cache->simplexB[0]; cache->simplexB[0] = cache->simplexB[1]; cache->simplexB[1] = temp;
+        }
+        return GJK_OVERLAPPING;
+      }
+      simplex->count = 0;
+    }
+
+    if(cache->direction.x != 0 || cache->direction.y != 0) {
+      firstDirection = cache->direction;
+    }
+  }
+
+  gjk_v2 s = gjk_supportShapes_(firstDirection, a, b, hint);
+  if(hint) gjk_addSeenPoint_(&seen, s, hint);
+  simplex->p[0] = s;
+  simplex->count = 1;
+  gjk_v2 d = gjk_V2(-s.x, -s.y);
+  if(cache && gjk_dot(s, firstDirection) < 0) {
+    //NOTE: the furthest point along last frame's separating direction is still behind the origin, so they're still apart
+    d = firstDirection;
+  } else {
+    //NOTE: the tolerance grows with the points so it means the same for big and small shapes
+    gjk_real scale = gjk_maxAbs_(s);
+    for(int iteration = 0; ; ++iteration) {
+      gjk_real epsilon = GJK_RELATIVE_EPSILON*scale;
+      gjk_real dLengthSqr = gjk_dot(d, d);
+      if(dLengthSqr <= epsilon*epsilon) {
+        //NOTE: the origin is on the simplex's point. It's a point of the difference found by pushing out towards the 
+        //origin, so the origin is on the difference's edge.
+        result = GJK_TOUCHING;
+        break;
+      }
+      if(iteration == GJK_MAX_ITERATIONS) {
+        result = GJK_TOUCHING;
+        break;
+      }
+      gjk_v2 p = gjk_supportShapes_(d, a, b, hint);
+      gjk_real pDist = gjk_dot(p, d);
+      if(pDist < 0) {
+        result = GJK_SEPARATED;
+        break;
+      }
+      //NOTE: how much further along d p is than the simplex. If it's no further the simplex is already on the difference's 
+      //edge, and since p got past the origin the origin is within epsilon of it. Without this they go back and forth 
+      //between the same two points forever when the origin is right on the edge.
+      gjk_real progress = pDist - gjk_dot(simplex->p[simplex->count - 1], d);
+      bool repeated = false;
+      for(int i = 0; i < simplex->count; ++i) {
+        if(simplex->p[i].x == p.x && simplex->p[i].y == p.y) repeated = true;
+      }
+      if(repeated || progress <= 0 || progress*progress <= epsilon*epsilon*dLengthSqr) {
+        result = GJK_TOUCHING;
+        break;
+      }
+      gjk_real pScale = gjk_maxAbs_(p);
+      if(pScale > scale) scale = pScale;
+
+      if(hint) gjk_addSeenPoint_(&seen, p, hint);
+      gjk_addPoint_(simplex, p);
+      GJK_ASSERT(simplex->count >= 2 && simplex->count <= 3); //make sure we haven't gone over
+      if(gjk_doSimplex_(simplex, &d)) {
+        result = GJK_OVERLAPPING;
+        break;
+      }
+    }
+  }
+  
+  if(cache) {
+    cache->supportA = hint->a;
+    cache->supportB = hint->b;
+    cache->simplexCount = 0;
+    cache->direction = gjk_V2(0, 0);
+    if(result == GJK_OVERLAPPING) {
+      gjk_saveSimplexToCache_(cache, simplex, &seen);
+    } else {
+      cache->direction = d;
+    }
+  }
+
+  return result;
+}
+
+static Gjk_Info gjk_shapesCollide_(Gjk_Shape *a, Gjk_Shape *b) {
+  Gjk_Info info;
+  info.collided = (gjk_shapesCollideWithCache_(a, b, 0, false, &info.simplex) == GJK_OVERLAPPING);
+  return info;
+}
+
+static void gjk_initEpaPolytope_(Gjk_EpaPolytope_ *polytope) {
+  polytope->edges = polytope->inlineEdges;
+  polytope->count = 0;
+  polytope->capacity = GJK_EPA_INLINE_EDGES;
+}
+
+static void gjk_freeEpaPolytope_(Gjk_EpaPolytope_ *polytope) {
+  if(polytope->edges != polytope->inlineEdges) {
+    EASY_HEADERS_FREE(polytope->edges);
+  }
+  polytope->edges = polytope->inlineEdges;
+  polytope->count = 0;
+  polytope->capacity = GJK_EPA_INLINE_EDGES;
+}
+
+//NOTE: sign is +1 if the polygon goes clockwise and -1 if it goes anticlockwise, so the normal ends up pointing away from the origin. 
+//Returns false if a and b are the same point.
+static bool gjk_pushEpaEdge_(Gjk_EpaPolytope_ *polytope, gjk_v2 a, gjk_v2 b, gjk_real sign) {
+  gjk_v2 ab = gjk_V2(b.x - a.x, b.y - a.y);
+  gjk_real length = gjk_sqrt(ab.x*ab.x + ab.y*ab.y);
+  if(length == 0) return false;
+
+  Gjk_EpaEdge_ edge;
+  edge.a = a;
+  edge.b = b;
+  edge.normal = gjk_V2(-sign*ab.y/length, sign*ab.x/length);
+  edge.distance = gjk_dot(edge.normal, a);
+  //NOTE: the origin can sit on an edge (just touching), or round a hair past it
+  if(edge.distance < 0) edge.distance = 0;
+
+  if(polytope->count == polytope->capacity) {
+    int newCapacity = polytope->capacity*2;
+    Gjk_EpaEdge_ *edges = (Gjk_EpaEdge_ *)EASY_HEADERS_ALLOC(newCapacity*sizeof(Gjk_EpaEdge_));
+    GJK_ASSERT(edges);
+    memcpy(edges, polytope->edges, polytope->count*sizeof(Gjk_EpaEdge_));
+    if(polytope->edges != polytope->inlineEdges) {
+      EASY_HEADERS_FREE(polytope->edges);
+    }
+    polytope->edges = edges;
+    polytope->capacity = newCapacity;
+  }
+
+  //sift up
+  int at = polytope->count++;
+  while(at > 0) {
+    int parent = (at - 1) / 2;
+    if(polytope->edges[parent].distance <= edge.distance) break;
+    polytope->edges[at] = polytope->edges[parent];
+    at = parent;
+  }
+  polytope->edges[at] = edge;
+  return true;
+}
+
+static Gjk_EpaEdge_ gjk_popClosestEpaEdge_(Gjk_EpaPolytope_ *polytope) {
+  GJK_ASSERT(polytope->count > 0);
+  Gjk_EpaEdge_ result = polytope->edges[0];
+  Gjk_EpaEdge_ last = polytope->edges[--polytope->count];
+  int count = polytope->count;
+
+  //sift down
+  int at = 0;
+  while(true) {
+    int child = 2*at + 1;
+    if(child >= count) break;
+    if(child + 1 < count && polytope->edges[child + 1].distance < polytope->edges[child].distance) child++;
+    if(last.distance <= polytope->edges[child].distance) break;
+    polytope->edges[at] = polytope->edges[child];
+    at = child;
+  }
+  if(count > 0) polytope->edges[at] = last;
+  return result;
+}
+
+#ifndef GJK_EPA_SEPARATION
+//NOTE: Added to the distance Gjk_EPA_Info gives back, so moving by it leaves them just apart rather than just touching. 
+//Contact manifolds give the real depth.
+#define GJK_EPA_SEPARATION 0.001f
+#endif
+
+//NOTE: cache and scratch can be null. A scratch polytope keeps its memory between calls, so a thread that does lots of these doesn't allocate. 
+//The distance is the real depth, without GJK_EPA_SEPARATION.
+static Gjk_EPA_Info gjk_epa_(Gjk_Shape *a, Gjk_Shape *b, Gjk_PairCache *cache, Gjk_EpaPolytope_ *scratch) {
+    Gjk_EPA_Info result;
+    memset(&result, 0, sizeof(result));
+    Gjk_Simplex simplex;
+    result.collided = (gjk_shapesCollideWithCache_(a, b, cache, true, &simplex) == GJK_OVERLAPPING);
+    Gjk_SupportHint_ hintStorage;
+    memset(&hintStorage, 0, sizeof(hintStorage));
+    Gjk_SupportHint_ *hint = 0;
+    if(cache) {
+      hint = &hintStorage;
+      hint->a = cache->supportA;
+      hint->b = cache->supportB;
+    }
+    if(result.collided) { //if there is a collision, find the penetration vector to resolve the collision
+      GJK_ASSERT(simplex.count == 3);
+      gjk_v2 p0 = simplex.p[0];
+      gjk_v2 p1 = simplex.p[1];
+      gjk_v2 p2 = simplex.p[2];
+      //NOTE: gjk_doSimplex_ leaves it clockwise, but work it out rather than rely on it
+      gjk_real area = (p1.x - p0.x)*(p2.y - p0.y) - (p1.y - p0.y)*(p2.x - p0.x);
+      gjk_real sign = (area <= 0) ? 1.0f : -1.0f;
+      //NOTE: how close a new point has to be to the edge to call it the edge of the difference. Relative to the size like GJK's, 
+      //but a quarter of it, which is about what the fixed 0.00001 it used to be was for shapes a couple of units across.
+      gjk_real scale = gjk_maxAbs_(p0);
+      if(gjk_maxAbs_(p1) > scale) scale = gjk_maxAbs_(p1);
+      if(gjk_maxAbs_(p2) > scale) scale = gjk_maxAbs_(p2);
+      gjk_real tolerance = 0.25f*GJK_RELATIVE_EPSILON*scale;
+
+      Gjk_EpaPolytope_ localPolytope;
+      Gjk_EpaPolytope_ *polytope = scratch;
+      if(!polytope) {
+        polytope = &localPolytope;
+        gjk_initEpaPolytope_(polytope);
+      }
+      polytope->count = 0;
+      gjk_pushEpaEdge_(polytope, p0, p1, sign);
+      gjk_pushEpaEdge_(polytope, p1, p2, sign);
+      gjk_pushEpaEdge_(polytope, p2, p0, sign);
+      GJK_ASSERT(polytope->count > 0);
+
+      for(int iteration = 0; ; ++iteration) {
+        // obtain the feature (edge for 2D) closest to the 
         // origin on the Minkowski Difference
-        EPA_Edge e = GJK_EPA_findClosestEdge(&info.simplex);
+        Gjk_EpaEdge_ e = gjk_popClosestEpaEdge_(polytope);
+        result.normal = gjk_V2(-e.normal.x, -e.normal.y); //we negate it so it it pointing in the direction of the origin.  Since we want to move the minkwoski sum off the origin (because that's where there is a collision), we want it facing the direction we want to move!
+        result.distance = e.distance;
+
+        if(iteration == GJK_EPA_MAX_ITERATIONS) {
+          //NOTE: give back the closest edge we have. It's a lower bound on how far in they are.
+          break;
+        }
+
         // obtain a new support point in the direction of the edge normal (which is pointing away from the origin!)
-        gjk_v2 p = gjk_support(e.normal, a, aCount, b, bCount); 
+        gjk_v2 p = gjk_supportShapes_(e.normal, a, b, hint); 
         // check the distance from the origin to the edge against the
         // distance p is along e.normal
-        double d = gjk_dot(p, e.normal);
-        if (d - e.distance < GJK_TOLERANCE) { //See if the points in the edges direction are the same as the ones we already have. If so we know it is an edge face of the minkowski convex hull 
+        gjk_real d = gjk_dot(p, e.normal);
+        if (d - e.distance < tolerance) { //See if the points in the edges direction are the same as the ones we already have. If so we know it is an edge face of the minkowski convex hull 
           //found the solution
-          result.normal = gjk_V2(-e.normal.x, -e.normal.y); //we negate it so it it pointing in the direction of the origin.  Since we want to move the minkwoski sum off the origin (because that's where there is a collision), we want it facing the direction we want to move!
-          result.distance = d + 0.001; //Epsilon to make sure we aren't colliding anymore. Doens't seem like it is really neccessary thought. 
+          result.distance = d;
+          break;
+        }
+        // we haven't reached the edge of the Minkowski Difference
+        // so continue expanding by splitting the closest edge at the new point
+        bool addedA = gjk_pushEpaEdge_(polytope, e.a, p, sign);
+        bool addedB = gjk_pushEpaEdge_(polytope, p, e.b, sign);
+        if(!addedA || !addedB) {
+          //NOTE: p is one of the edge's own points, so this edge is on the hull after all
+          result.distance = d;
           break;
+        }
+      }
+      if(polytope == &localPolytope) {
+        gjk_freeEpaPolytope_(polytope);
+      }
+    }
+
+    return result;
+}
+
+static Gjk_EPA_Info gjk_shapesCollide_withEPAWithCache_(Gjk_Shape *a, Gjk_Shape *b, Gjk_PairCache *cache, Gjk_EpaPolytope_ *scratch) {
+    Gjk_EPA_Info result = gjk_epa_(a, b, cache, scratch);
+    if(result.collided) result.distance += GJK_EPA_SEPARATION; //to make sure we aren't colliding anymore
+    return result;
+}
+
+Gjk_EPA_Info gjk_shapesCollide_withEPA(Gjk_Shape *a, Gjk_Shape *b) {
+  return gjk_shapesCollide_withEPAWithCache_(a, b, 0, 0);
+}
+
+Gjk_EPA_Info gjk_shapesCollide_withEPA_cached(Gjk_Shape *a, Gjk_Shape *b, Gjk_PairCache *cache) {
+  GJK_ASSERT(cache);
+  return gjk_shapesCollide_withEPAWithCache_(a, b, cache, 0);
+}
+
+bool gjk_shapesCollide(Gjk_Shape *a, Gjk_Shape *b) {
+  Gjk_Simplex simplex;
+  return gjk_shapesCollideWithCache_(a, b, 0, false, &simplex) == GJK_OVERLAPPING;
+}
+
+bool gjk_shapesCollide_cached(Gjk_Shape *a, Gjk_Shape *b, Gjk_PairCache *cache) {
+  GJK_ASSERT(cache);
+  Gjk_Simplex simplex;
+  return gjk_shapesCollideWithCache_(a, b, cache, false, &simplex) == GJK_OVERLAPPING;
+}
+
+Gjk_Result gjk_shapesTest(Gjk_Shape *a, Gjk_Shape *b) {
+  Gjk_Simplex simplex;
+  return gjk_shapesCollideWithCache_(a, b, 0, false, &simplex);
+}
+
+Gjk_Result gjk_shapesTest_cached(Gjk_Shape *a, Gjk_Shape *b, Gjk_PairCache *cache) {
+  GJK_ASSERT(cache);
+  Gjk_Simplex simplex;
+  return gjk_shapesCollideWithCache_(a, b, cache, false, &simplex);
+}
+
+Gjk_Result gjk_objectsTest(gjk_v2 *a, int aCount, gjk_v2 *b, int bCount) {
+  Gjk_Shape shapeA = gjk_polygonShape(a, aCount);
+  Gjk_Shape shapeB = gjk_polygonShape(b, bCount);
+  return gjk_shapesTest(&shapeA, &shapeB);
+}
+
+bool gjk_objectsCollide_cached(gjk_v2 *a, int aCount, gjk_v2 *b, int bCount, Gjk_PairCache *cache) {
+  Gjk_Shape shapeA = gjk_polygonShape(a, aCount);
+  Gjk_Shape shapeB = gjk_polygonShape(b, bCount);
+  return gjk_shapesCollide_cached(&shapeA, &shapeB, cache);
+}
+
+Gjk_EPA_Info gjk_objectsCollide_withEPA_cached(gjk_v2 *a, int aCount, gjk_v2 *b, int bCount, Gjk_PairCache *cache) {
+  Gjk_Shape shapeA = gjk_polygonShape(a, aCount);
+  Gjk_Shape shapeB = gjk_polygonShape(b, bCount);
+  return gjk_shapesCollide_withEPA_cached(&shapeA, &shapeB, cache);
+}
+
+static Gjk_Info gjk_objectsCollide_(gjk_v2 *a, int aCount, gjk_v2 *b, int bCount) {
+  Gjk_Shape shapeA = gjk_polygonShape(a, aCount);
+  Gjk_Shape shapeB = gjk_polygonShape(b, bCount);
+  return gjk_shapesCollide_(&shapeA, &shapeB);
+}
+
+Gjk_EPA_Info gjk_objectsCollide_withEPA(gjk_v2 *a, int aCount, gjk_v2 *b, int bCount) {
+  Gjk_Shape shapeA = gjk_polygonShape(a, aCount);
+  Gjk_Shape shapeB = gjk_polygonShape(b, bCount);
+  return gjk_shapesCollide_withEPA(&shapeA, &shapeB);
+}
+
+//////////////////////////////////////////////// Contact manifolds ////////////////////////////////////////////////
+
+//NOTE: the part of a shape that faces a direction. Either an edge from v1 to v2 or just v1, with the shape's radius round it.
+typedef struct {
+  bool isEdge;
+  gjk_v2 v1;
+  gjk_v2 v2;
+  int index1; //-1 if the shape doesn't have points
+  int index2;
+  gjk_real radius;
+} Gjk_Feature_;
+
+#define GJK_FEATURE_INDEX_MASK 0x7FFF
+
+static gjk_v2 gjk_normalizeOrZero_(gjk_v2 v) {
+  gjk_real length = gjk_sqrt(v.x*v.x + v.y*v.y);
+  gjk_v2 result = gjk_V2(0, 0);
+  if(length > 0) result = gjk_V2(v.x / length, v.y / length);
+  return result;
+}
+
+//NOTE: whether c is further along the same line as a to b, within GJK_RELATIVE_EPSILON of its direction
+static bool gjk_carriesOn_(gjk_v2 a, gjk_v2 b, gjk_v2 c) {
+  gjk_v2 ab = gjk_V2(b.x - a.x, b.y - a.y);
+  gjk_v2 bc = gjk_V2(c.x - b.x, c.y - b.y);
+  gjk_real cross = gjk_cross2D_(ab, bc);
+  return gjk_dot(ab, bc) > 0 && cross*cross <= GJK_RELATIVE_EPSILON*GJK_RELATIVE_EPSILON*gjk_dot(ab, ab)*gjk_dot(bc, bc);
+}
+
+static Gjk_Feature_ gjk_bestFeature_(Gjk_Shape *shape, gjk_v2 n) {
+  Gjk_Feature_ result;
+  memset(&result, 0, sizeof(result));
+  result.index1 = -1;
+  result.index2 = -1;
+  switch(shape->type) {
+    case GJK_SHAPE_POLYGON:
+    case GJK_SHAPE_SOA_POLYGON:
+    case GJK_SHAPE_BOX: {
+      int i = -1;
+      gjk_v2 v = gjk_shapeSupport_(shape, n, &i);
+      int count = shape->count;
+      int prevIndex = (i == 0) ? count - 1 : i - 1;
+      int nextIndex = (i + 1 == count) ? 0 : i + 1;
+      gjk_v2 prev = gjk_shapePoint_(shape, prevIndex);
+      gjk_v2 next = gjk_shapePoint_(shape, nextIndex);
+      //NOTE: of the two edges at the furthest point, the one that's more side on to n
+      gjk_v2 toV = gjk_normalizeOrZero_(gjk_V2(v.x - prev.x, v.y - prev.y));
+      gjk_v2 toNext = gjk_normalizeOrZero_(gjk_V2(next.x - v.x, next.y - v.y));
+      result.isEdge = true;
+      if(gjk_abs(gjk_dot(toV, n)) <= gjk_abs(gjk_dot(toNext, n))) {
+        result.v1 = prev; result.index1 = prevIndex;
+        result.v2 = v; result.index2 = i;
+      } else {
+        result.v1 = v; result.index1 = i;
+        result.v2 = next; result.index2 = nextIndex;
+      }
+      //NOTE: Rounding can keep points in the middle of a flat side, which splits it into edges. The side is all of them, 
+      //clipping against just the one can miss where they really touch.
+      for(int sideCount = 2; sideCount < count; ++sideCount) {
+        int after = (result.index2 + 1 == count) ? 0 : result.index2 + 1;
+        int before = (result.index1 == 0) ? count - 1 : result.index1 - 1;
+        gjk_v2 afterPoint = gjk_shapePoint_(shape, after);
+        gjk_v2 beforePoint = gjk_shapePoint_(shape, before);
+        if(gjk_carriesOn_(result.v1, result.v2, afterPoint)) {
+          result.v2 = afterPoint; result.index2 = after;
+        } else if(gjk_carriesOn_(beforePoint, result.v1, result.v2)) {
+          result.v1 = beforePoint; result.index1 = before;
         } else {
-          // we haven't reached the edge of the Minkowski Difference
-          // so continue expanding by adding the new point to the simplex
-          // in between the points that made the closest edge
-          gjk_addPointAt(&info.simplex, p, e.index);
+          break;
         }
       }
+      if(result.v1.x == result.v2.x && result.v1.y == result.v2.y) {
+        result.isEdge = false;
+        result.v1 = v;
+        result.index1 = i;
+      }
+    } break;
+    case GJK_SHAPE_CAPSULE: {
+      //NOTE: the line down the middle, the radius gets added on after clipping
+      result.isEdge = true;
+      result.v1 = gjk_V2(-shape->halfLength, 0);
+      result.v2 = gjk_V2(shape->halfLength, 0);
+      result.index1 = 0;
+      result.index2 = 1;
+      result.radius = shape->radius;
+      if(shape->transformed) {
+        result.v1 = gjk_toWorld_(&shape->transform, result.v1);
+        result.v2 = gjk_toWorld_(&shape->transform, result.v2);
+      }
+      if(shape->halfLength == 0) result.isEdge = false;
+    } break;
+    case GJK_SHAPE_CIRCLE: {
+      result.v1 = shape->transformed ? shape->transform.position : gjk_V2(0, 0);
+      result.index1 = 0;
+      result.radius = shape->radius;
+    } break;
+    default: {
+      result.v1 = gjk_shapeSupport_(shape, n, 0);
     }
+  }
+  return result;
+}
+
+static unsigned int gjk_contactId_(int referenceEdge, int other, bool clipped, bool referenceIsB) {
+  unsigned int result = ((unsigned int)referenceEdge & GJK_FEATURE_INDEX_MASK) | (((unsigned int)other & GJK_FEATURE_INDEX_MASK) << 15);
+  if(clipped) result |= (1u << 30);
+  if(referenceIsB) result |= (1u << 31);
+  return result;
+}
+
+//NOTE: Standard clipping. The edge most side on to the normal is the reference, the other shape's edge gets cut down 
+//to the reference edge's width, and whatever's left behind the reference edge is in contact.
+static Gjk_Manifold gjk_manifoldFromEPA_(Gjk_Shape *a, Gjk_Shape *b, Gjk_EPA_Info *epa) {
+  Gjk_Manifold result;
+  memset(&result, 0, sizeof(result));
+  result.referenceEdge = -1;
+  result.incidentEdge = -1;
+  if(!epa->collided) return result;
+  result.collided = true;
+  result.normal = epa->normal;
+  result.depth = epa->distance;
+
+  gjk_v2 n = gjk_V2(-epa->normal.x, -epa->normal.y); //from a towards b
+  Gjk_Feature_ featureA = gjk_bestFeature_(a, n);
+  Gjk_Feature_ featureB = gjk_bestFeature_(b, gjk_V2(-n.x, -n.y));
 
+  if(!featureA.isEdge || !featureB.isEdge) {
+    //NOTE: a point (or circle) against something, there's only the one point
+    result.pointCount = 1;
+    if(!featureA.isEdge) {
+      result.points[0].point = gjk_shapeSupport_(a, n, 0);
+      result.points[0].id = gjk_contactId_(featureB.isEdge ? featureB.index1 : 0, featureA.index1, false, true);
+      result.referenceIsB = true;
+      result.referenceEdge = featureB.isEdge ? featureB.index1 : -1;
+    } else {
+      result.points[0].point = gjk_shapeSupport_(b, gjk_V2(-n.x, -n.y), 0);
+      result.points[0].id = gjk_contactId_(featureA.index1, featureB.index1, false, false);
+      result.referenceEdge = featureA.index1;
+    }
+    result.points[0].depth = result.depth;
     return result;
+  }
+
+  gjk_v2 edgeA = gjk_normalizeOrZero_(gjk_V2(featureA.v2.x - featureA.v1.x, featureA.v2.y - featureA.v1.y));
+  gjk_v2 edgeB = gjk_normalizeOrZero_(gjk_V2(featureB.v2.x - featureB.v1.x, featureB.v2.y - featureB.v1.y));
+  bool referenceIsB = gjk_abs(gjk_dot(edgeB, n)) < gjk_abs(gjk_dot(edgeA, n));
+  Gjk_Feature_ *reference = referenceIsB ? &featureB : &featureA;
+  Gjk_Feature_ *incident = referenceIsB ? &featureA : &featureB;
+  gjk_v2 referenceDirection = referenceIsB ? edgeB : edgeA;
+  //NOTE: the reference edge's normal, pointing out towards the incident shape whichever way round the points go
+  gjk_v2 facing = referenceIsB ? gjk_V2(-n.x, -n.y) : n;
+  gjk_v2 referenceNormal = gjk_V2(-referenceDirection.y, referenceDirection.x);
+  if(gjk_dot(referenceNormal, facing) < 0) referenceNormal = gjk_negate_v2(referenceNormal);
+
+  gjk_v2 points[2] = {incident->v1, incident->v2};
+  int ids[2] = {incident->index1, incident->index2};
+  bool clipped[2] = {false, false};
+  bool offTheSide = false;
+
+  //NOTE: cut the incident edge at the two sides of the reference edge
+  for(int side = 0; side < 2 && !offTheSide; ++side) {
+    gjk_v2 planeNormal = (side == 0) ? referenceDirection : gjk_negate_v2(referenceDirection);
+    gjk_v2 planePoint = (side == 0) ? reference->v1 : reference->v2;
+    int planeIndex = (side == 0) ? reference->index1 : reference->index2;
+    gjk_real offset = gjk_dot(planeNormal, planePoint);
+    gjk_real d0 = gjk_dot(planeNormal, points[0]) - offset;
+    gjk_real d1 = gjk_dot(planeNormal, points[1]) - offset;
+    if(d0 < 0 && d1 < 0) {
+      //NOTE: the incident edge is completely off the side, only happens from rounding. Falls through to the deepest point below.
+      offTheSide = true;
+    } else if(d0 < 0 || d1 < 0) {
+      int outside = (d0 < 0) ? 0 : 1;
+      gjk_real t = d0 / (d0 - d1);
+      points[outside] = gjk_V2(points[0].x + t*(points[1].x - points[0].x), points[0].y + t*(points[1].y - points[0].y));
+      ids[outside] = planeIndex;
+      clipped[outside] = true;
+    }
+  }
+
+  gjk_real referenceOffset = gjk_dot(referenceNormal, reference->v1) + reference->radius;
+  for(int i = 0; i < 2 && !offTheSide; ++i) {
+    //NOTE: moved out to the incident shape's surface
+    gjk_v2 p = gjk_V2(points[i].x - referenceNormal.x*incident->radius, points[i].y - referenceNormal.y*incident->radius);
+    gjk_real depth = referenceOffset - gjk_dot(referenceNormal, p);
+    if(depth < 0) continue;
+    if(i == 1 && result.pointCount == 1 && p.x == result.points[0].point.x && p.y == result.points[0].point.y) continue;
+    Gjk_ContactPoint *contact = result.points + result.pointCount++;
+    contact->point = p;
+    contact->depth = depth;
+    contact->id = gjk_contactId_(reference->index1, ids[i], clipped[i], referenceIsB);
+  }
+
+  if(result.pointCount == 0) {
+    //NOTE: EPA says they're touching but the edges don't quite agree, use the deepest incident point
+    gjk_v2 deepest = gjk_shapeSupport_(referenceIsB ? a : b, referenceIsB ? n : gjk_V2(-n.x, -n.y), 0);
+    result.pointCount = 1;
+    result.points[0].point = deepest;
+    result.points[0].depth = result.depth;
+    result.points[0].id = gjk_contactId_(reference->index1, incident->index1, false, referenceIsB);
+  }
+
+  //NOTE: the reference edge's normal is steadier than EPA's from frame to frame, which is what stacking wants
+  gjk_v2 normal = referenceIsB ? referenceNormal : gjk_negate_v2(referenceNormal);
+  result.normal = normal;
+  result.depth = result.points[0].depth;
+  if(result.pointCount == 2 && result.points[1].depth > result.depth) result.depth = result.points[1].depth;
+  result.referenceIsB = referenceIsB;
+  result.referenceEdge = reference->index1;
+  result.incidentEdge = incident->index1;
+  return result;
+}
+
+Gjk_Manifold gjk_shapesManifold(Gjk_Shape *a, Gjk_Shape *b) {
+  Gjk_EPA_Info epa = gjk_epa_(a, b, 0, 0);
+  return gjk_manifoldFromEPA_(a, b, &epa);
+}
+
+Gjk_Manifold gjk_shapesManifold_cached(Gjk_Shape *a, Gjk_Shape *b, Gjk_PairCache *cache) {
+  GJK_ASSERT(cache);
+  Gjk_EPA_Info epa = gjk_epa_(a, b, cache, 0);
+  return gjk_manifoldFromEPA_(a, b, &epa);
+}
+
+Gjk_Manifold gjk_objectsManifold(gjk_v2 *a, int aCount, gjk_v2 *b, int bCount) {
+  Gjk_Shape shapeA = gjk_polygonShape(a, aCount);
+  Gjk_Shape shapeB = gjk_polygonShape(b, bCount);
+  return gjk_shapesManifold(&shapeA, &shapeB);
+}
+
+//////////////////////////////////////////////// Distance and time of impact ////////////////////////////////////////////////
+
+//NOTE: gjk_doSimplex_ only ever needs to know which side of the simplex the origin is on, so it throws away where the closest point is. 
+//The distance query needs that, and which point of each shape made each corner, so it keeps its own simplex. It still uses 
+//the same support functions, so every shape kind and the simd scans work here too.
+typedef struct {
+  gjk_v2 w; //a - b
+  gjk_v2 a;
+  gjk_v2 b;
+  gjk_real weight; //how much of the closest point comes from this corner
+} Gjk_DistanceVertex_;
+
+typedef struct {
+  Gjk_DistanceVertex_ v[3];
+  int count;
+} Gjk_DistanceSimplex_;
+
+//NOTE: Cuts the simplex down to the corners nearest the origin and sets their weights. Returns false if the triangle holds the origin.
+static bool gjk_solveDistanceSimplex_(Gjk_DistanceSimplex_ *simplex) {
+  Gjk_DistanceVertex_ *v = simplex->v;
+  if(simplex->count == 1) {
+    v[0].weight = 1;
+  } else if(simplex->count == 2) {
+    gjk_v2 e = gjk_V2(v[1].w.x - v[0].w.x, v[1].w.y - v[0].w.y);
+    gjk_real u = gjk_dot(v[1].w, e); //how far past the first corner
+    gjk_real t = -gjk_dot(v[0].w, e); //how far before the second
+    if(t <= 0) {
+      v[0].weight = 1;
+      simplex->count = 1;
+    } else if(u <= 0) {
+      v[0] = v[1];
+      v[0].weight = 1;
+      simplex->count = 1;
+    } else {
+      gjk_real inverse = 1.0f / (u + t);
+      v[0].weight = u*inverse;
+      v[1].weight = t*inverse;
+    }
+  } else {
+    GJK_ASSERT(simplex->count == 3);
+    gjk_v2 w1 = v[0].w;
+    gjk_v2 w2 = v[1].w;
+    gjk_v2 w3 = v[2].w;
+
+    //NOTE: each edge on its own, like the two point case
+    gjk_v2 e12 = gjk_V2(w2.x - w1.x, w2.y - w1.y);
+    gjk_real d12_1 = gjk_dot(w2, e12);
+    gjk_real d12_2 = -gjk_dot(w1, e12);
+    gjk_v2 e13 = gjk_V2(w3.x - w1.x, w3.y - w1.y);
+    gjk_real d13_1 = gjk_dot(w3, e13);
+    gjk_real d13_2 = -gjk_dot(w1, e13);
+    gjk_v2 e23 = gjk_V2(w3.x - w2.x, w3.y - w2.y);
+    gjk_real d23_1 = gjk_dot(w3, e23);
+    gjk_real d23_2 = -gjk_dot(w2, e23);
+
+    //NOTE: and which side of each edge the origin is on, as signed areas
+    gjk_real n123 = gjk_cross2D_(e12, e13);
+    gjk_real d123_1 = n123*gjk_cross2D_(w2, w3);
+    gjk_real d123_2 = n123*gjk_cross2D_(w3, w1);
+    gjk_real d123_3 = n123*gjk_cross2D_(w1, w2);
+
+    if(d12_2 <= 0 && d13_2 <= 0) {
+      v[0].weight = 1;
+      simplex->count = 1;
+    } else if(d12_1 > 0 && d12_2 > 0 && d123_3 <= 0) {
+      gjk_real inverse = 1.0f / (d12_1 + d12_2);
+      v[0].weight = d12_1*inverse;
+      v[1].weight = d12_2*inverse;
+      simplex->count = 2;
+    } else if(d13_1 > 0 && d13_2 > 0 && d123_2 <= 0) {
+      gjk_real inverse = 1.0f / (d13_1 + d13_2);
+      v[0].weight = d13_1*inverse;
+      v[2].weight = d13_2*inverse;
+      v[1] = v[2];
+      simplex->count = 2;
+    } else if(d12_1 <= 0 && d23_2 <= 0) {
+      v[0] = v[1];
+      v[0].weight = 1;
+      simplex->count = 1;
+    } else if(d13_1 <= 0 && d23_1 <= 0) {
+      v[0] = v[2];
+      v[0].weight = 1;
+      simplex->count = 1;
+    } else if(d23_1 > 0 && d23_2 > 0 && d123_1 <= 0) {
+      gjk_real inverse = 1.0f / (d23_1 + d23_2);
+      v[1].weight = d23_1*inverse;
+      v[2].weight = d23_2*inverse;
+      v[0] = v[2];
+      simplex->count = 2;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+Gjk_Distance_Info gjk_shapesDistance(Gjk_Shape *a, Gjk_Shape *b) {
+  Gjk_Distance_Info result;
+  memset(&result, 0, sizeof(result));
+  if(gjk_shapeIsEmpty_(a) || gjk_shapeIsEmpty_(b)) return result;
+
+  Gjk_DistanceSimplex_ simplex;
+  simplex.count = 0;
+  gjk_v2 d = gjk_V2(1, 0);
+  gjk_v2 closest = gjk_V2(0, 0);
+  gjk_real sizeSqr = 0; //the furthest point of the shapes' difference we've seen, so touching is the same for tiny and huge shapes
+  for(int iteration = 0; iteration < GJK_DISTANCE_MAX_ITERATIONS; ++iteration) {
+    Gjk_DistanceVertex_ vertex;
+    vertex.a = gjk_shapeSupport_(a, d, 0);
+    vertex.b = gjk_shapeSupport_(b, gjk_V2(-d.x, -d.y), 0);
+    vertex.w = gjk_V2(vertex.a.x - vertex.b.x, vertex.a.y - vertex.b.y);
+    vertex.weight = 0;
+    if(gjk_dot(vertex.w, vertex.w) > sizeSqr) sizeSqr = gjk_dot(vertex.w, vertex.w);
+
+    if(simplex.count > 0) {
+      //NOTE: stop once the new point isn't any closer than what we've got, or is one we've already got
+      gjk_real closestLengthSqr = gjk_dot(closest, closest);
+      if(closestLengthSqr - gjk_dot(closest, vertex.w) <= 1e-6f*closestLengthSqr) break;
+      bool repeated = false;
+      for(int i = 0; i < simplex.count; ++i) {
+        if(simplex.v[i].w.x == vertex.w.x && simplex.v[i].w.y == vertex.w.y) repeated = true;
+      }
+      if(repeated) {
+        //NOTE: Rounding. It's a point we've already got but it's still closer along closest than closest is, so closest is a bit 
+        //off. If the shapes don't even reach past the origin along it there's no gap between them we can trust.
+        if(gjk_dot(closest, vertex.w) <= 0) {
+          result.overlapping = true;
+          return result;
+        }
+        break;
+      }
+    }
+
+    simplex.v[simplex.count++] = vertex;
+    if(!gjk_solveDistanceSimplex_(&simplex)) {
+      result.overlapping = true;
+      return result;
+    }
+
+    closest = gjk_V2(0, 0);
+    for(int i = 0; i < simplex.count; ++i) {
+      closest.x += simplex.v[i].weight*simplex.v[i].w.x;
+      closest.y += simplex.v[i].weight*simplex.v[i].w.y;
+    }
+    if(simplex.count == 2) {
+      //NOTE: When a long edge passes close to the origin the weighted sum is a small difference of big numbers and its direction 
+      //is mostly rounding. Straight out from the edge keeps the direction right, which is what the next support point needs.
+      gjk_v2 e = gjk_V2(simplex.v[1].w.x - simplex.v[0].w.x, simplex.v[1].w.y - simplex.v[0].w.y);
+      gjk_real eLengthSqr = gjk_dot(e, e);
+      if(eLengthSqr > 0) {
+        gjk_real side = gjk_cross2D_(e, simplex.v[0].w) / eLengthSqr;
+        closest = gjk_V2(-e.y*side, e.x*side);
+      }
+    }
+    gjk_real touching = 0.1f*GJK_RELATIVE_EPSILON;
+    if(gjk_dot(closest, closest) <= touching*touching*sizeSqr) {
+      //NOTE: touching, within a tenth of GJK_RELATIVE_EPSILON of their size (a millionth in floats). Closer than that we 
+      //can't tell which way the origin is.
+      result.overlapping = true;
+      return result;
+    }
+    d = gjk_V2(-closest.x, -closest.y);
+  }
+
+  result.pointA = gjk_V2(0, 0);
+  result.pointB = gjk_V2(0, 0);
+  for(int i = 0; i < simplex.count; ++i) {
+    result.pointA.x += simplex.v[i].weight*simplex.v[i].a.x;
+    result.pointA.y += simplex.v[i].weight*simplex.v[i].a.y;
+    result.pointB.x += simplex.v[i].weight*simplex.v[i].b.x;
+    result.pointB.y += simplex.v[i].weight*simplex.v[i].b.y;
+  }
+  result.distance = gjk_sqrt(gjk_dot(closest, closest));
+  //NOTE: closest is a - b, so b is the other way
+  result.normal = gjk_V2(-closest.x / result.distance, -closest.y / result.distance);
+  return result;
+}
+
+Gjk_Distance_Info gjk_objectsDistance(gjk_v2 *a, int aCount, gjk_v2 *b, int bCount) {
+  Gjk_Shape shapeA = gjk_polygonShape(a, aCount);
+  Gjk_Shape shapeB = gjk_polygonShape(b, bCount);
+  return gjk_shapesDistance(&shapeA, &shapeB);
+}
+
+//NOTE: a copy of the shape moved by offset, without touching its points
+static Gjk_Shape gjk_movedShape_(Gjk_Shape *shape, gjk_v2 offset) {
+  Gjk_Shape result = *shape;
+  if(!result.transformed) {
+    result.transformed = true;
+    result.transform.position = gjk_V2(0, 0);
+    result.transform.cosAngle = 1;
+    result.transform.sinAngle = 0;
+  }
+  result.transform.position.x += offset.x;
+  result.transform.position.y += offset.y;
+  return result;
+}
+
+//NOTE: Conservative advancement. For shapes that only move in a straight line the distance between them can't drop faster 
+//than their closing speed along the current closest normal, so stepping by distance / closing speed never goes past the hit.
+Gjk_TOI_Info gjk_shapesTimeOfImpact(Gjk_Shape *a, gjk_v2 moveA, Gjk_Shape *b, gjk_v2 moveB) {
+  Gjk_TOI_Info result;
+  memset(&result, 0, sizeof(result));
+  //NOTE: keep a still and move b by the difference
+  gjk_v2 move = gjk_V2(moveB.x - moveA.x, moveB.y - moveA.y);
+  gjk_real t = 0;
+  gjk_real apartT = 0; //the last t they were apart at
+  gjk_real overlapT = 2; //the first t we saw them overlapping at, past the end until we do
+  Gjk_Distance_Info apart;
+  memset(&apart, 0, sizeof(apart));
+  for(int iteration = 0; iteration < GJK_TOI_MAX_ITERATIONS; ++iteration) {
+    Gjk_Shape movedB = gjk_movedShape_(b, gjk_V2(move.x*t, move.y*t));
+    Gjk_Distance_Info distance = gjk_shapesDistance(a, &movedB);
+    if(distance.overlapping && iteration == 0) {
+      //NOTE: they start out overlapping, there's no closest point to give back
+      result.hit = true;
+      break;
+    }
+    if(distance.overlapping) {
+      //NOTE: The step can only go past the hit by rounding, when the normal is a little off or they're moving so fast a float t 
+      //can't land within GJK_TOI_TOLERANCE. From here on it never steps past overlapT.
+      overlapT = t;
+    } else {
+      apartT = t;
+      apart = distance;
+      if(distance.distance <= GJK_TOI_TOLERANCE) break;
+    }
+
+    gjk_real next = 2;
+    gjk_real closingSpeed = -gjk_dot(move, apart.normal);
+    if(closingSpeed > 0) next = apartT + (apart.distance - 0.5f*GJK_TOI_TOLERANCE) / closingSpeed;
+    if(overlapT <= 1 && next >= overlapT) next = apartT + 0.5f*(overlapT - apartT);
+    if(next > 1) break; //moving apart, sliding past, or not getting there this tick
+    if(next == t) break; //as close as floats get
+    t = next;
+  }
+
+  if(!result.hit && (apart.distance <= GJK_TOI_TOLERANCE || overlapT <= 1)) {
+    result.hit = true;
+    result.t = apartT;
+    result.normal = apart.normal;
+    result.point = gjk_V2(apart.pointA.x + moveA.x*apartT, apart.pointA.y + moveA.y*apartT);
+  }
+  return result;
 }
 
 bool gjk_objectsCollide(gjk_v2 *a, int aCount, gjk_v2 *b, int bCount) {
-  GjkInfo result = gjk_objectsCollide_(a, aCount, b, bCount);
+  Gjk_Info result = gjk_objectsCollide_(a, aCount, b, bCount);
   return result.collided;
 }
+
+//////////////////////////////////////////////// World (broadphase) ////////////////////////////////////////////////
+
+//NOTE: grows an array to fit at least count, doubling. Our own instead of realloc so it goes through EASY_HEADERS_ALLOC.
+static void *gjk_growArray_(void *array, int *capacity, int count, size_t elementSize) {
+    if(count <= *capacity) return array;
+    int newCapacity = *capacity ? *capacity*2 : 64;
+    while(newCapacity < count) { newCapacity *= 2; }
+    void *result = EASY_HEADERS_ALLOC(newCapacity*elementSize);
+    GJK_ASSERT(result);
+    if(array) {
+        memcpy(result, array, (*capacity)*elementSize);
+        EASY_HEADERS_FREE(array);
+    }
+    *capacity = newCapacity;
+    return result;
+}
+
+static Gjk_Aabb gjk_findAabb_(gjk_v2 *points, int count) {
+    Gjk_Aabb result;
+    memset(&result, 0, sizeof(result));
+    if(count > 0) {
+        result.minX = result.maxX = points[0].x;
+        result.minY = result.maxY = points[0].y;
+    }
+    for(int i = 1; i < count; ++i) {
+        gjk_v2 p = points[i];
+        if(p.x < result.minX) result.minX = p.x;
+        if(p.x > result.maxX) result.maxX = p.x;
+        if(p.y < result.minY) result.minY = p.y;
+        if(p.y > result.maxY) result.maxY = p.y;
+    }
+    return result;
+}
+
+void gjk_initWorld(Gjk_World *world) {
+    memset(world, 0, sizeof(Gjk_World));
+    world->firstFree = -1;
+}
+
+void gjk_freeWorld(Gjk_World *world) {
+    if(world->bodies) EASY_HEADERS_FREE(world->bodies);
+    if(world->sweep) EASY_HEADERS_FREE(world->sweep);
+    if(world->pairs) EASY_HEADERS_FREE(world->pairs);
+    gjk_initWorld(world);
+}
+
+int gjk_addBody(Gjk_World *world, gjk_v2 *points, int count) {
+    GJK_ASSERT(points);
+    int id = world->firstFree;
+    if(id >= 0) {
+        world->firstFree = world->bodies[id].nextFree;
+    } else {
+        world->bodies = (Gjk_Body *)gjk_growArray_(world->bodies, &world->bodyCapacity, world->bodyCount + 1, sizeof(Gjk_Body));
+        id = world->bodyCount++;
+    }
+    Gjk_Body *body = world->bodies + id;
+    body->points = points;
+    body->count = count;
+    body->aabb = gjk_findAabb_(points, count);
+    body->nextFree = -1;
+    world->sweepDirty = true;
+    return id;
+}
+
+void gjk_updateBody(Gjk_World *world, int id, gjk_v2 *points, int count) {
+    GJK_ASSERT(id >= 0 && id < world->bodyCount && world->bodies[id].points && points);
+    Gjk_Body *body = world->bodies + id;
+    body->points = points;
+    body->count = count;
+    body->aabb = gjk_findAabb_(points, count);
+}
+
+void gjk_removeBody(Gjk_World *world, int id) {
+    GJK_ASSERT(id >= 0 && id < world->bodyCount && world->bodies[id].points);
+    Gjk_Body *body = world->bodies + id;
+    body->points = 0;
+    body->count = 0;
+    body->nextFree = world->firstFree;
+    world->firstFree = id;
+    world->sweepDirty = true;
+}
+
+static int gjk_compareSweepEntries_(const void *a, const void *b) {
+    gjk_real minA = ((Gjk_SweepEntry *)a)->aabb.minX;
+    gjk_real minB = ((Gjk_SweepEntry *)b)->aabb.minX;
+    return (minA < minB) ? -1 : (minA > minB);
+}
+
+//NOTE: Sweep and prune along x. The entries are sorted by minX, so each box only has to look at the boxes after it until one starts past its maxX.
+int gjk_findPairs(Gjk_World *world) {
+    if(world->sweepDirty) {
+        //NOTE: bodies came or went, start again with the live ones and a full sort
+        world->sweep = (Gjk_SweepEntry *)gjk_growArray_(world->sweep, &world->sweepCapacity, world->bodyCount, sizeof(Gjk_SweepEntry));
+        world->sweepCount = 0;
+        for(int i = 0; i < world->bodyCount; ++i) {
+            if(world->bodies[i].points) {
+                Gjk_SweepEntry *entry = world->sweep + world->sweepCount++;
+                entry->aabb = world->bodies[i].aabb;
+                entry->id = i;
+            }
+        }
+        qsort(world->sweep, world->sweepCount, sizeof(Gjk_SweepEntry), gjk_compareSweepEntries_);
+        world->sweepDirty = false;
+    } else {
+        //NOTE: same bodies as last time, so the order is nearly right already. Insertion sort is close to O(n) on that.
+        Gjk_SweepEntry *sweep = world->sweep;
+        for(int i = 0; i < world->sweepCount; ++i) {
+            sweep[i].aabb = world->bodies[sweep[i].id].aabb;
+        }
+        for(int i = 1; i < world->sweepCount; ++i) {
+            Gjk_SweepEntry entry = sweep[i];
+            int j = i - 1;
+            while(j >= 0 && sweep[j].aabb.minX > entry.aabb.minX) {
+                sweep[j + 1] = sweep[j];
+                j--;
+            }
+            sweep[j + 1] = entry;
+        }
+    }
+
+    world->pairCount = 0;
+    for(int i = 0; i < world->sweepCount; ++i) {
+        Gjk_Aabb box = world->sweep[i].aabb;
+        for(int j = i + 1; j < world->sweepCount && world->sweep[j].aabb.minX <= box.maxX; ++j) {
+            Gjk_Aabb other = world->sweep[j].aabb;
+            if(other.minY <= box.maxY && other.maxY >= box.minY) {
+                if(world->pairCount == world->pairCapacity) {
+                    world->pairs = (Gjk_Pair *)gjk_growArray_(world->pairs, &world->pairCapacity, world->pairCount + 1, sizeof(Gjk_Pair));
+                }
+                int a = world->sweep[i].id;
+                int b = world->sweep[j].id;
+                Gjk_Pair *pair = world->pairs + world->pairCount++;
+                pair->a = (a < b) ? a : b;
+                pair->b = (a < b) ? b : a;
+            }
+        }
+    }
+
+    return world->pairCount;
+}
+
+int gjk_collideWorld(Gjk_World *world, Gjk_Contact *contacts, int contactCapacity, bool withEPA) {
+    int collidedCount = 0;
+    int pairCount = gjk_findPairs(world);
+    for(int i = 0; i < pairCount; ++i) {
+        Gjk_Pair pair = world->pairs[i];
+        Gjk_Body *a = world->bodies + pair.a;
+        Gjk_Body *b = world->bodies + pair.b;
+
+        Gjk_Contact contact;
+        memset(&contact, 0, sizeof(contact));
+        contact.a = pair.a;
+        contact.b = pair.b;
+        bool collided = false;
+        if(withEPA) {
+            Gjk_EPA_Info info = gjk_objectsCollide_withEPA(a->points, a->count, b->points, b->count);
+            collided = info.collided;
+            contact.normal = info.normal;
+            contact.distance = info.distance;
+        } else {
+            collided = gjk_objectsCollide(a->points, a->count, b->points, b->count);
+        }
+
+        if(collided) {
+            if(collidedCount < contactCapacity) {
+                contacts[collidedCount] = contact;
+            }
+            collidedCount++;
+        }
+    }
+    return collidedCount;
+}
+//////////////////////////////////////////////// Batches ////////////////////////////////////////////////
+
+#if !defined(GJK_NO_THREADS)
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#define GJK_THREADS_WIN32 1
+#else 
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#define GJK_THREADS_PTHREADS 1
+#endif
+#endif
+
+typedef struct {
+  Gjk_ShapePair *pairs;
+  Gjk_EPA_Info *results;
+  int pairCount;
+  int chunkCount;
+} Gjk_Batch_;
+
+//NOTE: Every pair writes to its own slot in results, so the order never depends on which thread did what
+static void gjk_collideChunk_(Gjk_Batch_ *batch, int chunk, Gjk_EpaPolytope_ *scratch) {
+  int start = chunk*GJK_BATCH_CHUNK;
+  int end = start + GJK_BATCH_CHUNK;
+  if(end > batch->pairCount) end = batch->pairCount;
+  for(int i = start; i < end; ++i) {
+    batch->results[i] = gjk_shapesCollide_withEPAWithCache_(batch->pairs[i].a, batch->pairs[i].b, 0, scratch);
+  }
+}
+
+static void gjk_collideChunkTask_(void *taskData, int taskIndex) {
+  Gjk_EpaPolytope_ scratch;
+  gjk_initEpaPolytope_(&scratch);
+  gjk_collideChunk_((Gjk_Batch_ *)taskData, taskIndex, &scratch);
+  gjk_freeEpaPolytope_(&scratch);
+}
+
+void gjk_collideBatch_withRunner(Gjk_ShapePair *pairs, int pairCount, Gjk_EPA_Info *results, Gjk_TaskRunner *runner) {
+  Gjk_Batch_ batch;
+  batch.pairs = pairs;
+  batch.results = results;
+  batch.pairCount = pairCount;
+  batch.chunkCount = (pairCount + GJK_BATCH_CHUNK - 1) / GJK_BATCH_CHUNK;
+  if(batch.chunkCount == 0) return;
+  GJK_ASSERT(runner && runner->runTasks);
+  runner->runTasks(runner->userData, gjk_collideChunkTask_, &batch, batch.chunkCount);
+}
+
+#if GJK_THREADS_WIN32 || GJK_THREADS_PTHREADS
+static long long gjk_atomicLoad64_(volatile long long *ptr) {
+#if defined(_MSC_VER) && !defined(__clang__)
+  return InterlockedCompareExchange64((volatile LONG64 *)ptr, 0, 0);
+#else
+  return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static void gjk_atomicStore64_(volatile long long *ptr, long long value) {
+#if defined(_MSC_VER) && !defined(__clang__)
+  InterlockedExchange64((volatile LONG64 *)ptr, (LONG64)value);
+#else
+  __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+#endif
+}
+
+static bool gjk_atomicCas64_(volatile long long *ptr, long long expected, long long desired) {
+#if defined(_MSC_VER) && !defined(__clang__)
+  return InterlockedCompareExchange64((volatile LONG64 *)ptr, (LONG64)desired, (LONG64)expected) == (LONG64)expected;
+#else
+  return __atomic_compare_exchange_n(ptr, &expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+#endif
+}
+
+//NOTE: Each thread owns a range of chunks packed into 64 bits, next in the low half and end in the high half, so taking one 
+//or stealing half is a single compare and swap. The owner takes from the front and thieves take the back half. 
+//Padded out so two threads' ranges aren't on the same cache line.
+typedef struct {
+  volatile long long range;
+  char pad[56];
+} Gjk_StealRange_;
+
+#define gjk_packRange_(next, end) ((long long)(((unsigned long long)(unsigned int)(end) << 32) | (unsigned int)(next)))
+#define gjk_rangeNext_(range) ((int)((unsigned long long)(range) & 0xFFFFFFFF))
+#define gjk_rangeEnd_(range) ((int)((unsigned long long)(range) >> 32))
+#endif
+
+typedef struct Gjk_ThreadPoolInternal_ Gjk_ThreadPoolInternal_;
+
+typedef struct {
+  Gjk_ThreadPoolInternal_ *pool;
+  int index;
+  Gjk_EpaPolytope_ scratch;
+#if GJK_THREADS_WIN32
+  HANDLE handle;
+#elif GJK_THREADS_PTHREADS
+  pthread_t handle;
+#endif
+} Gjk_Worker_;
+
+struct Gjk_ThreadPoolInternal_ {
+  int threadCount;
+  Gjk_Worker_ *workers; //workers[0] is the thread calling gjk_collideBatch
+#if GJK_THREADS_WIN32 || GJK_THREADS_PTHREADS
+  Gjk_StealRange_ *ranges;
+  Gjk_Batch_ batch;
+
+  //NOTE: only touched when a batch starts and ends, never while pairs are being tested
+  int generation;
+  int busyWorkers;
+  bool quit;
+#endif
+#if GJK_THREADS_WIN32
+  SRWLOCK lock;
+  CONDITION_VARIABLE wake;
+  CONDITION_VARIABLE done;
+#elif GJK_THREADS_PTHREADS
+  pthread_mutex_t lock;
+  pthread_cond_t wake;
+  pthread_cond_t done;
+#endif
+};
+
+#if GJK_THREADS_WIN32 || GJK_THREADS_PTHREADS
+static int gjk_takeChunk_(Gjk_StealRange_ *range) {
+  while(true) {
+    long long r = gjk_atomicLoad64_(&range->range);
+    int next = gjk_rangeNext_(r);
+    int end = gjk_rangeEnd_(r);
+    if(next >= end) return -1;
+    if(gjk_atomicCas64_(&range->range, r, gjk_packRange_(next + 1, end))) return next;
+  }
+}
+
+//NOTE: Takes the back half of someone else's chunks. Returns one to do now and puts the rest in the thief's own range.
+static int gjk_stealChunk_(Gjk_ThreadPoolInternal_ *pool, int thief) {
+  for(int k = 1; k < pool->threadCount; ++k) {
+    Gjk_StealRange_ *victim = pool->ranges + ((thief + k) % pool->threadCount);
+    while(true) {
+      long long r = gjk_atomicLoad64_(&victim->range);
+      int next = gjk_rangeNext_(r);
+      int end = gjk_rangeEnd_(r);
+      if(next >= end) break;
+      int middle = next + (end - next) / 2;
+      if(gjk_atomicCas64_(&victim->range, r, gjk_packRange_(next, middle))) {
+        //NOTE: our own range is empty, and nobody else writes to an empty range, so a plain store is fine
+        gjk_atomicStore64_(&pool->ranges[thief].range, gjk_packRange_(middle + 1, end));
+        return middle;
+      }
+    }
+  }
+  return -1;
+}
+
+static void gjk_workOnBatch_(Gjk_ThreadPoolInternal_ *pool, Gjk_Worker_ *worker) {
+  Gjk_StealRange_ *own = pool->ranges + worker->index;
+  while(true) {
+    int chunk = gjk_takeChunk_(own);
+    if(chunk < 0) chunk = gjk_stealChunk_(pool, worker->index);
+    if(chunk < 0) break;
+    gjk_collideChunk_(&pool->batch, chunk, &worker->scratch);
+  }
+}
+
+#if GJK_THREADS_WIN32
+#define gjk_lock_(pool) AcquireSRWLockExclusive(&(pool)->lock)
+#define gjk_unlock_(pool) ReleaseSRWLockExclusive(&(pool)->lock)
+#define gjk_wait_(pool, condition) SleepConditionVariableSRW(&(pool)->condition, &(pool)->lock, INFINITE, 0)
+#define gjk_wakeAll_(pool, condition) WakeAllConditionVariable(&(pool)->condition)
+static DWORD WINAPI gjk_workerThread_(LPVOID data) {
+#else
+#define gjk_lock_(pool) pthread_mutex_lock(&(pool)->lock)
+#define gjk_unlock_(pool) pthread_mutex_unlock(&(pool)->lock)
+#define gjk_wait_(pool, condition) pthread_cond_wait(&(pool)->condition, &(pool)->lock)
+#define gjk_wakeAll_(pool, condition) pthread_cond_broadcast(&(pool)->condition)
+static void *gjk_workerThread_(void *data) {
+#endif
+  Gjk_Worker_ *worker = (Gjk_Worker_ *)data;
+  Gjk_ThreadPoolInternal_ *pool = worker->pool;
+  int seenGeneration = 0;
+  while(true) {
+    gjk_lock_(pool);
+    while(!pool->quit && pool->generation == seenGeneration) {
+      gjk_wait_(pool, wake);
+    }
+    bool quit = pool->quit;
+    seenGeneration = pool->generation;
+    gjk_unlock_(pool);
+    if(quit) break;
+
+    gjk_workOnBatch_(pool, worker);
+
+    gjk_lock_(pool);
+    if(--pool->busyWorkers == 0) {
+      gjk_wakeAll_(pool, done);
+    }
+    gjk_unlock_(pool);
+  }
+  return 0;
+}
+#endif
+
+static int gjk_cpuCount_(void) {
+  int result = 1;
+#if GJK_THREADS_WIN32
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  result = (int)info.dwNumberOfProcessors;
+#elif GJK_THREADS_PTHREADS && defined(_SC_NPROCESSORS_ONLN)
+  result = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+  if(result < 1) result = 1;
+  return result;
+}
+
+void gjk_initThreadPool(Gjk_ThreadPool *pool, int threadCount) {
+  if(threadCount <= 0) threadCount = gjk_cpuCount_();
+#if !GJK_THREADS_WIN32 && !GJK_THREADS_PTHREADS
+  threadCount = 1;
+#endif
+  Gjk_ThreadPoolInternal_ *internal = (Gjk_ThreadPoolInternal_ *)EASY_HEADERS_ALLOC(sizeof(Gjk_ThreadPoolInternal_));
+  GJK_ASSERT(internal);
+  memset(internal, 0, sizeof(Gjk_ThreadPoolInternal_));
+  internal->threadCount = threadCount;
+  internal->workers = (Gjk_Worker_ *)EASY_HEADERS_ALLOC(threadCount*sizeof(Gjk_Worker_));
+  GJK_ASSERT(internal->workers);
+#if GJK_THREADS_WIN32 || GJK_THREADS_PTHREADS
+  internal->ranges = (Gjk_StealRange_ *)EASY_HEADERS_ALLOC(threadCount*sizeof(Gjk_StealRange_));
+  GJK_ASSERT(internal->ranges);
+  memset(internal->ranges, 0, threadCount*sizeof(Gjk_StealRange_));
+#endif
+
+#if GJK_THREADS_WIN32
+  InitializeSRWLock(&internal->lock);
+  InitializeConditionVariable(&internal->wake);
+  InitializeConditionVariable(&internal->done);
+#elif GJK_THREADS_PTHREADS
+  pthread_mutex_init(&internal->lock, 0);
+  pthread_cond_init(&internal->wake, 0);
+  pthread_cond_init(&internal->done, 0);
+#endif
+
+  for(int i = 0; i < threadCount; ++i) {
+    Gjk_Worker_ *worker = internal->workers + i;
+    worker->pool = internal;
+    worker->index = i;
+    gjk_initEpaPolytope_(&worker->scratch);
+    //NOTE: the calling thread is worker 0, it doesn't get a thread of its own
+    if(i == 0) continue;
+#if GJK_THREADS_WIN32
+    worker->handle = CreateThread(0, 0, gjk_workerThread_, worker, 0, 0);
+    GJK_ASSERT(worker->handle);
+#elif GJK_THREADS_PTHREADS
+    int error = pthread_create(&worker->handle, 0, gjk_workerThread_, worker);
+    GJK_ASSERT(error == 0);
+#endif
+  }
+
+  pool->threadCount = threadCount;
+  pool->internal_ = internal;
+}
+
+void gjk_freeThreadPool(Gjk_ThreadPool *pool) {
+  Gjk_ThreadPoolInternal_ *internal = (Gjk_ThreadPoolInternal_ *)pool->internal_;
+  if(!internal) return;
+#if GJK_THREADS_WIN32 || GJK_THREADS_PTHREADS
+  gjk_lock_(internal);
+  internal->quit = true;
+  gjk_wakeAll_(internal, wake);
+  gjk_unlock_(internal);
+#endif
+  for(int i = 0; i < internal->threadCount; ++i) {
+    Gjk_Worker_ *worker = internal->workers + i;
+    if(i > 0) {
+#if GJK_THREADS_WIN32
+      WaitForSingleObject(worker->handle, INFINITE);
+      CloseHandle(worker->handle);
+#elif GJK_THREADS_PTHREADS
+      pthread_join(worker->handle, 0);
+#endif
+    }
+    //NOTE: the scratch might have moved off its inline edges, the worker struct doesn't move so that's fine
+    gjk_freeEpaPolytope_(&worker->scratch);
+  }
+#if GJK_THREADS_PTHREADS
+  pthread_mutex_destroy(&internal->lock);
+  pthread_cond_destroy(&internal->wake);
+  pthread_cond_destroy(&internal->done);
+#endif
+  EASY_HEADERS_FREE(internal->workers);
+#if GJK_THREADS_WIN32 || GJK_THREADS_PTHREADS
+  EASY_HEADERS_FREE(internal->ranges);
+#endif
+  EASY_HEADERS_FREE(internal);
+  pool->internal_ = 0;
+  pool->threadCount = 0;
+}
+
+void gjk_collideBatch(Gjk_ShapePair *pairs, int pairCount, Gjk_EPA_Info *results, Gjk_ThreadPool *pool) {
+  int chunkCount = (pairCount + GJK_BATCH_CHUNK - 1) / GJK_BATCH_CHUNK;
+  if(chunkCount == 0) return;
+  Gjk_ThreadPoolInternal_ *internal = pool ? (Gjk_ThreadPoolInternal_ *)pool->internal_ : 0;
+  if(!internal || internal->threadCount == 1 || chunkCount == 1) {
+    Gjk_Batch_ batch;
+    batch.pairs = pairs;
+    batch.results = results;
+    batch.pairCount = pairCount;
+    batch.chunkCount = chunkCount;
+    Gjk_EpaPolytope_ localScratch;
+    Gjk_EpaPolytope_ *scratch = &localScratch;
+    if(internal) {
+      scratch = &internal->workers[0].scratch;
+    } else {
+      gjk_initEpaPolytope_(scratch);
+    }
+    for(int i = 0; i < chunkCount; ++i) {
+      gjk_collideChunk_(&batch, i, scratch);
+    }
+    if(!internal) gjk_freeEpaPolytope_(scratch);
+    return;
+  }
+
+#if GJK_THREADS_WIN32 || GJK_THREADS_PTHREADS
+  internal->batch.pairs = pairs;
+  internal->batch.results = results;
+  internal->batch.pairCount = pairCount;
+  internal->batch.chunkCount = chunkCount;
+  //NOTE: everyone starts with an even share and steals when they run out
+  for(int i = 0; i < internal->threadCount; ++i) {
+    int start = (int)((long long)chunkCount*i / internal->threadCount);
+    int end = (int)((long long)chunkCount*(i + 1) / internal->threadCount);
+    gjk_atomicStore64_(&internal->ranges[i].range, gjk_packRange_(start, end));
+  }
+
+  gjk_lock_(internal);
+  internal->busyWorkers = internal->threadCount - 1;
+  internal->generation++;
+  gjk_wakeAll_(internal, wake);
+  gjk_unlock_(internal);
+
+  gjk_workOnBatch_(internal, internal->workers + 0);
+
+  //NOTE: wait for everyone to stop looking at the ranges before they get reused by the next batch
+  gjk_lock_(internal);
+  while(internal->busyWorkers > 0) {
+    gjk_wait_(internal, done);
+  }
+  gjk_unlock_(internal);
 #endif
+}
+
+#endif // END OF IMPLEMENTATION
+#endif // END OF HEADER INCLUDE
@@ -14,6 +14,14 @@ How to use:
 easyString_getSizeInBytes_utf8(char *str) - get the size of the string in bytes NOT INCLUDING THE NULL TERMINATOR 
 easyString_getStringLength_utf8(char *str) - the number of glyphs in the string NOT INCLUDING THE NULL TERMINATOR. This function probably isn't very helpful. 
 
+The same with 64 bit sizes (the int ones assert over 2GB). They count 16/32 bytes at a time with SSE2/AVX2 and never decode anything, 
+a codepoint is just any byte that isn't a continuation byte:
+size_t easyString_byteLength_utf8(char *str) - like strlen
+size_t easyString_codepointCount_utf8(char *str, size_t byteCount) - codepoints in the first byteCount bytes, doesn't need a null terminator
+size_t easyString_codepointCount_nullTerminated(char *str)
+size_t easyString_codepointByteOffset_utf8(char *str, size_t byteCount, size_t codepoint) - where the Nth codepoint (from 0) starts, byteCount if there aren't that many. 
+Stops as soon as it finds it. If you ask this a lot on the same string use the codepoint index below.
+
 ////////////////////////////////////////////////////////////////////
 Probably the most useful function. See example below, but useful for rendering a utf8 string.  
 easyUnicode_utf8_codepoint_To_Utf32_codepoint(char **streamPtr, int advancePtr) - get the next codepoint in the utf8 string, & you can choose to advance your string pointer.  
@@ -22,13 +30,174 @@ easyUnicode_utf8_codepoint_To_Utf32_codepoint(char **streamPtr, int advancePtr)
 
 easyUnicode_utf8StreamToUtf32Stream_allocates(char *string) - turn the whole NULL TERMINATED string from utf8 to utf32 encoding
 Use easyString_free_Utf32_string(ptr) to free the memory from the function above when finished
+easyUnicode_utf8StreamToUtf32Stream_arena(EasyArena *arena, char *string) - same but takes the memory from an arena (see easy_arena.h), 
+so it goes away with the next easyArena_reset/easyArena_popToMark. Don't free it yourself.
+
+The bulk conversion uses SSE2/SSSE3/AVX2 when the cpu has them (picked at runtime), and the scalar decoder otherwise. The output is the same either way.
+#define EASY_STRING_NO_SIMD before including the file to compile the simd paths out completely.
+
+////////////////////////////////////////////////////////////////////
+Converting into your own buffer (no allocations, input doesn't have to be null terminated):
+
+easyUnicode_utf8ToUtf32(char *src, size_t srcLen, unsigned int *dst, size_t dstCap) - converts as much as fits. Returns the codepoints written, 
+the bytes consumed and a status (EASY_UNICODE_OK, EASY_UNICODE_OUTPUT_FULL, or EASY_UNICODE_NEED_MORE_INPUT if src ends part way through a codepoint).
+Doesn't write a null terminator.
+
+easyUnicode_utf8ToUtf32_requiredSize(char *src, size_t srcLen) - how many codepoints src decodes to, so you can size dst
+
+easyUnicode_utf8ToUtf32_stream(EasyUnicode_DecodeState *state, char *src, size_t srcLen, unsigned int *dst, size_t dstCap) - same as above but for one 
+string split over many chunks (reading a file or a socket). A codepoint cut off at the end of a chunk is held in the state and finished with the next chunk, 
+so codeUnitsConsumed is always all of the chunk unless the output filled up. Zero the state (or easyUnicode_initDecodeState) before the first chunk.
+
+	EasyUnicode_DecodeState state;
+	easyUnicode_initDecodeState(&state);
+	while((chunkSize = readChunk(chunk))) {
+		char *at = chunk;
+		size_t left = chunkSize;
+		while(left > 0) {
+			EasyUnicode_Result r = easyUnicode_utf8ToUtf32_stream(&state, at, left, buffer, arrayCount(buffer));
+			useCodepoints(buffer, r.codeUnitsWritten);
+			at += r.codeUnitsConsumed;
+			left -= r.codeUnitsConsumed;
+		}
+	}
+
+////////////////////////////////////////////////////////////////////
+Untrusted input:
+
+The functions above assert on malformed utf8 (and let overlong encodings and surrogates through). For text you don't control use these instead, 
+they never assert and follow the Unicode rules (no overlongs, no surrogates, nothing above U+10FFFF).
+
+easyString_validate_utf8(char *ptr, size_t len) - checks a whole buffer. Returns valid, and if it isn't, the kind of error and the byte offset of the bad sequence. 
+Runs with SSSE3/AVX2 lookups when it can so it's cheap enough to run on everything coming in.
+
+easyUnicode_utf8ToUtf32_validating(src, srcLen, dst, dstCap, policy) - same as easyUnicode_utf8ToUtf32 but checks as it goes. 
+With EASY_UNICODE_STOP_ON_INVALID it stops at the bad sequence, status is EASY_UNICODE_INVALID, codeUnitsConsumed is the offset and error is the kind.
+With EASY_UNICODE_REPLACE_INVALID every bad sequence becomes U+FFFD (one per maximal subpart like the Unicode standard recommends) and error is the first kind found.
+
+easyUnicode_utf8_codepoint_To_Utf32_codepoint_validated(char **streamPtr, char *streamEnd, EasyUnicode_Error *error) - one codepoint at a time, 
+returns U+FFFD and steps over the bad bytes instead of asserting. error can be null.
+
+////////////////////////////////////////////////////////////////////
+Writing utf8, and utf16:
+
+Same shape as easyUnicode_utf8ToUtf32_validating: converts into your buffer, returns the code units written and consumed and stops cleanly 
+when dst is full. codeUnitsConsumed is counted in the source's units (bytes for utf8, 16 bit for utf16, 32 bit for utf32).
+Same policy too, EASY_UNICODE_STOP_ON_INVALID or EASY_UNICODE_REPLACE_INVALID (U+FFFD).
+
+easyUnicode_utf32ToUtf8(unsigned int *src, size_t srcLen, char *dst, size_t dstCap, policy) - surrogates and anything above U+10FFFF are invalid
+easyUnicode_utf16ToUtf8(unsigned short *src, size_t srcLen, char *dst, size_t dstCap, policy)
+easyUnicode_utf8ToUtf16(char *src, size_t srcLen, unsigned short *dst, size_t dstCap, policy)
+easyUnicode_utf16ToUtf32(unsigned short *src, size_t srcLen, unsigned int *dst, size_t dstCap, policy)
+easyUnicode_utf32ToUtf16(unsigned int *src, size_t srcLen, unsigned short *dst, size_t dstCap, policy)
+
+utf16 is in the machine's byte order. A lone low surrogate is EASY_UNICODE_ERROR_UNEXPECTED_CONTINUATION, a high surrogate without a low one 
+after it is EASY_UNICODE_ERROR_MISSING_CONTINUATION, and a high surrogate at the very end is EASY_UNICODE_ERROR_TRUNCATED 
+(EASY_UNICODE_NEED_MORE_INPUT when stopping, so you can add the next chunk).
+
+easyUnicode_utf32ToUtf8_requiredSize(src, srcLen), and the same for the others - exactly how many units the conversion writes with 
+EASY_UNICODE_REPLACE_INVALID, so one allocation is always enough. (Stopping on invalid writes less.)
+
+	size_t size = easyUnicode_utf16ToUtf8_requiredSize(wide, wideLength);
+	char *utf8 = (char *)malloc(size + 1);
+	EasyUnicode_Result r = easyUnicode_utf16ToUtf8(wide, wideLength, utf8, size, EASY_UNICODE_REPLACE_INVALID);
+	utf8[r.codeUnitsWritten] = '\0';
+
+They run 4-16 codepoints at a time with SSE2/SSSE3/AVX2, everything else (4 byte utf8, surrogate pairs, bad input) goes one at a time.
+
+////////////////////////////////////////////////////////////////////
+
+easyString_getSimdLevel() - the instruction set the bulk functions are using
+easyString_setSimdLevel(level) - force a lower level, i.e. EASY_STRING_SIMD_NONE to compare against the scalar path
 
 ////////////////////////////////////////////////////////////////////
 String compare functions:
+All the lengths are in bytes (easyString_getSizeInBytes_utf8), not glyphs. They stop at the first byte that differs and compare 16/32 bytes at a time with SSE2/AVX2.
 int easyString_stringsMatch_withCount(char *a, int aLength, char *b, int bLength) - compares strings ignoring whether they're null terminated or not
 int easyString_stringsMatch_null_and_count(char *a, char *b, int bLen) - compares a null terminated string to a string with length bLen
 int easyString_stringsMatch_nullTerminated(char *a, char *b) - compares two null terminated strings 
 
+int easyString_compare(char *a, size_t aLength, char *b, size_t bLength) - ordering compare like memcmp, returns <0, 0 or >0. A shorter string that is the start 
+of the longer one comes first. Byte order of utf8 is the same as codepoint order, so this sorts by codepoint.
+int easyString_compare_nullTerminated(char *a, char *b) - same for two null terminated strings, like strcmp
+
+Up to 16 bytes is a word compare with no simd dispatch. examples/string_compare_bench.c times them on equal strings, on an AVX2 
+xeon (glibc 2.36, which picks its evex memcmp/strcmp there) best of 15 runs was, in ns:
+	bytes           4     16     64    256   4096
+	memcmp        2.8    2.9    3.5    4.2   58.7
+	compare       3.8    5.2    6.3   10.2   63.4
+	strcmp        3.2    3.4    4.7    9.4   76.5
+	nullTerminated 4.4   4.6    6.3   10.5  104.9
+The null terminated one is about strcmp up to a few hundred bytes and ~1.4x it at 4KB. compare is 1.1x memcmp at 4KB but up to 
+2x on 16-256 bytes, where memcmp does the whole thing with masked loads.
+
+////////////////////////////////////////////////////////////////////
+Interning:
+
+Turns strings into small ids so comparing names is comparing two ints. The table keeps its own copy of every string (so you can free yours) 
+and the ids and string pointers never change while the table is alive. Ids start at 1, 0 means not found.
+
+EasyString_InternTable table;
+easyString_initInternTable(&table, 1024); //roughly how many strings you expect, it grows if you go over
+unsigned int id = easyString_intern(&table, "walk_left", 9); //adds it if it isn't there yet
+unsigned int same = easyString_intern_nullTerminated(&table, "walk_left"); //same == id
+unsigned int found = easyString_internFind(&table, "run", 3); //never adds, 0 if it isn't there
+easyString_internMany(&table, strings, lengths, count, idsOut); //bulk insert, lengths can be null for null terminated strings
+char *name = easyString_internString(&table, id, &length); //back to the string (null terminated)
+
+easyString_freezeInternTable(&table) - no more adds after this (intern asserts). A frozen table is only ever read so any number of threads 
+can call easyString_internFind / easyString_internString on it at once without locking.
+easyString_freeInternTable(&table) - frees everything, the ids and strings are gone after this
+
+////////////////////////////////////////////////////////////////////
+Hashing:
+
+unsigned long long easyString_hash64(char *string, size_t length, unsigned long long seed) - fast seeded 64 bit hash of any bytes. 
+Not for security, but good enough for hash tables. Short keys (up to 16 bytes) are one 128 bit multiply-mix with no loop or dispatch, up 
+to 256 bytes is a wyhash style multiply-mix per 16 bytes, and longer than that runs an xxh3 style accumulator 64 bytes at a time 
+(SSE2/AVX2 when it can). Every path gives the same answer on every machine. Mixing the seed only depends on the seed, for a seed of 0 
+it's a constant. One multiply doesn't spread every input bit evenly over every output bit on 1-3 byte keys (each output bit flips 
+25-75% of the time instead of 50%), which doesn't matter for a table but does if you need every bit to be good.
+examples/string_hash_bench.cpp checks the levels agree and times it: on a 3GHz xeon it's 6-8ns for 4-16 bytes (FNV-1a 7-18ns, 
+std::hash 6-12ns), and ~24GB/s at 4KB. FNV-1a is about even at 4 bytes and slower from 8 up.
+
+In C++14 the same hash can run at compile time:
+	constexpr unsigned long long walkHash = EASY_STRING_HASH_LITERAL("walk_left", 0);
+	switch(easyString_hash64(name, nameLength, 0)) { case EASY_STRING_HASH_LITERAL("walk_left", 0): ... }
+easyString_hash64_constexpr(const char *string, size_t length, unsigned long long seed) is the function behind the macro.
+
+////////////////////////////////////////////////////////////////////
+Random access by codepoint:
+
+Finding the Nth codepoint means walking from the start. For text you index into a lot (a text box, an editor) build an index once, 
+it remembers the byte offset of every Kth codepoint so a lookup is one table read plus walking at most a couple of K codepoints. 
+The index doesn't copy the string, it points at yours. Offsets are in bytes, codepoints start at 0.
+
+EasyString_CodepointIndex index;
+easyString_initCodepointIndex(&index, text, textByteCount, 64); //K = 64, rounded up to a power of two, 0 picks 64. One simd pass over the text
+size_t byteOffset = easyString_codepointToByteOffset(&index, 1000); //where codepoint 1000 starts, index.codepointCount gives index.byteCount
+size_t codepoint = easyString_byteOffsetToCodepoint(&index, byteOffset); //the other way, i.e. for mouse clicks. A byte in the middle of a codepoint gives that codepoint
+char *line = easyString_sliceCodepoints(&index, 10, 20, &lineByteCount); //codepoints 10 up to (not including) 20, points into your string
+easyString_freeCodepointIndex(&index);
+
+Editing the text keeps the index up to date without scanning the whole string again, it only looks at the edited bytes and the samples around them:
+easyString_codepointIndexInsert(&index, newText, byteOffset, insertedByteCount) - call AFTER the bytes are in. newText is the buffer now (in case you grew it).
+easyString_codepointIndexRemove(&index, byteOffset, removedByteCount) - call BEFORE taking the bytes out, it needs to count the codepoints going away. 
+If moving the rest of the text down moves your buffer set index.string after.
+Edits have to start and end on codepoint boundaries.
+
+Going backwards:
+easyUnicode_utf8_previousCodepoint_To_Utf32_codepoint(char **streamPtr, char *streamStart) - moves your pointer back to the start of the codepoint 
+before it and returns that codepoint. The mirror of easyUnicode_utf8_codepoint_To_Utf32_codepoint. 
+
+	char *at = text + easyString_codepointToByteOffset(&index, cursor);
+	while(at > text) {
+		unsigned int codepoint = easyUnicode_utf8_previousCodepoint_To_Utf32_codepoint(&at, text);
+		...
+	}
+
+//NOTE: These are codepoints, not grapheme clusters. An emoji with a skin tone or a letter with a combining accent is more than one codepoint.
+
 ////////////////////////////////////////////////////////////////////
 
 Examples:
@@ -67,10 +236,11 @@ int main(int argc, char *args[]) {
 
 int main(int argc, char *args[]) {
 
-	int doMatch = easyString_stringsMatch_withCount("გთხოვთ", 6, "გთხო", 4);
+	//NOTE: each of these glyphs is 3 bytes
+	int doMatch = easyString_stringsMatch_withCount("გთხოვთ", 18, "გთხო", 12);
 	//doMatch will return _false_
 
-	int doMatch = easyString_stringsMatch_null_and_count("გთხო", "გთხოვთ", 4);
+	int doMatch = easyString_stringsMatch_null_and_count("გთხო", "გთხოვთ", 12);
 	//doMatch will return _true_
 
 	int doMatch = easyString_stringsMatch_nullTerminated("გთხო", "გთხოვთ");
@@ -102,7 +272,63 @@ int main(int argc, char *args[]) {
 #define EASY_HEADERS_FREE(ptr) free(ptr)
 #endif
 
+#include <stddef.h>
+#include <string.h>
+
+#include "easy_arena.h"
+
 ///////////////////////************ Header definitions start here *************////////////////////
+typedef enum {
+	EASY_STRING_SIMD_NONE = 0,
+	EASY_STRING_SIMD_SSE2,
+	EASY_STRING_SIMD_SSSE3,
+	EASY_STRING_SIMD_AVX2,
+} EasyString_SimdLevel;
+
+typedef enum {
+	EASY_UNICODE_OK = 0, //all the input was converted
+	EASY_UNICODE_OUTPUT_FULL, //ran out of room in dst, call again with more room from codeUnitsConsumed on
+	EASY_UNICODE_NEED_MORE_INPUT, //src ended part way through a codepoint
+	EASY_UNICODE_INVALID, //hit malformed input, codeUnitsConsumed is where it starts
+} EasyUnicode_Status;
+
+typedef enum {
+	EASY_UNICODE_ERROR_NONE = 0,
+	EASY_UNICODE_ERROR_UNEXPECTED_CONTINUATION, //continuation byte where a codepoint should start
+	EASY_UNICODE_ERROR_INVALID_BYTE, //0xF5-0xFF, these never appear in utf8
+	EASY_UNICODE_ERROR_MISSING_CONTINUATION, //sequence cut short by a byte that isn't a continuation byte
+	EASY_UNICODE_ERROR_OVERLONG, //used more bytes than the codepoint needs (includes 0xC0 and 0xC1)
+	EASY_UNICODE_ERROR_SURROGATE, //U+D800 to U+DFFF
+	EASY_UNICODE_ERROR_TOO_LARGE, //above U+10FFFF
+	EASY_UNICODE_ERROR_TRUNCATED, //input ended part way through a codepoint
+} EasyUnicode_Error;
+
+typedef enum {
+	EASY_UNICODE_STOP_ON_INVALID = 0,
+	EASY_UNICODE_REPLACE_INVALID, //write U+FFFD and keep going
+} EasyUnicode_InvalidPolicy;
+
+#define EASY_UNICODE_REPLACEMENT_CHARACTER 0xFFFD
+
+typedef struct {
+	size_t codeUnitsWritten;
+	size_t codeUnitsConsumed; //in the source's units: bytes for utf8, 16 bit units for utf16, 32 bit for utf32
+	EasyUnicode_Status status;
+	EasyUnicode_Error error; //only set by the validating functions
+} EasyUnicode_Result;
+
+typedef struct {
+	int valid;
+	EasyUnicode_Error error;
+	size_t errorOffset; //byte offset of the start of the bad sequence
+} EasyString_Utf8Validation;
+
+//NOTE: holds the start of a codepoint that got cut off at the end of a chunk
+typedef struct {
+	unsigned char pending[4];
+	int pendingCount;
+} EasyUnicode_DecodeState;
+
 int easyUnicode_isContinuationByte(unsigned char byte);
 int easyUnicode_isSingleByte(unsigned char byte);
 int easyUnicode_isLeadingByte(unsigned char byte);
@@ -114,14 +340,287 @@ int easyString_getSizeInBytes_utf8(char *string);
 
 int easyString_getStringLength_utf8(char *string);
 
+size_t easyString_byteLength_utf8(char *string);
+size_t easyString_codepointCount_utf8(char *string, size_t byteCount);
+size_t easyString_codepointCount_nullTerminated(char *string);
+size_t easyString_codepointByteOffset_utf8(char *string, size_t byteCount, size_t codepoint);
+
 unsigned int *easyUnicode_utf8StreamToUtf32Stream_allocates(char *stream);
+unsigned int *easyUnicode_utf8StreamToUtf32Stream_arena(EasyArena *arena, char *stream);
 
 void easyString_free_Utf32_string(char *string);
 
+EasyUnicode_Result easyUnicode_utf8ToUtf32(char *src, size_t srcLen, unsigned int *dst, size_t dstCap);
+size_t easyUnicode_utf8ToUtf32_requiredSize(char *src, size_t srcLen);
+
+void easyUnicode_initDecodeState(EasyUnicode_DecodeState *state);
+EasyUnicode_Result easyUnicode_utf8ToUtf32_stream(EasyUnicode_DecodeState *state, char *src, size_t srcLen, unsigned int *dst, size_t dstCap);
+
+EasyString_Utf8Validation easyString_validate_utf8(char *ptr, size_t len);
+EasyUnicode_Result easyUnicode_utf8ToUtf32_validating(char *src, size_t srcLen, unsigned int *dst, size_t dstCap, EasyUnicode_InvalidPolicy policy);
+unsigned int easyUnicode_utf8_codepoint_To_Utf32_codepoint_validated(char **streamPtr, char *streamEnd, EasyUnicode_Error *error);
+
+EasyUnicode_Result easyUnicode_utf32ToUtf8(unsigned int *src, size_t srcLen, char *dst, size_t dstCap, EasyUnicode_InvalidPolicy policy);
+EasyUnicode_Result easyUnicode_utf16ToUtf8(unsigned short *src, size_t srcLen, char *dst, size_t dstCap, EasyUnicode_InvalidPolicy policy);
+EasyUnicode_Result easyUnicode_utf8ToUtf16(char *src, size_t srcLen, unsigned short *dst, size_t dstCap, EasyUnicode_InvalidPolicy policy);
+EasyUnicode_Result easyUnicode_utf16ToUtf32(unsigned short *src, size_t srcLen, unsigned int *dst, size_t dstCap, EasyUnicode_InvalidPolicy policy);
+EasyUnicode_Result easyUnicode_utf32ToUtf16(unsigned int *src, size_t srcLen, unsigned short *dst, size_t dstCap, EasyUnicode_InvalidPolicy policy);
+size_t easyUnicode_utf32ToUtf8_requiredSize(unsigned int *src, size_t srcLen);
+size_t easyUnicode_utf16ToUtf8_requiredSize(unsigned short *src, size_t srcLen);
+size_t easyUnicode_utf8ToUtf16_requiredSize(char *src, size_t srcLen);
+size_t easyUnicode_utf16ToUtf32_requiredSize(unsigned short *src, size_t srcLen);
+size_t easyUnicode_utf32ToUtf16_requiredSize(unsigned int *src, size_t srcLen);
+
+EasyString_SimdLevel easyString_getSimdLevel(void);
+void easyString_setSimdLevel(EasyString_SimdLevel level);
+
 int easyString_stringsMatch_withCount(char *a, int aLength, char *b, int bLength);
 int easyString_stringsMatch_null_and_count(char *a, char *b, int bLen);
 int easyString_stringsMatch_nullTerminated(char *a, char *b);
 
+int easyString_compare(char *a, size_t aLength, char *b, size_t bLength);
+int easyString_compare_nullTerminated(char *a, char *b);
+
+typedef struct {
+	unsigned int id; //0 for an empty slot
+	unsigned int hash;
+} EasyString_InternSlot;
+
+typedef struct {
+	char *string; //null terminated copy owned by the table
+	unsigned int length;
+	unsigned int hash;
+} EasyString_InternEntry;
+
+typedef struct EasyString_InternBlock EasyString_InternBlock;
+struct EasyString_InternBlock {
+	EasyString_InternBlock *next;
+	size_t used;
+	size_t size;
+	//NOTE: string bytes follow the header
+};
+
+typedef struct {
+	//NOTE: open addressing with linear probing, the hash lives in the slot so a probe only touches the string when the hashes match
+	EasyString_InternSlot *slots;
+	unsigned int slotCount; //power of two
+	
+	EasyString_InternEntry *entries; //id - 1 indexes this
+	unsigned int entryCount;
+	unsigned int entryCapacity;
+
+	EasyString_InternBlock *blocks; //string storage, only ever appended to so strings never move
+	int frozen;
+} EasyString_InternTable;
+
+void easyString_initInternTable(EasyString_InternTable *table, unsigned int expectedCount);
+void easyString_freeInternTable(EasyString_InternTable *table);
+unsigned int easyString_intern(EasyString_InternTable *table, char *string, size_t length);
+unsigned int easyString_intern_nullTerminated(EasyString_InternTable *table, char *string);
+unsigned int easyString_internFind(EasyString_InternTable *table, char *string, size_t length);
+void easyString_internMany(EasyString_InternTable *table, char **strings, size_t *lengths, size_t count, unsigned int *idsOut);
+char *easyString_internString(EasyString_InternTable *table, unsigned int id, size_t *length);
+void easyString_freezeInternTable(EasyString_InternTable *table);
+
+unsigned long long easyString_hash64(char *string, size_t length, unsigned long long seed);
+
+unsigned int easyUnicode_utf8_previousCodepoint_To_Utf32_codepoint(char **streamPtr, char *streamStart);
+
+typedef struct {
+	size_t codepoint;
+	size_t byte; //where that codepoint starts
+} EasyString_CodepointSample;
+
+typedef struct {
+	char *string; //not owned
+	size_t byteCount;
+	size_t codepointCount;
+
+	//NOTE: samples[0] is always codepoint 0. Straight after building, samples[i] is codepoint i*sampleEvery. 
+	//Edits move samples around, but they stay in order and never more than 2*sampleEvery codepoints apart.
+	EasyString_CodepointSample *samples;
+	size_t sampleCount;
+	size_t sampleCapacity;
+	unsigned int sampleEvery;
+	unsigned int sampleShift;
+} EasyString_CodepointIndex;
+
+void easyString_initCodepointIndex(EasyString_CodepointIndex *index, char *string, size_t byteCount, unsigned int sampleEvery);
+void easyString_freeCodepointIndex(EasyString_CodepointIndex *index);
+size_t easyString_codepointToByteOffset(EasyString_CodepointIndex *index, size_t codepoint);
+size_t easyString_byteOffsetToCodepoint(EasyString_CodepointIndex *index, size_t byteOffset);
+char *easyString_sliceCodepoints(EasyString_CodepointIndex *index, size_t codepointStart, size_t codepointEnd, size_t *byteLength);
+void easyString_codepointIndexInsert(EasyString_CodepointIndex *index, char *newString, size_t byteOffset, size_t insertedByteCount);
+void easyString_codepointIndexRemove(EasyString_CodepointIndex *index, size_t byteOffset, size_t removedByteCount);
+
+///////////////////////*********** Hash (shared by the runtime and compile time versions) **************////////////////////
+
+#if defined(__cplusplus) && (__cplusplus >= 201402L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201402L))
+#define EASY_STRING_CONSTEXPR constexpr
+#define EASY_STRING_CONSTEXPR_DATA constexpr
+#else
+#define EASY_STRING_CONSTEXPR
+#define EASY_STRING_CONSTEXPR_DATA const
+#endif
+
+#define EASY_STRING_HASH_P0 0xa0761d6478bd642fULL
+#define EASY_STRING_HASH_P1 0xe7037ed1a0b428dbULL
+#define EASY_STRING_HASH_P2 0x8ebc6af09c88c6e3ULL
+#define EASY_STRING_HASH_P3 0x589965cc75374cc3ULL
+
+//NOTE: keys for the long input accumulator. 8 per stripe, sliding along by one each stripe, the last 8 scramble the accumulators every 16 stripes
+static EASY_STRING_CONSTEXPR_DATA unsigned long long easyString_hashSecret_[24] = {
+	0xc0e16b163a85a4dcULL, 0x890acd8dd443c47cULL, 0xb3889d8a6dc47761ULL, 0x6a0398e528f0ae6aULL,
+	0x048344ece48a855eULL, 0xf175cfea21871330ULL, 0x391ceef02702c2fdULL, 0x4baf8cac4784cb12ULL,
+	0x3547744583a3f88eULL, 0xd9cf2b15c6b6c90eULL, 0x961facc76d5fe21cULL, 0x0094ab49d50f11f9ULL,
+	0xe3211e37bdbeb6dcULL, 0x62fe6c274ff3511aULL, 0x5ac30b329fdf0574ULL, 0x1450582c6b65b406ULL,
+	0x7a30fcc7888eb791ULL, 0x5540f5ba6a15576eULL, 0x16cef0559096d3e9ULL, 0x2cf8f14b06874899ULL,
+	0xc9c9263b6e2ce103ULL, 0xd6ff920b0a9faa6dULL, 0x53192697db998dc1ULL, 0x73ea9b9bc7cd18d7ULL,
+};
+
+//NOTE: little endian reads built from bytes so they also work at compile time. Compilers turn these into single loads.
+EASY_STRING_CONSTEXPR inline static unsigned long long easyString_hashRead64_(const char *p) {
+	return ((unsigned long long)(unsigned char)p[0]) | ((unsigned long long)(unsigned char)p[1] << 8) | 
+	       ((unsigned long long)(unsigned char)p[2] << 16) | ((unsigned long long)(unsigned char)p[3] << 24) | 
+	       ((unsigned long long)(unsigned char)p[4] << 32) | ((unsigned long long)(unsigned char)p[5] << 40) | 
+	       ((unsigned long long)(unsigned char)p[6] << 48) | ((unsigned long long)(unsigned char)p[7] << 56);
+}
+
+EASY_STRING_CONSTEXPR inline static unsigned long long easyString_hashRead32_(const char *p) {
+	return ((unsigned long long)(unsigned char)p[0]) | ((unsigned long long)(unsigned char)p[1] << 8) | 
+	       ((unsigned long long)(unsigned char)p[2] << 16) | ((unsigned long long)(unsigned char)p[3] << 24);
+}
+
+//NOTE: full 64x64 -> 128 bit multiply
+EASY_STRING_CONSTEXPR inline static void easyString_hashMul128_(unsigned long long *a, unsigned long long *b) {
+#if defined(__SIZEOF_INT128__)
+	__extension__ unsigned __int128 r = (unsigned __int128)(*a) * (*b);
+	*a = (unsigned long long)r;
+	*b = (unsigned long long)(r >> 64);
+#else
+	unsigned long long ha = *a >> 32, hb = *b >> 32, la = (unsigned int)*a, lb = (unsigned int)*b;
+	unsigned long long rh = ha*hb, rm0 = ha*lb, rm1 = hb*la, rl = la*lb;
+	unsigned long long t = rl + (rm0 << 32);
+	unsigned long long c = t < rl;
+	unsigned long long lo = t + (rm1 << 32);
+	c += lo < t;
+	*a = lo;
+	*b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+EASY_STRING_CONSTEXPR inline static unsigned long long easyString_hashMix_(unsigned long long a, unsigned long long b) {
+	easyString_hashMul128_(&a, &b);
+	return a ^ b;
+}
+
+//NOTE: one 64 byte stripe into the 8 accumulators. Each lane multiplies the low and high halves of (data ^ key), and the raw data goes into the neighbouring lane
+EASY_STRING_CONSTEXPR inline static void easyString_hashAccumulate_(unsigned long long *acc, const char *stripe, int keyOffset) {
+	for(int i = 0; i < 8; ++i) {
+		unsigned long long data = easyString_hashRead64_(stripe + 8*i);
+		unsigned long long key = data ^ easyString_hashSecret_[keyOffset + i];
+		acc[i ^ 1] += data;
+		acc[i] += (key & 0xFFFFFFFFULL) * (key >> 32);
+	}
+}
+
+EASY_STRING_CONSTEXPR inline static void easyString_hashScramble_(unsigned long long *acc) {
+	for(int i = 0; i < 8; ++i) {
+		acc[i] ^= acc[i] >> 47;
+		acc[i] ^= easyString_hashSecret_[16 + i];
+		acc[i] *= 0x9E3779B1ULL;
+	}
+}
+
+EASY_STRING_CONSTEXPR inline static void easyString_hashInitAccumulators_(unsigned long long *acc, unsigned long long seed) {
+	for(int i = 0; i < 8; ++i) { acc[i] = easyString_hashSecret_[i] ^ seed; }
+}
+
+EASY_STRING_CONSTEXPR inline static unsigned long long easyString_hashMergeAccumulators_(unsigned long long *acc) {
+	unsigned long long result = 0;
+	for(int i = 0; i < 4; ++i) {
+		result += easyString_hashMix_(acc[2*i] ^ easyString_hashSecret_[8 + 2*i], acc[2*i + 1] ^ easyString_hashSecret_[9 + 2*i]);
+	}
+	return result;
+}
+
+EASY_STRING_CONSTEXPR inline static unsigned long long easyString_hashLong_scalar_(const char *p, size_t len, unsigned long long seed) {
+	unsigned long long acc[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+	easyString_hashInitAccumulators_(acc, seed);
+	size_t stripes = (len - 1) / 64; //the last stripe is always done separately, overlapping the one before
+	for(size_t n = 0; n < stripes; ++n) {
+		easyString_hashAccumulate_(acc, p + 64*n, (int)(n % 16));
+		if(n % 16 == 15) { easyString_hashScramble_(acc); }
+	}
+	easyString_hashAccumulate_(acc, p + len - 64, 7);
+	return easyString_hashMergeAccumulators_(acc);
+}
+
+//NOTE: The seed gets mixed before it's used. That only depends on the seed, so the usual seed of 0 is worked out here instead of on every call.
+#define EASY_STRING_HASH_SEED_0 0x1ff5c2923a788d2cULL //easyString_hashMix_(EASY_STRING_HASH_P0, EASY_STRING_HASH_P1)
+
+EASY_STRING_CONSTEXPR inline static unsigned long long easyString_hashSeed_(unsigned long long seed) {
+	return seed ? seed ^ easyString_hashMix_(seed ^ EASY_STRING_HASH_P0, EASY_STRING_HASH_P1) : EASY_STRING_HASH_SEED_0;
+}
+
+//NOTE: Up to 16 bytes. Finishes with the one multiply-mix, seed is already through easyString_hashSeed_ so that's enough for a hash table.
+EASY_STRING_CONSTEXPR inline static unsigned long long easyString_hashShort_(const char *p, size_t len, unsigned long long seed) {
+	unsigned long long a = 0;
+	unsigned long long b = 0;
+	if(len >= 4) {
+		//NOTE: two overlapping 4 byte reads from each end cover every length from 4 to 16
+		size_t mid = (len >> 3) << 2;
+		a = (easyString_hashRead32_(p) << 32) | easyString_hashRead32_(p + mid);
+		b = (easyString_hashRead32_(p + len - 4) << 32) | easyString_hashRead32_(p + len - 4 - mid);
+	} else if(len > 0) {
+		a = ((unsigned long long)(unsigned char)p[0] << 16) | ((unsigned long long)(unsigned char)p[len >> 1] << 8) | (unsigned long long)(unsigned char)p[len - 1];
+		b = a; //so both sides of the multiply change, not just one
+	}
+	return easyString_hashMix_(a ^ EASY_STRING_HASH_P1 ^ len, b ^ seed);
+}
+
+//NOTE: Longer than 16 bytes. The long input accumulator is passed in already done (longHash) when len > 256.
+EASY_STRING_CONSTEXPR inline static unsigned long long easyString_hash64_finish_(const char *p, size_t len, unsigned long long seed, unsigned long long longHash) {
+	seed = easyString_hashSeed_(seed);
+	if(len <= 256) {
+		size_t i = len;
+		const char *at = p;
+		if(i > 48) {
+			unsigned long long see1 = seed;
+			unsigned long long see2 = seed;
+			do {
+				seed = easyString_hashMix_(easyString_hashRead64_(at) ^ EASY_STRING_HASH_P1, easyString_hashRead64_(at + 8) ^ seed);
+				see1 = easyString_hashMix_(easyString_hashRead64_(at + 16) ^ EASY_STRING_HASH_P2, easyString_hashRead64_(at + 24) ^ see1);
+				see2 = easyString_hashMix_(easyString_hashRead64_(at + 32) ^ EASY_STRING_HASH_P3, easyString_hashRead64_(at + 40) ^ see2);
+				at += 48;
+				i -= 48;
+			} while(i > 48);
+			seed ^= see1 ^ see2;
+		}
+		while(i > 16) {
+			seed = easyString_hashMix_(easyString_hashRead64_(at) ^ EASY_STRING_HASH_P1, easyString_hashRead64_(at + 8) ^ seed);
+			at += 16;
+			i -= 16;
+		}
+	} else {
+		seed ^= longHash;
+	}
+	unsigned long long a = easyString_hashRead64_(p + len - 16);
+	unsigned long long b = easyString_hashRead64_(p + len - 8);
+	a ^= EASY_STRING_HASH_P1;
+	b ^= seed;
+	easyString_hashMul128_(&a, &b);
+	return easyString_hashMix_(a ^ EASY_STRING_HASH_P0 ^ len, b ^ EASY_STRING_HASH_P1);
+}
+
+#if defined(__cplusplus) && (__cplusplus >= 201402L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201402L))
+constexpr inline static unsigned long long easyString_hash64_constexpr(const char *string, size_t length, unsigned long long seed) {
+	return (length <= 16) ? easyString_hashShort_(string, length, easyString_hashSeed_(seed)) : 
+		easyString_hash64_finish_(string, length, seed, (length > 256) ? easyString_hashLong_scalar_(string, length, seed) : 0);
+}
+#define EASY_STRING_HASH_LITERAL(literal, seed) easyString_hash64_constexpr(literal, sizeof(literal) - 1, seed)
+#endif
+
 
 ///////////////////////*********** Implementation starts here **************////////////////////
 
@@ -161,7 +660,7 @@ int easyUnicode_unicodeLength(unsigned char byte) {
 	unsigned char shiftedByte = byte >> 4;
 	if(!easyUnicode_isContinuationByte(byte) && !easyUnicode_isSingleByte(byte)) {
 		EASY_HEADERS_ASSERT(easyUnicode_isLeadingByte(byte));
-		if(shiftedByte == bytes2) { result = 2; }
+		if(shiftedByte == bytes2 || shiftedByte == (bytes2 | 1 << 0)) { result = 2; } //110x, both 0xC_ and 0xD_ start a two byte sequence
 		if(shiftedByte == bytes3) { result = 3; }
 		if(shiftedByte == bytes4) { result = 4; }
 		if(result == 1) EASY_HEADERS_ASSERT(!"invalid path");
@@ -177,7 +676,7 @@ unsigned int easyUnicode_utf8_codepoint_To_Utf32_codepoint(char **streamPtr, int
 	unsigned int result = 0;
 	unsigned int sixBitsFull = (1 << 5 | 1 << 4 | 1 << 3 | 1 << 2 | 1 << 1 | 1 << 0);
 	unsigned int fiveBitsFull = (1 << 4 | 1 << 3 | 1 << 2 | 1 << 1 | 1 << 0);
-	unsigned int fourBitsFull = (1 << 3 | 1 << 2 | 1 << 1 | 1 << 0);
+	unsigned int threeBitsFull = (1 << 2 | 1 << 1 | 1 << 0);
 
 	if(easyUnicode_isContinuationByte(stream[0])) { EASY_HEADERS_ASSERT(!"shouldn't be a continuation byte. Have you advanced pointer correctly?"); }
 	int unicodeLen = easyUnicode_unicodeLength(stream[0]);
@@ -217,10 +716,10 @@ unsigned int easyUnicode_utf8_codepoint_To_Utf32_codepoint(char **streamPtr, int
 				EASY_HEADERS_ASSERT(easyUnicode_isContinuationByte(secondByte));
 				EASY_HEADERS_ASSERT(easyUnicode_isContinuationByte(thirdByte));
 				EASY_HEADERS_ASSERT(easyUnicode_isContinuationByte(fourthByte));
-				result |= (thirdByte & sixBitsFull);
-				result |= ((secondByte & sixBitsFull) << 6);
-				result |= ((firstByte & sixBitsFull) << 12);
-				result |= ((firstByte & fourBitsFull) << 18);
+				result |= (fourthByte & sixBitsFull);
+				result |= ((thirdByte & sixBitsFull) << 6);
+				result |= ((secondByte & sixBitsFull) << 12);
+				result |= ((firstByte & threeBitsFull) << 18);
 
 				if(advancePtr) (*streamPtr) += 4;
 			} break;
@@ -238,73 +737,2533 @@ unsigned int easyUnicode_utf8_codepoint_To_Utf32_codepoint(char **streamPtr, int
 
 
 int easyString_getSizeInBytes_utf8(char *string) {
-    unsigned int result = 0;
-    unsigned char *at = (char *)string;
-    while(*at) {
-        result++;
-        at++;
-    }
-    return result;
+	size_t result = easyString_byteLength_utf8(string);
+	EASY_HEADERS_ASSERT(result <= 0x7FFFFFFF); //NOTE: use easyString_byteLength_utf8 for strings this big
+	return (int)result;
 }
 
 int easyString_getStringLength_utf8(char *string) {
-    unsigned int result = 0;
-    unsigned char *at = (char *)string;
-    while(*at) {
-        easyUnicode_utf8_codepoint_To_Utf32_codepoint((char **)&at, 1);
-        result++;
-    }
-    return result;
+	size_t result = easyString_codepointCount_nullTerminated(string);
+	EASY_HEADERS_ASSERT(result <= 0x7FFFFFFF);
+	return (int)result;
+}
+
+
+///////////////////////*********** Bulk utf8 -> utf32 **************////////////////////
+
+#if !defined(EASY_STRING_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86))
+#define EASY_STRING_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#define EASY_STRING_TARGET(isa)
+#else
+#define EASY_STRING_TARGET(isa) __attribute__((target(isa)))
+#endif
+#else
+#define EASY_STRING_X86 0
+#endif
+
+//NOTE: The 16 byte helpers get forced inline so the avx2 loop doesn't switch between sse and avx encodings on every call
+#if defined(_MSC_VER) && !defined(__clang__)
+#define EASY_STRING_FORCE_INLINE __forceinline
+#else
+#define EASY_STRING_FORCE_INLINE inline __attribute__((always_inline))
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+//NOTE: index of the lowest set bit. x can't be 0
+inline static int easyString_ctz32(unsigned int x) {
+#if defined(_MSC_VER) && !defined(__clang__)
+	unsigned long index;
+	_BitScanForward(&index, x);
+	return (int)index;
+#else
+	return __builtin_ctz(x);
+#endif
+}
+
+inline static int easyString_popcount32(unsigned int x) {
+	//NOTE: bit trick instead of the popcnt instruction, which SSE2-only cpus don't have
+	x = x - ((x >> 1) & 0x55555555);
+	x = (x & 0x33333333) + ((x >> 2) & 0x33333333);
+	x = (x + (x >> 4)) & 0x0F0F0F0F;
+	return (int)((x*0x01010101) >> 24);
+}
+
+inline static int easyString_ctz64(unsigned long long x) {
+#if defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64)
+	unsigned long index;
+	_BitScanForward64(&index, x);
+	return (int)index;
+#elif defined(_MSC_VER) && !defined(__clang__)
+	unsigned int low = (unsigned int)x;
+	return low ? easyString_ctz32(low) : 32 + easyString_ctz32((unsigned int)(x >> 32));
+#else
+	return __builtin_ctzll(x);
+#endif
+}
+
+//NOTE: The word at a time paths need to know which end the first byte is at
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define EASY_STRING_LITTLE_ENDIAN 0
+#else
+#define EASY_STRING_LITTLE_ENDIAN 1
+#endif
+
+//NOTE: The null terminated simd paths read whole blocks that can go past the terminator (never past the end of a page so they can't fault).
+//That's fine for the hardware but address sanitizer would report it.
+#if defined(__clang__) || defined(__GNUC__)
+#define EASY_STRING_NO_SANITIZE __attribute__((no_sanitize_address))
+#else
+#define EASY_STRING_NO_SANITIZE
+#endif
+#define EASY_STRING_PAGE_SIZE 4096
+
+static int easyString_simdLevel_ = -1; //-1 means we haven't looked at the cpu yet
+
+static EasyString_SimdLevel easyString_detectSimdLevel(void) {
+	EasyString_SimdLevel result = EASY_STRING_SIMD_NONE;
+#if EASY_STRING_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+	int info[4];
+	__cpuid(info, 0);
+	int maxLeaf = info[0];
+	__cpuid(info, 1);
+	if(info[3] & (1 << 26)) { result = EASY_STRING_SIMD_SSE2; }
+	if(info[2] & (1 << 9)) { result = EASY_STRING_SIMD_SSSE3; }
+	//NOTE: avx2 also needs the os to save the ymm registers (osxsave + xgetbv)
+	int osSavesYmm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && ((_xgetbv(0) & 6) == 6);
+	if(osSavesYmm && maxLeaf >= 7) {
+		__cpuidex(info, 7, 0);
+		if(info[1] & (1 << 5)) { result = EASY_STRING_SIMD_AVX2; }
+	}
+#else
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("sse2")) { result = EASY_STRING_SIMD_SSE2; }
+	if(__builtin_cpu_supports("ssse3")) { result = EASY_STRING_SIMD_SSSE3; }
+	if(__builtin_cpu_supports("avx2")) { result = EASY_STRING_SIMD_AVX2; }
+#endif
+#endif
+	return result;
+}
+
+EasyString_SimdLevel easyString_getSimdLevel(void) {
+	if(easyString_simdLevel_ < 0) {
+		easyString_simdLevel_ = (int)easyString_detectSimdLevel();
+	}
+	return (EasyString_SimdLevel)easyString_simdLevel_;
+}
+
+void easyString_setSimdLevel(EasyString_SimdLevel level) {
+	//NOTE: Can't go higher than what the cpu actually supports
+	EasyString_SimdLevel supported = easyString_detectSimdLevel();
+	if(level > supported) { level = supported; }
+	easyString_simdLevel_ = (int)level;
+}
+
+///////////////////////*********** Counting codepoints **************////////////////////
+
+//NOTE: Cheaper than decoding, every codepoint has exactly one byte that isn't a continuation byte.
+//Only right for valid utf8, the decoder will still assert on anything else.
+static size_t easyUnicode_countCodepoints_scalar(unsigned char *src, size_t len) {
+	size_t count = 0;
+	size_t i = 0;
+	//NOTE: 8 bytes at a time. A byte starts a codepoint if bit 7 is clear or bit 6 is set, the multiply adds up the 8 top bits
+	for(; i + 8 <= len; i += 8) {
+		unsigned long long x;
+		memcpy(&x, src + i, 8);
+		unsigned long long starts = ((~x | (x << 1)) & 0x8080808080808080ULL) >> 7;
+		count += (size_t)((starts*0x0101010101010101ULL) >> 56);
+	}
+	for(; i < len; ++i) {
+		count += ((src[i] & 0xC0) != 0x80);
+	}
+	return count;
+}
+
+//NOTE: mask has a bit set for every codepoint start in the block at src + i. Writes the samples that land in it, at most room of them.
+inline static size_t easyString_sampleCodepointsInMask_(unsigned int mask, size_t i, size_t *count, size_t *nextSample, size_t sampleEvery, size_t baseByte, size_t baseCodepoint, EasyString_CodepointSample *out, size_t room) {
+	size_t written = 0;
+	size_t blockCount = (size_t)easyString_popcount32(mask);
+	while(written < room && *count + blockCount > *nextSample) {
+		//NOTE: drop the starts before the sample, the lowest one left is it
+		for(size_t skip = *nextSample - *count; skip > 0; --skip) { mask &= mask - 1; }
+		out[written].codepoint = baseCodepoint + *nextSample;
+		out[written].byte = baseByte + i + (size_t)easyString_ctz32(mask);
+		written++;
+		mask &= mask - 1;
+		blockCount -= (*nextSample - *count) + 1;
+		*count = *nextSample + 1;
+		*nextSample += sampleEvery;
+	}
+	*count += blockCount;
+	return written;
+}
+
+//NOTE: Writes a sample (codepoint and byte offset) at codepoint nextSample, nextSample + sampleEvery, ... counting from the start of src, 
+//until it has written maxSamples. Returns the number written. codepointCount is the codepoints counted, which is all of src unless it stopped early.
+static size_t easyString_sampleCodepoints_scalar(unsigned char *src, size_t len, size_t nextSample, size_t sampleEvery, size_t baseByte, size_t baseCodepoint, EasyString_CodepointSample *out, size_t maxSamples, size_t *codepointCount) {
+	size_t count = 0;
+	size_t written = 0;
+	size_t i = 0;
+#if EASY_STRING_LITTLE_ENDIAN
+	//NOTE: same bit trick as counting, then the top bits get gathered into an 8 bit mask
+	for(; i + 8 <= len && written < maxSamples; i += 8) {
+		unsigned long long x;
+		memcpy(&x, src + i, 8);
+		unsigned long long starts = (~x | (x << 1)) & 0x8080808080808080ULL;
+		unsigned int mask = (unsigned int)(((starts >> 7)*0x0102040810204080ULL) >> 56);
+		written += easyString_sampleCodepointsInMask_(mask, i, &count, &nextSample, sampleEvery, baseByte, baseCodepoint, out + written, maxSamples - written);
+	}
+#endif
+	for(; i < len && written < maxSamples; ++i) {
+		if((src[i] & 0xC0) != 0x80) {
+			if(count == nextSample) {
+				out[written].codepoint = baseCodepoint + count;
+				out[written].byte = baseByte + i;
+				written++;
+				nextSample += sampleEvery;
+			}
+			count++;
+		}
+	}
+	*codepointCount = count;
+	return written;
+}
+
+#if EASY_STRING_X86
+
+EASY_STRING_TARGET("sse2") static size_t easyUnicode_countCodepoints_sse2(unsigned char *src, size_t len) {
+	__m128i lastContinuation = _mm_set1_epi8((char)0xBF);
+	__m128i total = _mm_setzero_si128();
+	size_t i = 0;
+	while(i + 16 <= len) {
+		//NOTE: compares give -1 per codepoint start, add them up bytewise and only widen every 255 blocks
+		__m128i partial = _mm_setzero_si128();
+		for(int j = 0; j < 255 && i + 16 <= len; ++j, i += 16) {
+			__m128i in = _mm_loadu_si128((__m128i *)(src + i));
+			partial = _mm_sub_epi8(partial, _mm_cmpgt_epi8(in, lastContinuation));
+		}
+		total = _mm_add_epi64(total, _mm_sad_epu8(partial, _mm_setzero_si128()));
+	}
+	unsigned long long lanes[2];
+	_mm_storeu_si128((__m128i *)lanes, total);
+	size_t count = (size_t)(lanes[0] + lanes[1]);
+	return count + easyUnicode_countCodepoints_scalar(src + i, len - i);
+}
+
+EASY_STRING_TARGET("avx2") static size_t easyUnicode_countCodepoints_avx2(unsigned char *src, size_t len) {
+	__m256i lastContinuation = _mm256_set1_epi8((char)0xBF);
+	__m256i total = _mm256_setzero_si256();
+	size_t i = 0;
+	while(i + 32 <= len) {
+		__m256i partial = _mm256_setzero_si256();
+		for(int j = 0; j < 255 && i + 32 <= len; ++j, i += 32) {
+			__m256i in = _mm256_loadu_si256((__m256i *)(src + i));
+			partial = _mm256_sub_epi8(partial, _mm256_cmpgt_epi8(in, lastContinuation));
+		}
+		total = _mm256_add_epi64(total, _mm256_sad_epu8(partial, _mm256_setzero_si256()));
+	}
+	unsigned long long lanes[4];
+	_mm256_storeu_si256((__m256i *)lanes, total);
+	size_t count = (size_t)(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+	return count + easyUnicode_countCodepoints_scalar(src + i, len - i);
+}
+
+EASY_STRING_TARGET("sse2") static size_t easyString_sampleCodepoints_sse2(unsigned char *src, size_t len, size_t nextSample, size_t sampleEvery, size_t baseByte, size_t baseCodepoint, EasyString_CodepointSample *out, size_t maxSamples, size_t *codepointCount) {
+	size_t count = 0;
+	size_t written = 0;
+	size_t i = 0;
+	__m128i lastContinuation = _mm_set1_epi8((char)0xBF);
+	for(; i + 16 <= len && written < maxSamples; i += 16) {
+		__m128i in = _mm_loadu_si128((__m128i *)(src + i));
+		unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_cmpgt_epi8(in, lastContinuation));
+		written += easyString_sampleCodepointsInMask_(mask, i, &count, &nextSample, sampleEvery, baseByte, baseCodepoint, out + written, maxSamples - written);
+	}
+	if(written < maxSamples) {
+		size_t tailCount = 0;
+		written += easyString_sampleCodepoints_scalar(src + i, len - i, nextSample - count, sampleEvery, baseByte + i, baseCodepoint + count, out + written, maxSamples - written, &tailCount);
+		count += tailCount;
+	}
+	*codepointCount = count;
+	return written;
+}
+
+EASY_STRING_TARGET("avx2") static size_t easyString_sampleCodepoints_avx2(unsigned char *src, size_t len, size_t nextSample, size_t sampleEvery, size_t baseByte, size_t baseCodepoint, EasyString_CodepointSample *out, size_t maxSamples, size_t *codepointCount) {
+	size_t count = 0;
+	size_t written = 0;
+	size_t i = 0;
+	__m256i lastContinuation = _mm256_set1_epi8((char)0xBF);
+	//NOTE: while the next sample is far off there's no need for masks, just count 128 bytes at a time (can't be more than 128 codepoints in them)
+	while(i + 128 <= len && nextSample - count >= 128) {
+		__m256i partial = _mm256_setzero_si256();
+		for(int j = 0; j < 4; ++j) {
+			partial = _mm256_sub_epi8(partial, _mm256_cmpgt_epi8(_mm256_loadu_si256((__m256i *)(src + i + 32*j)), lastContinuation));
+		}
+		__m256i sum = _mm256_sad_epu8(partial, _mm256_setzero_si256());
+		__m128i sum128 = _mm_add_epi64(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+		count += (size_t)_mm_cvtsi128_si32(_mm_add_epi64(sum128, _mm_unpackhi_epi64(sum128, sum128)));
+		i += 128;
+	}
+	for(; i + 32 <= len && written < maxSamples; i += 32) {
+		__m256i in = _mm256_loadu_si256((__m256i *)(src + i));
+		unsigned int mask = (unsigned int)_mm256_movemask_epi8(_mm256_cmpgt_epi8(in, lastContinuation));
+		written += easyString_sampleCodepointsInMask_(mask, i, &count, &nextSample, sampleEvery, baseByte, baseCodepoint, out + written, maxSamples - written);
+	}
+	if(written < maxSamples) {
+		size_t tailCount = 0;
+		written += easyString_sampleCodepoints_scalar(src + i, len - i, nextSample - count, sampleEvery, baseByte + i, baseCodepoint + count, out + written, maxSamples - written, &tailCount);
+		count += tailCount;
+	}
+	*codepointCount = count;
+	return written;
+}
+
+#endif // EASY_STRING_X86
+
+static size_t easyUnicode_countCodepoints_(unsigned char *src, size_t len) {
+#if EASY_STRING_X86
+	EasyString_SimdLevel level = easyString_getSimdLevel();
+	if(level >= EASY_STRING_SIMD_AVX2) { return easyUnicode_countCodepoints_avx2(src, len); }
+	if(level >= EASY_STRING_SIMD_SSE2) { return easyUnicode_countCodepoints_sse2(src, len); }
+#endif
+	return easyUnicode_countCodepoints_scalar(src, len);
+}
+
+static size_t easyString_sampleCodepoints_(unsigned char *src, size_t len, size_t nextSample, size_t sampleEvery, size_t baseByte, size_t baseCodepoint, EasyString_CodepointSample *out, size_t maxSamples, size_t *codepointCount) {
+#if EASY_STRING_X86
+	EasyString_SimdLevel level = easyString_getSimdLevel();
+	if(level >= EASY_STRING_SIMD_AVX2) { return easyString_sampleCodepoints_avx2(src, len, nextSample, sampleEvery, baseByte, baseCodepoint, out, maxSamples, codepointCount); }
+	if(level >= EASY_STRING_SIMD_SSE2) { return easyString_sampleCodepoints_sse2(src, len, nextSample, sampleEvery, baseByte, baseCodepoint, out, maxSamples, codepointCount); }
+#endif
+	return easyString_sampleCodepoints_scalar(src, len, nextSample, sampleEvery, baseByte, baseCodepoint, out, maxSamples, codepointCount);
+}
+
+//NOTE: The scalar path. Works one codepoint at a time and is also used to finish off the tail the simd paths can't do.
+//Stops before a codepoint that runs past the end of src.
+static size_t easyUnicode_utf8ToUtf32_scalar(unsigned char *src, size_t srcLen, unsigned int *dst, size_t dstCap, size_t *srcUsed) {
+	char *at = (char *)src;
+	char *end = (char *)src + srcLen;
+	size_t dstAt = 0;
+	while(at < end && dstAt < dstCap) {
+		if(easyUnicode_unicodeLength((unsigned char)*at) > (end - at)) break;
+		char *a = at;
+		dst[dstAt++] = easyUnicode_utf8_codepoint_To_Utf32_codepoint(&at, 1);
+		EASY_HEADERS_ASSERT(at != a);
+	}
+	*srcUsed = (size_t)(at - (char *)src);
+	return dstAt;
+}
+
+#if EASY_STRING_X86
+
+//NOTE: The number of bytes in a sequence given the top 4 bits of its first byte. 0 for continuation bytes. Same answers as easyUnicode_unicodeLength
+static const unsigned char easyUnicode_utf8LengthTable[16] = { 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 2, 2, 3, 4 };
+
+//NOTE: pshufb masks that put each of the next 4 codepoints into its own 32bit lane, last byte of the sequence in the lowest byte.
+//Index is (len0 - 1) + 3*(len1 - 1) + 9*(len2 - 1) + 27*(len3 - 1) where every length is 1 to 3 bytes. 0x80 zeros the byte.
+static const unsigned char easyUnicode_utf8ShuffleTable[81][16] = {
+	{0x00, 0x80, 0x80, 0x80, 0x01, 0x80, 0x80, 0x80, 0x02, 0x80, 0x80, 0x80, 0x03, 0x80, 0x80, 0x80}, //1111
+	{0x01, 0x00, 0x80, 0x80, 0x02, 0x80, 0x80, 0x80, 0x03, 0x80, 0x80, 0x80, 0x04, 0x80, 0x80, 0x80}, //2111
+	{0x02, 0x01, 0x00, 0x80, 0x03, 0x80, 0x80, 0x80, 0x04, 0x80, 0x80, 0x80, 0x05, 0x80, 0x80, 0x80}, //3111
+	{0x00, 0x80, 0x80, 0x80, 0x02, 0x01, 0x80, 0x80, 0x03, 0x80, 0x80, 0x80, 0x04, 0x80, 0x80, 0x80}, //1211
+	{0x01, 0x00, 0x80, 0x80, 0x03, 0x02, 0x80, 0x80, 0x04, 0x80, 0x80, 0x80, 0x05, 0x80, 0x80, 0x80}, //2211
+	{0x02, 0x01, 0x00, 0x80, 0x04, 0x03, 0x80, 0x80, 0x05, 0x80, 0x80, 0x80, 0x06, 0x80, 0x80, 0x80}, //3211
+	{0x00, 0x80, 0x80, 0x80, 0x03, 0x02, 0x01, 0x80, 0x04, 0x80, 0x80, 0x80, 0x05, 0x80, 0x80, 0x80}, //1311
+	{0x01, 0x00, 0x80, 0x80, 0x04, 0x03, 0x02, 0x80, 0x05, 0x80, 0x80, 0x80, 0x06, 0x80, 0x80, 0x80}, //2311
+	{0x02, 0x01, 0x00, 0x80, 0x05, 0x04, 0x03, 0x80, 0x06, 0x80, 0x80, 0x80, 0x07, 0x80, 0x80, 0x80}, //3311
+	{0x00, 0x80, 0x80, 0x80, 0x01, 0x80, 0x80, 0x80, 0x03, 0x02, 0x80, 0x80, 0x04, 0x80, 0x80, 0x80}, //1121
+	{0x01, 0x00, 0x80, 0x80, 0x02, 0x80, 0x80, 0x80, 0x04, 0x03, 0x80, 0x80, 0x05, 0x80, 0x80, 0x80}, //2121
+	{0x02, 0x01, 0x00, 0x80, 0x03, 0x80, 0x80, 0x80, 0x05, 0x04, 0x80, 0x80, 0x06, 0x80, 0x80, 0x80}, //3121
+	{0x00, 0x80, 0x80, 0x80, 0x02, 0x01, 0x80, 0x80, 0x04, 0x03, 0x80, 0x80, 0x05, 0x80, 0x80, 0x80}, //1221
+	{0x01, 0x00, 0x80, 0x80, 0x03, 0x02, 0x80, 0x80, 0x05, 0x04, 0x80, 0x80, 0x06, 0x80, 0x80, 0x80}, //2221
+	{0x02, 0x01, 0x00, 0x80, 0x04, 0x03, 0x80, 0x80, 0x06, 0x05, 0x80, 0x80, 0x07, 0x80, 0x80, 0x80}, //3221
+	{0x00, 0x80, 0x80, 0x80, 0x03, 0x02, 0x01, 0x80, 0x05, 0x04, 0x80, 0x80, 0x06, 0x80, 0x80, 0x80}, //1321
+	{0x01, 0x00, 0x80, 0x80, 0x04, 0x03, 0x02, 0x80, 0x06, 0x05, 0x80, 0x80, 0x07, 0x80, 0x80, 0x80}, //2321
+	{0x02, 0x01, 0x00, 0x80, 0x05, 0x04, 0x03, 0x80, 0x07, 0x06, 0x80, 0x80, 0x08, 0x80, 0x80, 0x80}, //3321
+	{0x00, 0x80, 0x80, 0x80, 0x01, 0x80, 0x80, 0x80, 0x04, 0x03, 0x02, 0x80, 0x05, 0x80, 0x80, 0x80}, //1131
+	{0x01, 0x00, 0x80, 0x80, 0x02, 0x80, 0x80, 0x80, 0x05, 0x04, 0x03, 0x80, 0x06, 0x80, 0x80, 0x80}, //2131
+	{0x02, 0x01, 0x00, 0x80, 0x03, 0x80, 0x80, 0x80, 0x06, 0x05, 0x04, 0x80, 0x07, 0x80, 0x80, 0x80}, //3131
+	{0x00, 0x80, 0x80, 0x80, 0x02, 0x01, 0x80, 0x80, 0x05, 0x04, 0x03, 0x80, 0x06, 0x80, 0x80, 0x80}, //1231
+	{0x01, 0x00, 0x80, 0x80, 0x03, 0x02, 0x80, 0x80, 0x06, 0x05, 0x04, 0x80, 0x07, 0x80, 0x80, 0x80}, //2231
+	{0x02, 0x01, 0x00, 0x80, 0x04, 0x03, 0x80, 0x80, 0x07, 0x06, 0x05, 0x80, 0x08, 0x80, 0x80, 0x80}, //3231
+	{0x00, 0x80, 0x80, 0x80, 0x03, 0x02, 0x01, 0x80, 0x06, 0x05, 0x04, 0x80, 0x07, 0x80, 0x80, 0x80}, //1331
+	{0x01, 0x00, 0x80, 0x80, 0x04, 0x03, 0x02, 0x80, 0x07, 0x06, 0x05, 0x80, 0x08, 0x80, 0x80, 0x80}, //2331
+	{0x02, 0x01, 0x00, 0x80, 0x05, 0x04, 0x03, 0x80, 0x08, 0x07, 0x06, 0x80, 0x09, 0x80, 0x80, 0x80}, //3331
+	{0x00, 0x80, 0x80, 0x80, 0x01, 0x80, 0x80, 0x80, 0x02, 0x80, 0x80, 0x80, 0x04, 0x03, 0x80, 0x80}, //1112
+	{0x01, 0x00, 0x80, 0x80, 0x02, 0x80, 0x80, 0x80, 0x03, 0x80, 0x80, 0x80, 0x05, 0x04, 0x80, 0x80}, //2112
+	{0x02, 0x01, 0x00, 0x80, 0x03, 0x80, 0x80, 0x80, 0x04, 0x80, 0x80, 0x80, 0x06, 0x05, 0x80, 0x80}, //3112
+	{0x00, 0x80, 0x80, 0x80, 0x02, 0x01, 0x80, 0x80, 0x03, 0x80, 0x80, 0x80, 0x05, 0x04, 0x80, 0x80}, //1212
+	{0x01, 0x00, 0x80, 0x80, 0x03, 0x02, 0x80, 0x80, 0x04, 0x80, 0x80, 0x80, 0x06, 0x05, 0x80, 0x80}, //2212
+	{0x02, 0x01, 0x00, 0x80, 0x04, 0x03, 0x80, 0x80, 0x05, 0x80, 0x80, 0x80, 0x07, 0x06, 0x80, 0x80}, //3212
+	{0x00, 0x80, 0x80, 0x80, 0x03, 0x02, 0x01, 0x80, 0x04, 0x80, 0x80, 0x80, 0x06, 0x05, 0x80, 0x80}, //1312
+	{0x01, 0x00, 0x80, 0x80, 0x04, 0x03, 0x02, 0x80, 0x05, 0x80, 0x80, 0x80, 0x07, 0x06, 0x80, 0x80}, //2312
+	{0x02, 0x01, 0x00, 0x80, 0x05, 0x04, 0x03, 0x80, 0x06, 0x80, 0x80, 0x80, 0x08, 0x07, 0x80, 0x80}, //3312
+	{0x00, 0x80, 0x80, 0x80, 0x01, 0x80, 0x80, 0x80, 0x03, 0x02, 0x80, 0x80, 0x05, 0x04, 0x80, 0x80}, //1122
+	{0x01, 0x00, 0x80, 0x80, 0x02, 0x80, 0x80, 0x80, 0x04, 0x03, 0x80, 0x80, 0x06, 0x05, 0x80, 0x80}, //2122
+	{0x02, 0x01, 0x00, 0x80, 0x03, 0x80, 0x80, 0x80, 0x05, 0x04, 0x80, 0x80, 0x07, 0x06, 0x80, 0x80}, //3122
+	{0x00, 0x80, 0x80, 0x80, 0x02, 0x01, 0x80, 0x80, 0x04, 0x03, 0x80, 0x80, 0x06, 0x05, 0x80, 0x80}, //1222
+	{0x01, 0x00, 0x80, 0x80, 0x03, 0x02, 0x80, 0x80, 0x05, 0x04, 0x80, 0x80, 0x07, 0x06, 0x80, 0x80}, //2222
+	{0x02, 0x01, 0x00, 0x80, 0x04, 0x03, 0x80, 0x80, 0x06, 0x05, 0x80, 0x80, 0x08, 0x07, 0x80, 0x80}, //3222
+	{0x00, 0x80, 0x80, 0x80, 0x03, 0x02, 0x01, 0x80, 0x05, 0x04, 0x80, 0x80, 0x07, 0x06, 0x80, 0x80}, //1322
+	{0x01, 0x00, 0x80, 0x80, 0x04, 0x03, 0x02, 0x80, 0x06, 0x05, 0x80, 0x80, 0x08, 0x07, 0x80, 0x80}, //2322
+	{0x02, 0x01, 0x00, 0x80, 0x05, 0x04, 0x03, 0x80, 0x07, 0x06, 0x80, 0x80, 0x09, 0x08, 0x80, 0x80}, //3322
+	{0x00, 0x80, 0x80, 0x80, 0x01, 0x80, 0x80, 0x80, 0x04, 0x03, 0x02, 0x80, 0x06, 0x05, 0x80, 0x80}, //1132
+	{0x01, 0x00, 0x80, 0x80, 0x02, 0x80, 0x80, 0x80, 0x05, 0x04, 0x03, 0x80, 0x07, 0x06, 0x80, 0x80}, //2132
+	{0x02, 0x01, 0x00, 0x80, 0x03, 0x80, 0x80, 0x80, 0x06, 0x05, 0x04, 0x80, 0x08, 0x07, 0x80, 0x80}, //3132
+	{0x00, 0x80, 0x80, 0x80, 0x02, 0x01, 0x80, 0x80, 0x05, 0x04, 0x03, 0x80, 0x07, 0x06, 0x80, 0x80}, //1232
+	{0x01, 0x00, 0x80, 0x80, 0x03, 0x02, 0x80, 0x80, 0x06, 0x05, 0x04, 0x80, 0x08, 0x07, 0x80, 0x80}, //2232
+	{0x02, 0x01, 0x00, 0x80, 0x04, 0x03, 0x80, 0x80, 0x07, 0x06, 0x05, 0x80, 0x09, 0x08, 0x80, 0x80}, //3232
+	{0x00, 0x80, 0x80, 0x80, 0x03, 0x02, 0x01, 0x80, 0x06, 0x05, 0x04, 0x80, 0x08, 0x07, 0x80, 0x80}, //1332
+	{0x01, 0x00, 0x80, 0x80, 0x04, 0x03, 0x02, 0x80, 0x07, 0x06, 0x05, 0x80, 0x09, 0x08, 0x80, 0x80}, //2332
+	{0x02, 0x01, 0x00, 0x80, 0x05, 0x04, 0x03, 0x80, 0x08, 0x07, 0x06, 0x80, 0x0a, 0x09, 0x80, 0x80}, //3332
+	{0x00, 0x80, 0x80, 0x80, 0x01, 0x80, 0x80, 0x80, 0x02, 0x80, 0x80, 0x80, 0x05, 0x04, 0x03, 0x80}, //1113
+	{0x01, 0x00, 0x80, 0x80, 0x02, 0x80, 0x80, 0x80, 0x03, 0x80, 0x80, 0x80, 0x06, 0x05, 0x04, 0x80}, //2113
+	{0x02, 0x01, 0x00, 0x80, 0x03, 0x80, 0x80, 0x80, 0x04, 0x80, 0x80, 0x80, 0x07, 0x06, 0x05, 0x80}, //3113
+	{0x00, 0x80, 0x80, 0x80, 0x02, 0x01, 0x80, 0x80, 0x03, 0x80, 0x80, 0x80, 0x06, 0x05, 0x04, 0x80}, //1213
+	{0x01, 0x00, 0x80, 0x80, 0x03, 0x02, 0x80, 0x80, 0x04, 0x80, 0x80, 0x80, 0x07, 0x06, 0x05, 0x80}, //2213
+	{0x02, 0x01, 0x00, 0x80, 0x04, 0x03, 0x80, 0x80, 0x05, 0x80, 0x80, 0x80, 0x08, 0x07, 0x06, 0x80}, //3213
+	{0x00, 0x80, 0x80, 0x80, 0x03, 0x02, 0x01, 0x80, 0x04, 0x80, 0x80, 0x80, 0x07, 0x06, 0x05, 0x80}, //1313
+	{0x01, 0x00, 0x80, 0x80, 0x04, 0x03, 0x02, 0x80, 0x05, 0x80, 0x80, 0x80, 0x08, 0x07, 0x06, 0x80}, //2313
+	{0x02, 0x01, 0x00, 0x80, 0x05, 0x04, 0x03, 0x80, 0x06, 0x80, 0x80, 0x80, 0x09, 0x08, 0x07, 0x80}, //3313
+	{0x00, 0x80, 0x80, 0x80, 0x01, 0x80, 0x80, 0x80, 0x03, 0x02, 0x80, 0x80, 0x06, 0x05, 0x04, 0x80}, //1123
+	{0x01, 0x00, 0x80, 0x80, 0x02, 0x80, 0x80, 0x80, 0x04, 0x03, 0x80, 0x80, 0x07, 0x06, 0x05, 0x80}, //2123
+	{0x02, 0x01, 0x00, 0x80, 0x03, 0x80, 0x80, 0x80, 0x05, 0x04, 0x80, 0x80, 0x08, 0x07, 0x06, 0x80}, //3123
+	{0x00, 0x80, 0x80, 0x80, 0x02, 0x01, 0x80, 0x80, 0x04, 0x03, 0x80, 0x80, 0x07, 0x06, 0x05, 0x80}, //1223
+	{0x01, 0x00, 0x80, 0x80, 0x03, 0x02, 0x80, 0x80, 0x05, 0x04, 0x80, 0x80, 0x08, 0x07, 0x06, 0x80}, //2223
+	{0x02, 0x01, 0x00, 0x80, 0x04, 0x03, 0x80, 0x80, 0x06, 0x05, 0x80, 0x80, 0x09, 0x08, 0x07, 0x80}, //3223
+	{0x00, 0x80, 0x80, 0x80, 0x03, 0x02, 0x01, 0x80, 0x05, 0x04, 0x80, 0x80, 0x08, 0x07, 0x06, 0x80}, //1323
+	{0x01, 0x00, 0x80, 0x80, 0x04, 0x03, 0x02, 0x80, 0x06, 0x05, 0x80, 0x80, 0x09, 0x08, 0x07, 0x80}, //2323
+	{0x02, 0x01, 0x00, 0x80, 0x05, 0x04, 0x03, 0x80, 0x07, 0x06, 0x80, 0x80, 0x0a, 0x09, 0x08, 0x80}, //3323
+	{0x00, 0x80, 0x80, 0x80, 0x01, 0x80, 0x80, 0x80, 0x04, 0x03, 0x02, 0x80, 0x07, 0x06, 0x05, 0x80}, //1133
+	{0x01, 0x00, 0x80, 0x80, 0x02, 0x80, 0x80, 0x80, 0x05, 0x04, 0x03, 0x80, 0x08, 0x07, 0x06, 0x80}, //2133
+	{0x02, 0x01, 0x00, 0x80, 0x03, 0x80, 0x80, 0x80, 0x06, 0x05, 0x04, 0x80, 0x09, 0x08, 0x07, 0x80}, //3133
+	{0x00, 0x80, 0x80, 0x80, 0x02, 0x01, 0x80, 0x80, 0x05, 0x04, 0x03, 0x80, 0x08, 0x07, 0x06, 0x80}, //1233
+	{0x01, 0x00, 0x80, 0x80, 0x03, 0x02, 0x80, 0x80, 0x06, 0x05, 0x04, 0x80, 0x09, 0x08, 0x07, 0x80}, //2233
+	{0x02, 0x01, 0x00, 0x80, 0x04, 0x03, 0x80, 0x80, 0x07, 0x06, 0x05, 0x80, 0x0a, 0x09, 0x08, 0x80}, //3233
+	{0x00, 0x80, 0x80, 0x80, 0x03, 0x02, 0x01, 0x80, 0x06, 0x05, 0x04, 0x80, 0x09, 0x08, 0x07, 0x80}, //1333
+	{0x01, 0x00, 0x80, 0x80, 0x04, 0x03, 0x02, 0x80, 0x07, 0x06, 0x05, 0x80, 0x0a, 0x09, 0x08, 0x80}, //2333
+	{0x02, 0x01, 0x00, 0x80, 0x05, 0x04, 0x03, 0x80, 0x08, 0x07, 0x06, 0x80, 0x0b, 0x0a, 0x09, 0x80}, //3333
+};
+
+EASY_STRING_TARGET("sse2") EASY_STRING_FORCE_INLINE static void easyUnicode_widenAscii16_sse2(__m128i in, unsigned int *dst) {
+	__m128i zero = _mm_setzero_si128();
+	__m128i lo = _mm_unpacklo_epi8(in, zero);
+	__m128i hi = _mm_unpackhi_epi8(in, zero);
+	_mm_storeu_si128((__m128i *)(dst + 0), _mm_unpacklo_epi16(lo, zero));
+	_mm_storeu_si128((__m128i *)(dst + 4), _mm_unpackhi_epi16(lo, zero));
+	_mm_storeu_si128((__m128i *)(dst + 8), _mm_unpacklo_epi16(hi, zero));
+	_mm_storeu_si128((__m128i *)(dst + 12), _mm_unpackhi_epi16(hi, zero));
+}
+
+//NOTE: Decodes the next 4 codepoints with one shuffle if they are all 1-3 bytes long and start in the first 12 bytes of the block.
+//Returns the number of bytes used, or 0 if this block has to go through the scalar decoder (4 byte sequences, or anything the scalar decoder would assert on).
+EASY_STRING_TARGET("ssse3") EASY_STRING_FORCE_INLINE static int easyUnicode_decode4_ssse3(unsigned char *src, __m128i in, unsigned int *dst) {
+	//NOTE: Continuation bytes are 0x80-0xBF which is -128 to -65 as signed chars
+	unsigned int leadMask = (unsigned int)_mm_movemask_epi8(_mm_cmpgt_epi8(in, _mm_set1_epi8(-65))) | 0x10000;
+	if(!(leadMask & 1)) return 0;
+
+	unsigned int m = leadMask & (leadMask - 1);
+	int p1 = easyString_ctz32(m);
+	if(p1 > 3) return 0;
+	m &= m - 1;
+	int p2 = easyString_ctz32(m);
+	if(p2 - p1 > 3) return 0;
+	m &= m - 1;
+	int p3 = easyString_ctz32(m);
+	if(p3 - p2 > 3) return 0;
+	m &= m - 1;
+	int p4 = easyString_ctz32(m);
+	if(p4 - p3 > 3) return 0;
+
+	int len0 = p1;
+	int len1 = p2 - p1;
+	int len2 = p3 - p2;
+	int len3 = p4 - p3;
+
+	//NOTE: the leading byte has to agree with where the next leading byte is, otherwise the scalar decoder would have asserted
+	int mismatch = (easyUnicode_utf8LengthTable[src[0] >> 4] ^ len0) | (easyUnicode_utf8LengthTable[src[p1] >> 4] ^ len1) | 
+	               (easyUnicode_utf8LengthTable[src[p2] >> 4] ^ len2) | (easyUnicode_utf8LengthTable[src[p3] >> 4] ^ len3);
+	if(mismatch) return 0;
+
+	int index = (len0 - 1) + 3*(len1 - 1) + 9*(len2 - 1) + 27*(len3 - 1);
+	__m128i v = _mm_shuffle_epi8(in, _mm_loadu_si128((__m128i *)easyUnicode_utf8ShuffleTable[index]));
+
+	//NOTE: Same masks the scalar decoder uses. 0x7F on the last byte keeps ascii whole and strips the 10 off continuation bytes,
+	//0x3F on the middle byte works for continuation bytes and 2 byte leads, 0x1F on the first byte of a 3 byte sequence.
+	__m128i b0 = _mm_and_si128(v, _mm_set1_epi32(0x7F));
+	__m128i b1 = _mm_srli_epi32(_mm_and_si128(v, _mm_set1_epi32(0x3F00)), 2);
+	__m128i b2 = _mm_srli_epi32(_mm_and_si128(v, _mm_set1_epi32(0x1F0000)), 4);
+	_mm_storeu_si128((__m128i *)dst, _mm_or_si128(b0, _mm_or_si128(b1, b2)));
+
+	return p4;
+}
+
+EASY_STRING_TARGET("sse2") static size_t easyUnicode_utf8ToUtf32_sse2(unsigned char *src, size_t srcLen, unsigned int *dst, size_t dstCap, size_t *srcUsed) {
+	size_t srcAt = 0;
+	size_t dstAt = 0;
+	while(srcAt + 16 <= srcLen && dstAt + 16 <= dstCap) {
+		__m128i in = _mm_loadu_si128((__m128i *)(src + srcAt));
+		if(_mm_movemask_epi8(in) == 0) {
+			easyUnicode_widenAscii16_sse2(in, dst + dstAt);
+			srcAt += 16;
+			dstAt += 16;
+		} else {
+			//NOTE: no shuffles on plain sse2, so decode about a block's worth one codepoint at a time
+			size_t used = 0;
+			dstAt += easyUnicode_utf8ToUtf32_scalar(src + srcAt, 16, dst + dstAt, 16, &used);
+			srcAt += used;
+		}
+	}
+	*srcUsed = srcAt;
+	return dstAt;
+}
+
+EASY_STRING_TARGET("ssse3") static size_t easyUnicode_utf8ToUtf32_ssse3(unsigned char *src, size_t srcLen, unsigned int *dst, size_t dstCap, size_t *srcUsed) {
+	size_t srcAt = 0;
+	size_t dstAt = 0;
+	while(srcAt + 16 <= srcLen && dstAt + 16 <= dstCap) {
+		__m128i in = _mm_loadu_si128((__m128i *)(src + srcAt));
+		if(_mm_movemask_epi8(in) == 0) {
+			easyUnicode_widenAscii16_sse2(in, dst + dstAt);
+			srcAt += 16;
+			dstAt += 16;
+		} else {
+			int used4 = easyUnicode_decode4_ssse3(src + srcAt, in, dst + dstAt);
+			if(used4) {
+				srcAt += used4;
+				dstAt += 4;
+			} else {
+				size_t used = 0;
+				dstAt += easyUnicode_utf8ToUtf32_scalar(src + srcAt, srcLen - srcAt, dst + dstAt, 1, &used);
+				srcAt += used;
+			}
+		}
+	}
+	*srcUsed = srcAt;
+	return dstAt;
+}
+
+EASY_STRING_TARGET("avx2") static size_t easyUnicode_utf8ToUtf32_avx2(unsigned char *src, size_t srcLen, unsigned int *dst, size_t dstCap, size_t *srcUsed) {
+	size_t srcAt = 0;
+	size_t dstAt = 0;
+	while(srcAt + 16 <= srcLen && dstAt + 16 <= dstCap) {
+		if(srcAt + 32 <= srcLen && dstAt + 32 <= dstCap) {
+			__m256i in32 = _mm256_loadu_si256((__m256i *)(src + srcAt));
+			if(_mm256_movemask_epi8(in32) == 0) {
+				__m128i lo = _mm256_castsi256_si128(in32);
+				__m128i hi = _mm256_extracti128_si256(in32, 1);
+				_mm256_storeu_si256((__m256i *)(dst + dstAt + 0), _mm256_cvtepu8_epi32(lo));
+				_mm256_storeu_si256((__m256i *)(dst + dstAt + 8), _mm256_cvtepu8_epi32(_mm_srli_si128(lo, 8)));
+				_mm256_storeu_si256((__m256i *)(dst + dstAt + 16), _mm256_cvtepu8_epi32(hi));
+				_mm256_storeu_si256((__m256i *)(dst + dstAt + 24), _mm256_cvtepu8_epi32(_mm_srli_si128(hi, 8)));
+				srcAt += 32;
+				dstAt += 32;
+				continue;
+			}
+		}
+
+		__m128i in = _mm_loadu_si128((__m128i *)(src + srcAt));
+		if(_mm_movemask_epi8(in) == 0) {
+			easyUnicode_widenAscii16_sse2(in, dst + dstAt);
+			srcAt += 16;
+			dstAt += 16;
+		} else {
+			int used4 = easyUnicode_decode4_ssse3(src + srcAt, in, dst + dstAt);
+			if(used4) {
+				srcAt += used4;
+				dstAt += 4;
+			} else {
+				size_t used = 0;
+				dstAt += easyUnicode_utf8ToUtf32_scalar(src + srcAt, srcLen - srcAt, dst + dstAt, 1, &used);
+				srcAt += used;
+			}
+		}
+	}
+	*srcUsed = srcAt;
+	return dstAt;
+}
+
+#endif // EASY_STRING_X86
+
+//NOTE: Picks the best path for the cpu, then finishes off whatever is left with the scalar decoder
+static size_t easyUnicode_utf8ToUtf32_(unsigned char *src, size_t srcLen, unsigned int *dst, size_t dstCap, size_t *srcUsed) {
+	size_t srcAt = 0;
+	size_t dstAt = 0;
+#if EASY_STRING_X86
+	switch(easyString_getSimdLevel()) {
+		case EASY_STRING_SIMD_AVX2: { dstAt = easyUnicode_utf8ToUtf32_avx2(src, srcLen, dst, dstCap, &srcAt); } break;
+		case EASY_STRING_SIMD_SSSE3: { dstAt = easyUnicode_utf8ToUtf32_ssse3(src, srcLen, dst, dstCap, &srcAt); } break;
+		case EASY_STRING_SIMD_SSE2: { dstAt = easyUnicode_utf8ToUtf32_sse2(src, srcLen, dst, dstCap, &srcAt); } break;
+		default: break;
+	}
+#endif
+	size_t tailUsed = 0;
+	dstAt += easyUnicode_utf8ToUtf32_scalar(src + srcAt, srcLen - srcAt, dst + dstAt, dstCap - dstAt, &tailUsed);
+	*srcUsed = srcAt + tailUsed;
+	return dstAt;
 }
 
+//NOTE: allocates from the arena when there is one, otherwise EASY_HEADERS_ALLOC
+static unsigned int *easyUnicode_utf8StreamToUtf32Stream_(EasyArena *arena, char *stream) {
+	size_t byteCount = easyString_byteLength_utf8(stream);
+	size_t size = easyUnicode_countCodepoints_((unsigned char *)stream, byteCount) + 1; //for null terminator
+	unsigned int *result = 0;
+	if(arena) {
+		result = easyArena_pushArray(arena, unsigned int, size);
+	} else {
+		result = (unsigned int *)(EASY_HEADERS_ALLOC(size*sizeof(unsigned int)));
+	}
+	size_t bytesUsed = 0;
+	size_t written = easyUnicode_utf8ToUtf32_((unsigned char *)stream, byteCount, result, size - 1, &bytesUsed);
+	EASY_HEADERS_ASSERT(bytesUsed == byteCount);
+	result[written] = '\0';
+	return result;
+}
 
-//TODO: this would be a good place for simd. 
 //NOTE: You have to free your string 
 
 //IMPORTANT: string must be null terminated. 
 unsigned int *easyUnicode_utf8StreamToUtf32Stream_allocates(char *stream) {
-	unsigned int size = easyString_getStringLength_utf8(stream) + 1; //for null terminator
-	unsigned int *result = (unsigned int *)(EASY_HEADERS_ALLOC(size*sizeof(unsigned int)));
-	unsigned int *at = result;
-	while(*stream) {
-		char *a = stream;
-		*at = easyUnicode_utf8_codepoint_To_Utf32_codepoint(&stream, 1);
-		EASY_HEADERS_ASSERT(stream != a);
-		at++;
+	return easyUnicode_utf8StreamToUtf32Stream_(0, stream);
+}
+
+//NOTE: Freed when the arena is reset, don't call easyString_free_Utf32_string on it
+unsigned int *easyUnicode_utf8StreamToUtf32Stream_arena(EasyArena *arena, char *stream) {
+	EASY_HEADERS_ASSERT(arena);
+	return easyUnicode_utf8StreamToUtf32Stream_(arena, stream);
+}
+
+EasyUnicode_Result easyUnicode_utf8ToUtf32(char *src, size_t srcLen, unsigned int *dst, size_t dstCap) {
+	EasyUnicode_Result result;
+	memset(&result, 0, sizeof(result));
+	result.codeUnitsWritten = easyUnicode_utf8ToUtf32_((unsigned char *)src, srcLen, dst, dstCap, &result.codeUnitsConsumed);
+	if(result.codeUnitsConsumed == srcLen) {
+		result.status = EASY_UNICODE_OK;
+	} else if(result.codeUnitsWritten == dstCap) {
+		result.status = EASY_UNICODE_OUTPUT_FULL;
+	} else {
+		result.status = EASY_UNICODE_NEED_MORE_INPUT;
 	}
-	result[size - 1] = '\0';
 	return result;
 }
 
-void easyString_free_Utf32_string(char *string) {
-	EASY_HEADERS_FREE(string);
+size_t easyUnicode_utf8ToUtf32_requiredSize(char *src, size_t srcLen) {
+	return easyUnicode_countCodepoints_((unsigned char *)src, srcLen);
+}
+
+void easyUnicode_initDecodeState(EasyUnicode_DecodeState *state) {
+	state->pendingCount = 0;
 }
 
+EasyUnicode_Result easyUnicode_utf8ToUtf32_stream(EasyUnicode_DecodeState *state, char *src, size_t srcLen, unsigned int *dst, size_t dstCap) {
+	EasyUnicode_Result result;
+	memset(&result, 0, sizeof(result));
+	unsigned char *at = (unsigned char *)src;
 
-int easyString_stringsMatch_withCount(char *a, int aLength, char *b, int bLength) {
-    int result = 1;
-    
-    int indexCount = 0;
-    while(indexCount < aLength && indexCount < bLength) {
-        indexCount++;
-        result &= (*a == *b);
-        a++;
-        b++;
-    }
-    result &= (indexCount == bLength && indexCount == aLength);
-    
-    return result;
-} 
+	if(state->pendingCount > 0) {
+		//NOTE: finish off the codepoint the last chunk ended on
+		if(dstCap == 0) {
+			result.status = EASY_UNICODE_OUTPUT_FULL;
+			return result;
+		}
+		int needed = easyUnicode_unicodeLength(state->pending[0]);
+		while(state->pendingCount < needed && result.codeUnitsConsumed < srcLen) {
+			state->pending[state->pendingCount++] = at[result.codeUnitsConsumed++];
+		}
+		if(state->pendingCount < needed) {
+			result.status = EASY_UNICODE_NEED_MORE_INPUT;
+			return result;
+		}
+		char *pendingAt = (char *)state->pending;
+		dst[result.codeUnitsWritten++] = easyUnicode_utf8_codepoint_To_Utf32_codepoint(&pendingAt, 1);
+		state->pendingCount = 0;
+	}
 
+	EasyUnicode_Result rest = easyUnicode_utf8ToUtf32(src + result.codeUnitsConsumed, srcLen - result.codeUnitsConsumed, dst + result.codeUnitsWritten, dstCap - result.codeUnitsWritten);
+	result.codeUnitsWritten += rest.codeUnitsWritten;
+	result.codeUnitsConsumed += rest.codeUnitsConsumed;
+	result.status = rest.status;
 
-int easyString_stringsMatch_null_and_count(char *a, char *b, int bLen) {
-    int result = easyString_stringsMatch_withCount(a, easyString_getStringLength_utf8(a), b, bLen);
-    return result;
+	if(result.status == EASY_UNICODE_NEED_MORE_INPUT) {
+		//NOTE: keep the start of the cut off codepoint for the next chunk. It's always less than 4 bytes.
+		while(result.codeUnitsConsumed < srcLen) {
+			EASY_HEADERS_ASSERT(state->pendingCount < 3);
+			state->pending[state->pendingCount++] = at[result.codeUnitsConsumed++];
+		}
+	}
+
+	return result;
 }
 
-int easyString_stringsMatch_nullTerminated(char *a, char *b) {
-    int result = easyString_stringsMatch_withCount(a, easyString_getStringLength_utf8(a), b, easyString_getStringLength_utf8(b));
-    return result;
+///////////////////////*********** Validation **************////////////////////
+
+//NOTE: Byte classes for the validating DFA, split where the Unicode table of well formed byte sequences splits
+static const unsigned char easyUnicode_dfaByteClass[256] = {
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, //0x0_
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, //0x1_
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, //0x2_
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, //0x3_
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, //0x4_
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, //0x5_
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, //0x6_
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, //0x7_
+	 1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1, //0x8_
+	 2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2, //0x9_
+	 3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3, //0xA_
+	 3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3, //0xB_
+	 4,  4,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5, //0xC_
+	 5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5, //0xD_
+	 6,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  8,  7,  7, //0xE_
+	 9, 10, 10, 10, 11, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, //0xF_
+};
+
+//NOTE: The bits of the first byte that belong to the codepoint, by class
+static const unsigned char easyUnicode_dfaLeadMask[13] = { 0x7F, 0, 0, 0, 0, 0x1F, 0x0F, 0x0F, 0x0F, 0x07, 0x07, 0x07, 0 };
+
+#define EASY_UNICODE_DFA_ACCEPT 0
+#define EASY_UNICODE_DFA_ERROR 0x10 //error states are this or'd with an EasyUnicode_Error
+
+#define EASY_UNICODE_DFA_UC (EASY_UNICODE_DFA_ERROR | EASY_UNICODE_ERROR_UNEXPECTED_CONTINUATION)
+#define EASY_UNICODE_DFA_IB (EASY_UNICODE_DFA_ERROR | EASY_UNICODE_ERROR_INVALID_BYTE)
+#define EASY_UNICODE_DFA_MC (EASY_UNICODE_DFA_ERROR | EASY_UNICODE_ERROR_MISSING_CONTINUATION)
+#define EASY_UNICODE_DFA_OL (EASY_UNICODE_DFA_ERROR | EASY_UNICODE_ERROR_OVERLONG)
+#define EASY_UNICODE_DFA_SG (EASY_UNICODE_DFA_ERROR | EASY_UNICODE_ERROR_SURROGATE)
+#define EASY_UNICODE_DFA_TL (EASY_UNICODE_DFA_ERROR | EASY_UNICODE_ERROR_TOO_LARGE)
+
+//NOTE: states are 0 accept, 1-3 that many continuation bytes left, 4 after E0, 5 after ED, 6 after F0, 7 after F4 (the leads that narrow the next byte's range)
+static const unsigned char easyUnicode_dfaTransitions[8][13] = {
+	//00-7F               80-8F                90-9F                A0-BF                C0-C1                C2-DF                E0                   E1-EF                ED                   F0                   F1-F3                F4                   F5-FF
+	{ 0,                   EASY_UNICODE_DFA_UC, EASY_UNICODE_DFA_UC, EASY_UNICODE_DFA_UC, EASY_UNICODE_DFA_OL, 1,                   4,                   2,                   5,                   6,                   3,                   7,                   EASY_UNICODE_DFA_IB },
+	{ EASY_UNICODE_DFA_MC, 0,                   0,                   0,                   EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC },
+	{ EASY_UNICODE_DFA_MC, 1,                   1,                   1,                   EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC },
+	{ EASY_UNICODE_DFA_MC, 2,                   2,                   2,                   EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC },
+	{ EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_OL, EASY_UNICODE_DFA_OL, 1,                   EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC },
+	{ EASY_UNICODE_DFA_MC, 1,                   1,                   EASY_UNICODE_DFA_SG, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC },
+	{ EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_OL, 2,                   2,                   EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC },
+	{ EASY_UNICODE_DFA_MC, 2,                   EASY_UNICODE_DFA_TL, EASY_UNICODE_DFA_TL, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC, EASY_UNICODE_DFA_MC },
+};
+
+//NOTE: Runs the DFA from start (which has to be the start of a codepoint). Returns the offset of the first bad sequence or len if there isn't one.
+//errorLength is the maximal subpart, the number of bytes one U+FFFD should replace.
+static size_t easyUnicode_validateScalar_(unsigned char *src, size_t len, size_t start, EasyUnicode_Error *error, size_t *errorLength) {
+	size_t seqStart = start;
+	unsigned int state = EASY_UNICODE_DFA_ACCEPT;
+	size_t i = start;
+	while(i < len) {
+		if(state == EASY_UNICODE_DFA_ACCEPT) {
+			//NOTE: skip ascii 8 bytes at a time
+			while(i + 8 <= len) {
+				unsigned long long word;
+				memcpy(&word, src + i, 8);
+				if(word & 0x8080808080808080ULL) break;
+				i += 8;
+			}
+			if(i >= len) break;
+			seqStart = i;
+		}
+		state = easyUnicode_dfaTransitions[state][easyUnicode_dfaByteClass[src[i]]];
+		if(state & EASY_UNICODE_DFA_ERROR) {
+			*error = (EasyUnicode_Error)(state & ~EASY_UNICODE_DFA_ERROR);
+			//NOTE: a bad first byte is replaced on its own, otherwise the bytes before this one are, and this one starts again
+			*errorLength = (i == seqStart) ? 1 : i - seqStart;
+			return seqStart;
+		}
+		i++;
+	}
+	if(state != EASY_UNICODE_DFA_ACCEPT) {
+		*error = EASY_UNICODE_ERROR_TRUNCATED;
+		*errorLength = len - seqStart;
+		return seqStart;
+	}
+	*error = EASY_UNICODE_ERROR_NONE;
+	*errorLength = 0;
+	return len;
+}
+
+#if EASY_STRING_X86
+
+//NOTE: Keiser & Lemire's lookup validator. Three 16 entry nibble lookups on each byte and the byte before it flag every bad 2 byte pattern,
+//then 3rd and 4th bytes of long sequences get checked against the leads 2 and 3 bytes back.
+#define EASY_UTF8_TOO_SHORT (1 << 0) //lead followed by a lead or ascii
+#define EASY_UTF8_TOO_LONG (1 << 1) //ascii followed by a continuation
+#define EASY_UTF8_OVERLONG_3 (1 << 2)
+#define EASY_UTF8_TOO_LARGE (1 << 3)
+#define EASY_UTF8_SURROGATE (1 << 4)
+#define EASY_UTF8_OVERLONG_2 (1 << 5)
+#define EASY_UTF8_TOO_LARGE_1000 (1 << 6)
+#define EASY_UTF8_OVERLONG_4 (1 << 6)
+#define EASY_UTF8_TWO_CONTS (1 << 7)
+#define EASY_UTF8_CARRY (EASY_UTF8_TOO_SHORT | EASY_UTF8_TOO_LONG | EASY_UTF8_TWO_CONTS)
+
+#define EASY_UTF8_BYTE_1_HIGH_TABLE \
+	EASY_UTF8_TOO_LONG, EASY_UTF8_TOO_LONG, EASY_UTF8_TOO_LONG, EASY_UTF8_TOO_LONG, \
+	EASY_UTF8_TOO_LONG, EASY_UTF8_TOO_LONG, EASY_UTF8_TOO_LONG, EASY_UTF8_TOO_LONG, \
+	(char)EASY_UTF8_TWO_CONTS, (char)EASY_UTF8_TWO_CONTS, (char)EASY_UTF8_TWO_CONTS, (char)EASY_UTF8_TWO_CONTS, \
+	EASY_UTF8_TOO_SHORT | EASY_UTF8_OVERLONG_2, \
+	EASY_UTF8_TOO_SHORT, \
+	EASY_UTF8_TOO_SHORT | EASY_UTF8_OVERLONG_3 | EASY_UTF8_SURROGATE, \
+	(char)(EASY_UTF8_TOO_SHORT | EASY_UTF8_TOO_LARGE | EASY_UTF8_TOO_LARGE_1000 | EASY_UTF8_OVERLONG_4)
+
+#define EASY_UTF8_BYTE_1_LOW_TABLE \
+	(char)(EASY_UTF8_CARRY | EASY_UTF8_OVERLONG_3 | EASY_UTF8_OVERLONG_2 | EASY_UTF8_OVERLONG_4), \
+	(char)(EASY_UTF8_CARRY | EASY_UTF8_OVERLONG_2), \
+	(char)EASY_UTF8_CARRY, \
+	(char)EASY_UTF8_CARRY, \
+	(char)(EASY_UTF8_CARRY | EASY_UTF8_TOO_LARGE), \
+	(char)(EASY_UTF8_CARRY | EASY_UTF8_TOO_LARGE | EASY_UTF8_TOO_LARGE_1000), \
+	(char)(EASY_UTF8_CARRY | EASY_UTF8_TOO_LARGE | EASY_UTF8_TOO_LARGE_1000), \
+	(char)(EASY_UTF8_CARRY | EASY_UTF8_TOO_LARGE | EASY_UTF8_TOO_LARGE_1000), \
+	(char)(EASY_UTF8_CARRY | EASY_UTF8_TOO_LARGE | EASY_UTF8_TOO_LARGE_1000), \
+	(char)(EASY_UTF8_CARRY | EASY_UTF8_TOO_LARGE | EASY_UTF8_TOO_LARGE_1000), \
+	(char)(EASY_UTF8_CARRY | EASY_UTF8_TOO_LARGE | EASY_UTF8_TOO_LARGE_1000), \
+	(char)(EASY_UTF8_CARRY | EASY_UTF8_TOO_LARGE | EASY_UTF8_TOO_LARGE_1000), \
+	(char)(EASY_UTF8_CARRY | EASY_UTF8_TOO_LARGE | EASY_UTF8_TOO_LARGE_1000), \
+	(char)(EASY_UTF8_CARRY | EASY_UTF8_TOO_LARGE | EASY_UTF8_TOO_LARGE_1000 | EASY_UTF8_SURROGATE), \
+	(char)(EASY_UTF8_CARRY | EASY_UTF8_TOO_LARGE | EASY_UTF8_TOO_LARGE_1000), \
+	(char)(EASY_UTF8_CARRY | EASY_UTF8_TOO_LARGE | EASY_UTF8_TOO_LARGE_1000)
+
+#define EASY_UTF8_BYTE_2_HIGH_TABLE \
+	EASY_UTF8_TOO_SHORT, EASY_UTF8_TOO_SHORT, EASY_UTF8_TOO_SHORT, EASY_UTF8_TOO_SHORT, \
+	EASY_UTF8_TOO_SHORT, EASY_UTF8_TOO_SHORT, EASY_UTF8_TOO_SHORT, EASY_UTF8_TOO_SHORT, \
+	(char)(EASY_UTF8_TOO_LONG | EASY_UTF8_OVERLONG_2 | EASY_UTF8_TWO_CONTS | EASY_UTF8_OVERLONG_3 | EASY_UTF8_TOO_LARGE_1000 | EASY_UTF8_OVERLONG_4), \
+	(char)(EASY_UTF8_TOO_LONG | EASY_UTF8_OVERLONG_2 | EASY_UTF8_TWO_CONTS | EASY_UTF8_OVERLONG_3 | EASY_UTF8_TOO_LARGE), \
+	(char)(EASY_UTF8_TOO_LONG | EASY_UTF8_OVERLONG_2 | EASY_UTF8_TWO_CONTS | EASY_UTF8_SURROGATE | EASY_UTF8_TOO_LARGE), \
+	(char)(EASY_UTF8_TOO_LONG | EASY_UTF8_OVERLONG_2 | EASY_UTF8_TWO_CONTS | EASY_UTF8_SURROGATE | EASY_UTF8_TOO_LARGE), \
+	EASY_UTF8_TOO_SHORT, EASY_UTF8_TOO_SHORT, EASY_UTF8_TOO_SHORT, EASY_UTF8_TOO_SHORT
+
+//NOTE: Non zero bytes wherever input (with the 16 bytes before it in prevInput) has a bad sequence
+EASY_STRING_TARGET("ssse3") EASY_STRING_FORCE_INLINE static __m128i easyUnicode_utf8BlockErrors_ssse3(__m128i input, __m128i prevInput) {
+	__m128i nibbleMask = _mm_set1_epi8(0x0F);
+	__m128i prev1 = _mm_alignr_epi8(input, prevInput, 15);
+	__m128i byte1High = _mm_shuffle_epi8(_mm_setr_epi8(EASY_UTF8_BYTE_1_HIGH_TABLE), _mm_and_si128(_mm_srli_epi16(prev1, 4), nibbleMask));
+	__m128i byte1Low = _mm_shuffle_epi8(_mm_setr_epi8(EASY_UTF8_BYTE_1_LOW_TABLE), _mm_and_si128(prev1, nibbleMask));
+	__m128i byte2High = _mm_shuffle_epi8(_mm_setr_epi8(EASY_UTF8_BYTE_2_HIGH_TABLE), _mm_and_si128(_mm_srli_epi16(input, 4), nibbleMask));
+	__m128i special = _mm_and_si128(_mm_and_si128(byte1High, byte1Low), byte2High);
+
+	//NOTE: 2 bytes after a 3/4 byte lead, or 3 after a 4 byte lead, has to be a continuation byte. Those two-continuations-in-a-row are expected, everything else is an error
+	__m128i isThirdByte = _mm_subs_epu8(_mm_alignr_epi8(input, prevInput, 14), _mm_set1_epi8((char)(0xE0 - 0x80)));
+	__m128i isFourthByte = _mm_subs_epu8(_mm_alignr_epi8(input, prevInput, 13), _mm_set1_epi8((char)(0xF0 - 0x80)));
+	__m128i must23 = _mm_and_si128(_mm_or_si128(isThirdByte, isFourthByte), _mm_set1_epi8((char)0x80));
+	return _mm_xor_si128(must23, special);
+}
+
+//NOTE: Non zero if the block ends part way through a sequence
+EASY_STRING_TARGET("sse2") EASY_STRING_FORCE_INLINE static __m128i easyUnicode_utf8Incomplete_sse2(__m128i input) {
+	__m128i maxValue = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, (char)(0xF0 - 1), (char)(0xE0 - 1), (char)(0xC0 - 1));
+	return _mm_subs_epu8(input, maxValue);
+}
+
+//NOTE: Returns how many bytes were checked (a multiple of 64). Stops before the 64 bytes with the first error in them.
+EASY_STRING_TARGET("ssse3") static size_t easyUnicode_validate_ssse3(unsigned char *src, size_t len) {
+	size_t at = 0;
+	__m128i zero = _mm_setzero_si128();
+	__m128i prev = zero;
+	__m128i prevIncomplete = zero;
+	while(at + 64 <= len) {
+		__m128i in0 = _mm_loadu_si128((__m128i *)(src + at + 0));
+		__m128i in1 = _mm_loadu_si128((__m128i *)(src + at + 16));
+		__m128i in2 = _mm_loadu_si128((__m128i *)(src + at + 32));
+		__m128i in3 = _mm_loadu_si128((__m128i *)(src + at + 48));
+		__m128i error;
+		if(_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(in0, in1), _mm_or_si128(in2, in3))) == 0) {
+			//NOTE: all ascii, only wrong if the last block was left hanging
+			error = prevIncomplete;
+			prevIncomplete = zero;
+		} else {
+			error = easyUnicode_utf8BlockErrors_ssse3(in0, prev);
+			error = _mm_or_si128(error, easyUnicode_utf8BlockErrors_ssse3(in1, in0));
+			error = _mm_or_si128(error, easyUnicode_utf8BlockErrors_ssse3(in2, in1));
+			error = _mm_or_si128(error, easyUnicode_utf8BlockErrors_ssse3(in3, in2));
+			prevIncomplete = easyUnicode_utf8Incomplete_sse2(in3);
+		}
+		if(_mm_movemask_epi8(_mm_cmpeq_epi8(error, zero)) != 0xFFFF) break;
+		prev = in3;
+		at += 64;
+	}
+	return at;
+}
+
+EASY_STRING_TARGET("avx2") EASY_STRING_FORCE_INLINE static __m256i easyUnicode_utf8BlockErrors_avx2(__m256i input, __m256i prevInput) {
+	__m256i nibbleMask = _mm256_set1_epi8(0x0F);
+	//NOTE: alignr works per 128 bit lane, so line up the 16 bytes before each lane first
+	__m256i prevLanes = _mm256_permute2x128_si256(prevInput, input, 0x21);
+	__m256i prev1 = _mm256_alignr_epi8(input, prevLanes, 15);
+	__m256i byte1High = _mm256_shuffle_epi8(_mm256_setr_epi8(EASY_UTF8_BYTE_1_HIGH_TABLE, EASY_UTF8_BYTE_1_HIGH_TABLE), _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibbleMask));
+	__m256i byte1Low = _mm256_shuffle_epi8(_mm256_setr_epi8(EASY_UTF8_BYTE_1_LOW_TABLE, EASY_UTF8_BYTE_1_LOW_TABLE), _mm256_and_si256(prev1, nibbleMask));
+	__m256i byte2High = _mm256_shuffle_epi8(_mm256_setr_epi8(EASY_UTF8_BYTE_2_HIGH_TABLE, EASY_UTF8_BYTE_2_HIGH_TABLE), _mm256_and_si256(_mm256_srli_epi16(input, 4), nibbleMask));
+	__m256i special = _mm256_and_si256(_mm256_and_si256(byte1High, byte1Low), byte2High);
+
+	__m256i isThirdByte = _mm256_subs_epu8(_mm256_alignr_epi8(input, prevLanes, 14), _mm256_set1_epi8((char)(0xE0 - 0x80)));
+	__m256i isFourthByte = _mm256_subs_epu8(_mm256_alignr_epi8(input, prevLanes, 13), _mm256_set1_epi8((char)(0xF0 - 0x80)));
+	__m256i must23 = _mm256_and_si256(_mm256_or_si256(isThirdByte, isFourthByte), _mm256_set1_epi8((char)0x80));
+	return _mm256_xor_si256(must23, special);
+}
+
+EASY_STRING_TARGET("avx2") static size_t easyUnicode_validate_avx2(unsigned char *src, size_t len) {
+	size_t at = 0;
+	__m256i zero = _mm256_setzero_si256();
+	__m256i prev = zero;
+	__m256i prevIncomplete = zero;
+	__m256i maxValue = _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 
+	                                    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, (char)(0xF0 - 1), (char)(0xE0 - 1), (char)(0xC0 - 1));
+	while(at + 64 <= len) {
+		__m256i in0 = _mm256_loadu_si256((__m256i *)(src + at + 0));
+		__m256i in1 = _mm256_loadu_si256((__m256i *)(src + at + 32));
+		__m256i error;
+		if(_mm256_movemask_epi8(_mm256_or_si256(in0, in1)) == 0) {
+			error = prevIncomplete;
+			prevIncomplete = zero;
+		} else {
+			error = _mm256_or_si256(easyUnicode_utf8BlockErrors_avx2(in0, prev), easyUnicode_utf8BlockErrors_avx2(in1, in0));
+			prevIncomplete = _mm256_subs_epu8(in1, maxValue);
+		}
+		if(!_mm256_testz_si256(error, error)) break;
+		prev = in1;
+		at += 64;
+	}
+	return at;
+}
+
+#endif // EASY_STRING_X86
+
+//NOTE: Returns the offset of the first bad sequence in src (or len). The simd validators find the 64 bytes it's in, then the DFA pins it down.
+static size_t easyUnicode_findUtf8Error_(unsigned char *src, size_t len, EasyUnicode_Error *error, size_t *errorLength) {
+	size_t at = 0;
+#if EASY_STRING_X86
+	switch(easyString_getSimdLevel()) {
+		case EASY_STRING_SIMD_AVX2: { at = easyUnicode_validate_avx2(src, len); } break;
+		case EASY_STRING_SIMD_SSSE3: { at = easyUnicode_validate_ssse3(src, len); } break;
+		default: break;
+	}
+#endif
+	//NOTE: the simd part stopped on a block boundary, so go back to the start of whatever codepoint the byte before it belongs to
+	size_t restart = at;
+	for(size_t back = 1; back <= 3 && back <= at; ++back) {
+		if(!easyUnicode_isContinuationByte(src[at - back])) {
+			restart = at - back;
+			break;
+		}
+	}
+	return easyUnicode_validateScalar_(src, len, restart, error, errorLength);
+}
+
+EasyString_Utf8Validation easyString_validate_utf8(char *ptr, size_t len) {
+	EasyString_Utf8Validation result;
+	memset(&result, 0, sizeof(result));
+	size_t errorLength = 0;
+	result.errorOffset = easyUnicode_findUtf8Error_((unsigned char *)ptr, len, &result.error, &errorLength);
+	result.valid = (result.error == EASY_UNICODE_ERROR_NONE);
+	return result;
+}
+
+EasyUnicode_Result easyUnicode_utf8ToUtf32_validating(char *src, size_t srcLen, unsigned int *dst, size_t dstCap, EasyUnicode_InvalidPolicy policy) {
+	EasyUnicode_Result result;
+	memset(&result, 0, sizeof(result));
+	unsigned char *at = (unsigned char *)src;
+
+	while(result.codeUnitsConsumed < srcLen) {
+		//NOTE: Don't validate further than dst has room for, otherwise small buffers would validate the rest of the input on every call.
+		//Any 4*room + 3 bytes hold at least room whole codepoints, so a cut off codepoint at the end of the window always lands after dst is full.
+		size_t window = srcLen - result.codeUnitsConsumed;
+		size_t room = dstCap - result.codeUnitsWritten;
+		if(room < window / 4) { window = room*4 + 3; }
+
+		EasyUnicode_Error error;
+		size_t errorLength;
+		size_t validEnd = result.codeUnitsConsumed + easyUnicode_findUtf8Error_(at + result.codeUnitsConsumed, window, &error, &errorLength);
+
+		//NOTE: everything before the error is valid so it can go through the fast path
+		size_t used = 0;
+		result.codeUnitsWritten += easyUnicode_utf8ToUtf32_(at + result.codeUnitsConsumed, validEnd - result.codeUnitsConsumed, dst + result.codeUnitsWritten, dstCap - result.codeUnitsWritten, &used);
+		result.codeUnitsConsumed += used;
+
+		if(result.codeUnitsConsumed < validEnd || (result.codeUnitsWritten == dstCap && result.codeUnitsConsumed < srcLen)) {
+			result.status = EASY_UNICODE_OUTPUT_FULL;
+			return result;
+		}
+		if(error == EASY_UNICODE_ERROR_NONE) break;
+
+		if(result.error == EASY_UNICODE_ERROR_NONE) { result.error = error; }
+
+		if(policy == EASY_UNICODE_STOP_ON_INVALID) {
+			result.status = (error == EASY_UNICODE_ERROR_TRUNCATED) ? EASY_UNICODE_NEED_MORE_INPUT : EASY_UNICODE_INVALID;
+			return result;
+		}
+
+		dst[result.codeUnitsWritten++] = EASY_UNICODE_REPLACEMENT_CHARACTER;
+		result.codeUnitsConsumed += errorLength;
+	}
+
+	result.status = EASY_UNICODE_OK;
+	return result;
+}
+
+unsigned int easyUnicode_utf8_codepoint_To_Utf32_codepoint_validated(char **streamPtr, char *streamEnd, EasyUnicode_Error *error) {
+	unsigned char *stream = (unsigned char *)(*streamPtr);
+	size_t len = (size_t)((unsigned char *)streamEnd - stream);
+	unsigned int result = EASY_UNICODE_REPLACEMENT_CHARACTER;
+	EasyUnicode_Error errorKind = EASY_UNICODE_ERROR_NONE;
+	size_t advance = 0;
+
+	unsigned int state = EASY_UNICODE_DFA_ACCEPT;
+	unsigned int codepoint = 0;
+	for(size_t i = 0; i < len; ++i) {
+		int byteClass = easyUnicode_dfaByteClass[stream[i]];
+		codepoint = (i == 0) ? (stream[i] & easyUnicode_dfaLeadMask[byteClass]) : ((codepoint << 6) | (stream[i] & 0x3F));
+		state = easyUnicode_dfaTransitions[state][byteClass];
+		if(state & EASY_UNICODE_DFA_ERROR) {
+			errorKind = (EasyUnicode_Error)(state & ~EASY_UNICODE_DFA_ERROR);
+			advance = (i == 0) ? 1 : i;
+			break;
+		}
+		if(state == EASY_UNICODE_DFA_ACCEPT) {
+			result = codepoint;
+			advance = i + 1;
+			break;
+		}
+	}
+	if(advance == 0 && len > 0) {
+		//NOTE: ran out of input part way through
+		errorKind = EASY_UNICODE_ERROR_TRUNCATED;
+		advance = len;
+	}
+
+	(*streamPtr) += advance;
+	if(error) { *error = errorKind; }
+	return result;
+}
+
+void easyString_free_Utf32_string(char *string) {
+	EASY_HEADERS_FREE(string);
+}
+
+
+///////////////////////*********** Encoding, utf16 and utf32 **************////////////////////
+
+inline static int easyUnicode_utf8Length_(unsigned int codepoint) {
+	return 1 + (codepoint >= 0x80) + (codepoint >= 0x800) + (codepoint >= 0x10000);
+}
+
+//NOTE: codepoint has to be valid (easyUnicode_checkCodepoint_)
+inline static int easyUnicode_encodeUtf8_(unsigned int codepoint, unsigned char *out) {
+	if(codepoint < 0x80) {
+		out[0] = (unsigned char)codepoint;
+		return 1;
+	}
+	if(codepoint < 0x800) {
+		out[0] = (unsigned char)(0xC0 | (codepoint >> 6));
+		out[1] = (unsigned char)(0x80 | (codepoint & 0x3F));
+		return 2;
+	}
+	if(codepoint < 0x10000) {
+		out[0] = (unsigned char)(0xE0 | (codepoint >> 12));
+		out[1] = (unsigned char)(0x80 | ((codepoint >> 6) & 0x3F));
+		out[2] = (unsigned char)(0x80 | (codepoint & 0x3F));
+		return 3;
+	}
+	out[0] = (unsigned char)(0xF0 | (codepoint >> 18));
+	out[1] = (unsigned char)(0x80 | ((codepoint >> 12) & 0x3F));
+	out[2] = (unsigned char)(0x80 | ((codepoint >> 6) & 0x3F));
+	out[3] = (unsigned char)(0x80 | (codepoint & 0x3F));
+	return 4;
+}
+
+inline static EasyUnicode_Error easyUnicode_checkCodepoint_(unsigned int codepoint) {
+	if(codepoint > 0x10FFFF) return EASY_UNICODE_ERROR_TOO_LARGE;
+	if(codepoint >= 0xD800 && codepoint <= 0xDFFF) return EASY_UNICODE_ERROR_SURROGATE;
+	return EASY_UNICODE_ERROR_NONE;
+}
+
+//NOTE: Reads one codepoint from utf16. Unpaired surrogates come back as U+FFFD with the error set, used is always at least 1.
+static unsigned int easyUnicode_readUtf16_(unsigned short *src, size_t len, size_t *used, EasyUnicode_Error *error) {
+	unsigned int unit = src[0];
+	*used = 1;
+	*error = EASY_UNICODE_ERROR_NONE;
+	if((unit & 0xF800) != 0xD800) return unit;
+
+	if(unit >= 0xDC00) {
+		*error = EASY_UNICODE_ERROR_UNEXPECTED_CONTINUATION;
+	} else if(len < 2) {
+		*error = EASY_UNICODE_ERROR_TRUNCATED;
+	} else if((src[1] & 0xFC00) != 0xDC00) {
+		*error = EASY_UNICODE_ERROR_MISSING_CONTINUATION;
+	} else {
+		*used = 2;
+		return 0x10000 + ((unit - 0xD800) << 10) + (src[1] - 0xDC00);
+	}
+	return EASY_UNICODE_REPLACEMENT_CHARACTER;
+}
+
+//NOTE: Shared by every converter below when it hits something the fast paths don't do. Returns 0 if the caller should stop (result.status is set).
+static int easyUnicode_handleInvalid_(EasyUnicode_Result *result, EasyUnicode_Error error, EasyUnicode_InvalidPolicy policy) {
+	if(result->error == EASY_UNICODE_ERROR_NONE) { result->error = error; }
+	if(policy == EASY_UNICODE_STOP_ON_INVALID) {
+		result->status = (error == EASY_UNICODE_ERROR_TRUNCATED) ? EASY_UNICODE_NEED_MORE_INPUT : EASY_UNICODE_INVALID;
+		return 0;
+	}
+	return 1;
+}
+
+#if EASY_STRING_X86
+
+//NOTE: Index into easyUnicode_utf8PackTable from a 4 bit lane mask, each set bit adds 3^lane
+static const unsigned char easyUnicode_base3Table[16] = { 0, 1, 3, 4, 9, 10, 12, 13, 27, 28, 30, 31, 36, 37, 39, 40 };
+static const unsigned char easyUnicode_bitCountTable[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+//NOTE: pshufb masks that squash 4 lanes of 1-3 utf8 bytes (first byte lowest) down to one run of bytes. The opposite of easyUnicode_utf8ShuffleTable.
+//Index is (len0 - 1) + 3*(len1 - 1) + 9*(len2 - 1) + 27*(len3 - 1).
+static const unsigned char easyUnicode_utf8PackTable[81][16] = {
+	{0x00, 0x04, 0x08, 0x0C, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //1111
+	{0x00, 0x01, 0x04, 0x08, 0x0C, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //2111
+	{0x00, 0x01, 0x02, 0x04, 0x08, 0x0C, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //3111
+	{0x00, 0x04, 0x05, 0x08, 0x0C, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //1211
+	{0x00, 0x01, 0x04, 0x05, 0x08, 0x0C, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //2211
+	{0x00, 0x01, 0x02, 0x04, 0x05, 0x08, 0x0C, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //3211
+	{0x00, 0x04, 0x05, 0x06, 0x08, 0x0C, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //1311
+	{0x00, 0x01, 0x04, 0x05, 0x06, 0x08, 0x0C, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //2311
+	{0x00, 0x01, 0x02, 0x04, 0x05, 0x06, 0x08, 0x0C, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //3311
+	{0x00, 0x04, 0x08, 0x09, 0x0C, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //1121
+	{0x00, 0x01, 0x04, 0x08, 0x09, 0x0C, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //2121
+	{0x00, 0x01, 0x02, 0x04, 0x08, 0x09, 0x0C, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //3121
+	{0x00, 0x04, 0x05, 0x08, 0x09, 0x0C, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //1221
+	{0x00, 0x01, 0x04, 0x05, 0x08, 0x09, 0x0C, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //2221
+	{0x00, 0x01, 0x02, 0x04, 0x05, 0x08, 0x09, 0x0C, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //3221
+	{0x00, 0x04, 0x05, 0x06, 0x08, 0x09, 0x0C, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //1321
+	{0x00, 0x01, 0x04, 0x05, 0x06, 0x08, 0x09, 0x0C, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //2321
+	{0x00, 0x01, 0x02, 0x04, 0x05, 0x06, 0x08, 0x09, 0x0C, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //3321
+	{0x00, 0x04, 0x08, 0x09, 0x0A, 0x0C, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //1131
+	{0x00, 0x01, 0x04, 0x08, 0x09, 0x0A, 0x0C, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //2131
+	{0x00, 0x01, 0x02, 0x04, 0x08, 0x09, 0x0A, 0x0C, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //3131
+	{0x00, 0x04, 0x05, 0x08, 0x09, 0x0A, 0x0C, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //1231
+	{0x00, 0x01, 0x04, 0x05, 0x08, 0x09, 0x0A, 0x0C, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //2231
+	{0x00, 0x01, 0x02, 0x04, 0x05, 0x08, 0x09, 0x0A, 0x0C, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //3231
+	{0x00, 0x04, 0x05, 0x06, 0x08, 0x09, 0x0A, 0x0C, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //1331
+	{0x00, 0x01, 0x04, 0x05, 0x06, 0x08, 0x09, 0x0A, 0x0C, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //2331
+	{0x00, 0x01, 0x02, 0x04, 0x05, 0x06, 0x08, 0x09, 0x0A, 0x0C, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //3331
+	{0x00, 0x04, 0x08, 0x0C, 0x0D, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //1112
+	{0x00, 0x01, 0x04, 0x08, 0x0C, 0x0D, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //2112
+	{0x00, 0x01, 0x02, 0x04, 0x08, 0x0C, 0x0D, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //3112
+	{0x00, 0x04, 0x05, 0x08, 0x0C, 0x0D, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //1212
+	{0x00, 0x01, 0x04, 0x05, 0x08, 0x0C, 0x0D, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //2212
+	{0x00, 0x01, 0x02, 0x04, 0x05, 0x08, 0x0C, 0x0D, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //3212
+	{0x00, 0x04, 0x05, 0x06, 0x08, 0x0C, 0x0D, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //1312
+	{0x00, 0x01, 0x04, 0x05, 0x06, 0x08, 0x0C, 0x0D, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //2312
+	{0x00, 0x01, 0x02, 0x04, 0x05, 0x06, 0x08, 0x0C, 0x0D, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //3312
+	{0x00, 0x04, 0x08, 0x09, 0x0C, 0x0D, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //1122
+	{0x00, 0x01, 0x04, 0x08, 0x09, 0x0C, 0x0D, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //2122
+	{0x00, 0x01, 0x02, 0x04, 0x08, 0x09, 0x0C, 0x0D, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //3122
+	{0x00, 0x04, 0x05, 0x08, 0x09, 0x0C, 0x0D, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //1222
+	{0x00, 0x01, 0x04, 0x05, 0x08, 0x09, 0x0C, 0x0D, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //2222
+	{0x00, 0x01, 0x02, 0x04, 0x05, 0x08, 0x09, 0x0C, 0x0D, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //3222
+	{0x00, 0x04, 0x05, 0x06, 0x08, 0x09, 0x0C, 0x0D, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //1322
+	{0x00, 0x01, 0x04, 0x05, 0x06, 0x08, 0x09, 0x0C, 0x0D, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //2322
+	{0x00, 0x01, 0x02, 0x04, 0x05, 0x06, 0x08, 0x09, 0x0C, 0x0D, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //3322
+	{0x00, 0x04, 0x08, 0x09, 0x0A, 0x0C, 0x0D, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //1132
+	{0x00, 0x01, 0x04, 0x08, 0x09, 0x0A, 0x0C, 0x0D, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //2132
+	{0x00, 0x01, 0x02, 0x04, 0x08, 0x09, 0x0A, 0x0C, 0x0D, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //3132
+	{0x00, 0x04, 0x05, 0x08, 0x09, 0x0A, 0x0C, 0x0D, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //1232
+	{0x00, 0x01, 0x04, 0x05, 0x08, 0x09, 0x0A, 0x0C, 0x0D, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //2232
+	{0x00, 0x01, 0x02, 0x04, 0x05, 0x08, 0x09, 0x0A, 0x0C, 0x0D, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //3232
+	{0x00, 0x04, 0x05, 0x06, 0x08, 0x09, 0x0A, 0x0C, 0x0D, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //1332
+	{0x00, 0x01, 0x04, 0x05, 0x06, 0x08, 0x09, 0x0A, 0x0C, 0x0D, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //2332
+	{0x00, 0x01, 0x02, 0x04, 0x05, 0x06, 0x08, 0x09, 0x0A, 0x0C, 0x0D, 0x80, 0x80, 0x80, 0x80, 0x80}, //3332
+	{0x00, 0x04, 0x08, 0x0C, 0x0D, 0x0E, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //1113
+	{0x00, 0x01, 0x04, 0x08, 0x0C, 0x0D, 0x0E, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //2113
+	{0x00, 0x01, 0x02, 0x04, 0x08, 0x0C, 0x0D, 0x0E, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //3113
+	{0x00, 0x04, 0x05, 0x08, 0x0C, 0x0D, 0x0E, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //1213
+	{0x00, 0x01, 0x04, 0x05, 0x08, 0x0C, 0x0D, 0x0E, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //2213
+	{0x00, 0x01, 0x02, 0x04, 0x05, 0x08, 0x0C, 0x0D, 0x0E, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //3213
+	{0x00, 0x04, 0x05, 0x06, 0x08, 0x0C, 0x0D, 0x0E, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //1313
+	{0x00, 0x01, 0x04, 0x05, 0x06, 0x08, 0x0C, 0x0D, 0x0E, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //2313
+	{0x00, 0x01, 0x02, 0x04, 0x05, 0x06, 0x08, 0x0C, 0x0D, 0x0E, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //3313
+	{0x00, 0x04, 0x08, 0x09, 0x0C, 0x0D, 0x0E, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //1123
+	{0x00, 0x01, 0x04, 0x08, 0x09, 0x0C, 0x0D, 0x0E, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //2123
+	{0x00, 0x01, 0x02, 0x04, 0x08, 0x09, 0x0C, 0x0D, 0x0E, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //3123
+	{0x00, 0x04, 0x05, 0x08, 0x09, 0x0C, 0x0D, 0x0E, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //1223
+	{0x00, 0x01, 0x04, 0x05, 0x08, 0x09, 0x0C, 0x0D, 0x0E, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //2223
+	{0x00, 0x01, 0x02, 0x04, 0x05, 0x08, 0x09, 0x0C, 0x0D, 0x0E, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //3223
+	{0x00, 0x04, 0x05, 0x06, 0x08, 0x09, 0x0C, 0x0D, 0x0E, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //1323
+	{0x00, 0x01, 0x04, 0x05, 0x06, 0x08, 0x09, 0x0C, 0x0D, 0x0E, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //2323
+	{0x00, 0x01, 0x02, 0x04, 0x05, 0x06, 0x08, 0x09, 0x0C, 0x0D, 0x0E, 0x80, 0x80, 0x80, 0x80, 0x80}, //3323
+	{0x00, 0x04, 0x08, 0x09, 0x0A, 0x0C, 0x0D, 0x0E, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //1133
+	{0x00, 0x01, 0x04, 0x08, 0x09, 0x0A, 0x0C, 0x0D, 0x0E, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //2133
+	{0x00, 0x01, 0x02, 0x04, 0x08, 0x09, 0x0A, 0x0C, 0x0D, 0x0E, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //3133
+	{0x00, 0x04, 0x05, 0x08, 0x09, 0x0A, 0x0C, 0x0D, 0x0E, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //1233
+	{0x00, 0x01, 0x04, 0x05, 0x08, 0x09, 0x0A, 0x0C, 0x0D, 0x0E, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //2233
+	{0x00, 0x01, 0x02, 0x04, 0x05, 0x08, 0x09, 0x0A, 0x0C, 0x0D, 0x0E, 0x80, 0x80, 0x80, 0x80, 0x80}, //3233
+	{0x00, 0x04, 0x05, 0x06, 0x08, 0x09, 0x0A, 0x0C, 0x0D, 0x0E, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}, //1333
+	{0x00, 0x01, 0x04, 0x05, 0x06, 0x08, 0x09, 0x0A, 0x0C, 0x0D, 0x0E, 0x80, 0x80, 0x80, 0x80, 0x80}, //2333
+	{0x00, 0x01, 0x02, 0x04, 0x05, 0x06, 0x08, 0x09, 0x0A, 0x0C, 0x0D, 0x0E, 0x80, 0x80, 0x80, 0x80}, //3333
+};
+
+//NOTE: Encodes 4 codepoints below U+10000 (and not surrogates) with one shuffle. Always stores 16 bytes, returns how many of them are used (4-12).
+EASY_STRING_TARGET("ssse3") EASY_STRING_FORCE_INLINE static int easyUnicode_encode4_ssse3(__m128i codepoints, unsigned char *out) {
+	__m128i low6 = _mm_or_si128(_mm_and_si128(codepoints, _mm_set1_epi32(0x3F)), _mm_set1_epi32(0x80));
+	__m128i mid6 = _mm_or_si128(_mm_and_si128(_mm_srli_epi32(codepoints, 6), _mm_set1_epi32(0x3F)), _mm_set1_epi32(0x80));
+	__m128i two = _mm_or_si128(_mm_or_si128(_mm_srli_epi32(codepoints, 6), _mm_set1_epi32(0xC0)), _mm_slli_epi32(low6, 8));
+	__m128i three = _mm_or_si128(_mm_or_si128(_mm_srli_epi32(codepoints, 12), _mm_set1_epi32(0xE0)), _mm_or_si128(_mm_slli_epi32(mid6, 8), _mm_slli_epi32(low6, 16)));
+
+	__m128i atLeast2 = _mm_cmpgt_epi32(codepoints, _mm_set1_epi32(0x7F));
+	__m128i atLeast3 = _mm_cmpgt_epi32(codepoints, _mm_set1_epi32(0x7FF));
+	__m128i multiByte = _mm_or_si128(_mm_andnot_si128(atLeast3, two), _mm_and_si128(atLeast3, three));
+	__m128i lanes = _mm_or_si128(_mm_andnot_si128(atLeast2, codepoints), _mm_and_si128(atLeast2, multiByte));
+
+	int mask2 = _mm_movemask_ps(_mm_castsi128_ps(atLeast2));
+	int mask3 = _mm_movemask_ps(_mm_castsi128_ps(atLeast3));
+	int index = easyUnicode_base3Table[mask2] + easyUnicode_base3Table[mask3];
+	_mm_storeu_si128((__m128i *)out, _mm_shuffle_epi8(lanes, _mm_loadu_si128((__m128i *)easyUnicode_utf8PackTable[index])));
+	return 4 + easyUnicode_bitCountTable[mask2] + easyUnicode_bitCountTable[mask3];
+}
+
+//NOTE: all 4 lanes are valid codepoints below U+10000
+EASY_STRING_TARGET("sse2") EASY_STRING_FORCE_INLINE static int easyUnicode_isBmp4_sse2(__m128i codepoints) {
+	__m128i inRange = _mm_and_si128(_mm_cmpgt_epi32(codepoints, _mm_set1_epi32(-1)), _mm_cmpgt_epi32(_mm_set1_epi32(0x10000), codepoints));
+	__m128i surrogate = _mm_and_si128(_mm_cmpgt_epi32(codepoints, _mm_set1_epi32(0xD7FF)), _mm_cmpgt_epi32(_mm_set1_epi32(0xE000), codepoints));
+	return _mm_movemask_ps(_mm_castsi128_ps(_mm_andnot_si128(surrogate, inRange))) == 0xF;
+}
+
+//NOTE: 8 units with no surrogates in them
+EASY_STRING_TARGET("sse2") EASY_STRING_FORCE_INLINE static int easyUnicode_noSurrogates8_sse2(__m128i units) {
+	__m128i surrogate = _mm_cmpeq_epi16(_mm_and_si128(units, _mm_set1_epi16((short)0xF800)), _mm_set1_epi16((short)0xD800));
+	return _mm_movemask_epi8(surrogate) == 0;
+}
+
+//NOTE: 8 codepoints below U+10000 down to 16 bits. packs saturates as signed, so shift the range down first and back after.
+EASY_STRING_TARGET("sse2") EASY_STRING_FORCE_INLINE static __m128i easyUnicode_narrow8_sse2(__m128i a, __m128i b) {
+	__m128i bias = _mm_set1_epi32(0x8000);
+	__m128i packed = _mm_packs_epi32(_mm_sub_epi32(a, bias), _mm_sub_epi32(b, bias));
+	return _mm_add_epi16(packed, _mm_set1_epi16((short)0x8000));
+}
+
+//NOTE: The fast paths convert everything they can and stop at the first thing they can't (4 byte sequences, anything invalid, too little room left). 
+//The callers do one codepoint the slow way and then try again.
+
+EASY_STRING_TARGET("sse2") static size_t easyUnicode_utf32ToUtf8_sse2(unsigned int *src, size_t srcLen, unsigned char *dst, size_t dstCap, size_t *srcUsed) {
+	size_t srcAt = 0;
+	size_t dstAt = 0;
+	//NOTE: no shuffles, so only runs of ascii
+	while(srcAt + 8 <= srcLen && dstAt + 8 <= dstCap) {
+		__m128i a = _mm_loadu_si128((__m128i *)(src + srcAt));
+		__m128i b = _mm_loadu_si128((__m128i *)(src + srcAt + 4));
+		if(_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(_mm_or_si128(a, b), _mm_set1_epi32(~0x7F)), _mm_setzero_si128())) != 0xFFFF) break;
+		__m128i bytes = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_setzero_si128());
+		_mm_storel_epi64((__m128i *)(dst + dstAt), bytes);
+		srcAt += 8;
+		dstAt += 8;
+	}
+	*srcUsed = srcAt;
+	return dstAt;
+}
+
+EASY_STRING_TARGET("ssse3") static size_t easyUnicode_utf32ToUtf8_ssse3(unsigned int *src, size_t srcLen, unsigned char *dst, size_t dstCap, size_t *srcUsed) {
+	size_t srcAt = 0;
+	size_t dstAt = 0;
+	while(srcAt + 4 <= srcLen && dstAt + 16 <= dstCap) {
+		__m128i a = _mm_loadu_si128((__m128i *)(src + srcAt));
+		if(srcAt + 8 <= srcLen) {
+			//NOTE: runs of ascii 8 at a time without the shuffle
+			__m128i b = _mm_loadu_si128((__m128i *)(src + srcAt + 4));
+			if(_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(_mm_or_si128(a, b), _mm_set1_epi32(~0x7F)), _mm_setzero_si128())) == 0xFFFF) {
+				_mm_storel_epi64((__m128i *)(dst + dstAt), _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_setzero_si128()));
+				srcAt += 8;
+				dstAt += 8;
+				continue;
+			}
+		}
+		if(!easyUnicode_isBmp4_sse2(a)) break;
+		dstAt += easyUnicode_encode4_ssse3(a, dst + dstAt);
+		srcAt += 4;
+	}
+	*srcUsed = srcAt;
+	return dstAt;
+}
+
+EASY_STRING_TARGET("sse2") static size_t easyUnicode_utf16ToUtf8_sse2(unsigned short *src, size_t srcLen, unsigned char *dst, size_t dstCap, size_t *srcUsed) {
+	size_t srcAt = 0;
+	size_t dstAt = 0;
+	while(srcAt + 8 <= srcLen && dstAt + 8 <= dstCap) {
+		__m128i units = _mm_loadu_si128((__m128i *)(src + srcAt));
+		if(_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(units, _mm_set1_epi16(~0x7F)), _mm_setzero_si128())) != 0xFFFF) break;
+		_mm_storel_epi64((__m128i *)(dst + dstAt), _mm_packus_epi16(units, units));
+		srcAt += 8;
+		dstAt += 8;
+	}
+	*srcUsed = srcAt;
+	return dstAt;
+}
+
+EASY_STRING_TARGET("ssse3") static size_t easyUnicode_utf16ToUtf8_ssse3(unsigned short *src, size_t srcLen, unsigned char *dst, size_t dstCap, size_t *srcUsed) {
+	size_t srcAt = 0;
+	size_t dstAt = 0;
+	__m128i zero = _mm_setzero_si128();
+	//NOTE: 8 units can be up to 24 bytes, the second store of 16 starts at most 12 in
+	while(srcAt + 8 <= srcLen && dstAt + 28 <= dstCap) {
+		__m128i units = _mm_loadu_si128((__m128i *)(src + srcAt));
+		if(_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(units, _mm_set1_epi16(~0x7F)), zero)) == 0xFFFF) {
+			_mm_storel_epi64((__m128i *)(dst + dstAt), _mm_packus_epi16(units, units));
+			dstAt += 8;
+		} else {
+			if(!easyUnicode_noSurrogates8_sse2(units)) break;
+			dstAt += easyUnicode_encode4_ssse3(_mm_unpacklo_epi16(units, zero), dst + dstAt);
+			dstAt += easyUnicode_encode4_ssse3(_mm_unpackhi_epi16(units, zero), dst + dstAt);
+		}
+		srcAt += 8;
+	}
+	*srcUsed = srcAt;
+	return dstAt;
+}
+
+//NOTE: src has to be valid utf8 (checked by the caller)
+EASY_STRING_TARGET("sse2") static size_t easyUnicode_utf8ToUtf16_sse2(unsigned char *src, size_t srcLen, unsigned short *dst, size_t dstCap, size_t *srcUsed) {
+	size_t srcAt = 0;
+	size_t dstAt = 0;
+	__m128i zero = _mm_setzero_si128();
+	while(srcAt + 16 <= srcLen && dstAt + 16 <= dstCap) {
+		__m128i in = _mm_loadu_si128((__m128i *)(src + srcAt));
+		if(_mm_movemask_epi8(in)) break;
+		_mm_storeu_si128((__m128i *)(dst + dstAt), _mm_unpacklo_epi8(in, zero));
+		_mm_storeu_si128((__m128i *)(dst + dstAt + 8), _mm_unpackhi_epi8(in, zero));
+		srcAt += 16;
+		dstAt += 16;
+	}
+	*srcUsed = srcAt;
+	return dstAt;
+}
+
+EASY_STRING_TARGET("ssse3") static size_t easyUnicode_utf8ToUtf16_ssse3(unsigned char *src, size_t srcLen, unsigned short *dst, size_t dstCap, size_t *srcUsed) {
+	size_t srcAt = 0;
+	size_t dstAt = 0;
+	__m128i zero = _mm_setzero_si128();
+	unsigned int decoded[4];
+	while(srcAt + 16 <= srcLen && dstAt + 16 <= dstCap) {
+		__m128i in = _mm_loadu_si128((__m128i *)(src + srcAt));
+		if(!_mm_movemask_epi8(in)) {
+			_mm_storeu_si128((__m128i *)(dst + dstAt), _mm_unpacklo_epi8(in, zero));
+			_mm_storeu_si128((__m128i *)(dst + dstAt + 8), _mm_unpackhi_epi8(in, zero));
+			srcAt += 16;
+			dstAt += 16;
+			continue;
+		}
+		//NOTE: decode4 only takes 1-3 byte sequences, so everything it gives back fits in one unit
+		int used = easyUnicode_decode4_ssse3(src + srcAt, in, decoded);
+		if(!used) break;
+		__m128i codepoints = _mm_loadu_si128((__m128i *)decoded);
+		_mm_storel_epi64((__m128i *)(dst + dstAt), easyUnicode_narrow8_sse2(codepoints, codepoints));
+		srcAt += (size_t)used;
+		dstAt += 4;
+	}
+	*srcUsed = srcAt;
+	return dstAt;
+}
+
+EASY_STRING_TARGET("sse2") static size_t easyUnicode_utf16ToUtf32_sse2(unsigned short *src, size_t srcLen, unsigned int *dst, size_t dstCap, size_t *srcUsed) {
+	size_t at = 0;
+	__m128i zero = _mm_setzero_si128();
+	while(at + 8 <= srcLen && at + 8 <= dstCap) {
+		__m128i units = _mm_loadu_si128((__m128i *)(src + at));
+		if(!easyUnicode_noSurrogates8_sse2(units)) break;
+		_mm_storeu_si128((__m128i *)(dst + at), _mm_unpacklo_epi16(units, zero));
+		_mm_storeu_si128((__m128i *)(dst + at + 4), _mm_unpackhi_epi16(units, zero));
+		at += 8;
+	}
+	*srcUsed = at;
+	return at;
+}
+
+EASY_STRING_TARGET("avx2") static size_t easyUnicode_utf16ToUtf32_avx2(unsigned short *src, size_t srcLen, unsigned int *dst, size_t dstCap, size_t *srcUsed) {
+	size_t at = 0;
+	while(at + 16 <= srcLen && at + 16 <= dstCap) {
+		__m256i units = _mm256_loadu_si256((__m256i *)(src + at));
+		__m256i surrogate = _mm256_cmpeq_epi16(_mm256_and_si256(units, _mm256_set1_epi16((short)0xF800)), _mm256_set1_epi16((short)0xD800));
+		if(_mm256_movemask_epi8(surrogate)) break;
+		_mm256_storeu_si256((__m256i *)(dst + at), _mm256_cvtepu16_epi32(_mm256_castsi256_si128(units)));
+		_mm256_storeu_si256((__m256i *)(dst + at + 8), _mm256_cvtepu16_epi32(_mm256_extracti128_si256(units, 1)));
+		at += 16;
+	}
+	*srcUsed = at;
+	return at;
+}
+
+EASY_STRING_TARGET("sse2") static size_t easyUnicode_utf32ToUtf16_sse2(unsigned int *src, size_t srcLen, unsigned short *dst, size_t dstCap, size_t *srcUsed) {
+	size_t at = 0;
+	while(at + 8 <= srcLen && at + 8 <= dstCap) {
+		__m128i a = _mm_loadu_si128((__m128i *)(src + at));
+		__m128i b = _mm_loadu_si128((__m128i *)(src + at + 4));
+		if(!easyUnicode_isBmp4_sse2(a) || !easyUnicode_isBmp4_sse2(b)) break;
+		_mm_storeu_si128((__m128i *)(dst + at), easyUnicode_narrow8_sse2(a, b));
+		at += 8;
+	}
+	*srcUsed = at;
+	return at;
+}
+
+EASY_STRING_TARGET("avx2") static size_t easyUnicode_utf32ToUtf16_avx2(unsigned int *src, size_t srcLen, unsigned short *dst, size_t dstCap, size_t *srcUsed) {
+	size_t at = 0;
+	__m256i bias = _mm256_set1_epi32(0x8000);
+	while(at + 16 <= srcLen && at + 16 <= dstCap) {
+		__m256i a = _mm256_loadu_si256((__m256i *)(src + at));
+		__m256i b = _mm256_loadu_si256((__m256i *)(src + at + 8));
+		__m256i inRange = _mm256_and_si256(_mm256_and_si256(_mm256_cmpgt_epi32(a, _mm256_set1_epi32(-1)), _mm256_cmpgt_epi32(_mm256_set1_epi32(0x10000), a)), 
+		                                   _mm256_and_si256(_mm256_cmpgt_epi32(b, _mm256_set1_epi32(-1)), _mm256_cmpgt_epi32(_mm256_set1_epi32(0x10000), b)));
+		__m256i surrogate = _mm256_or_si256(_mm256_and_si256(_mm256_cmpgt_epi32(a, _mm256_set1_epi32(0xD7FF)), _mm256_cmpgt_epi32(_mm256_set1_epi32(0xE000), a)), 
+		                                    _mm256_and_si256(_mm256_cmpgt_epi32(b, _mm256_set1_epi32(0xD7FF)), _mm256_cmpgt_epi32(_mm256_set1_epi32(0xE000), b)));
+		if(_mm256_movemask_epi8(_mm256_andnot_si256(surrogate, inRange)) != -1) break;
+		//NOTE: packs works within each 128 bit half, the permute puts the 64 bit quarters back in order
+		__m256i packed = _mm256_packs_epi32(_mm256_sub_epi32(a, bias), _mm256_sub_epi32(b, bias));
+		packed = _mm256_add_epi16(_mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)), _mm256_set1_epi16((short)0x8000));
+		_mm256_storeu_si256((__m256i *)(dst + at), packed);
+		at += 16;
+	}
+	*srcUsed = at;
+	return at;
+}
+
+#endif // EASY_STRING_X86
+
+static size_t easyUnicode_utf32ToUtf8_fast_(unsigned int *src, size_t srcLen, unsigned char *dst, size_t dstCap, size_t *srcUsed) {
+#if EASY_STRING_X86
+	EasyString_SimdLevel level = easyString_getSimdLevel();
+	if(level >= EASY_STRING_SIMD_SSSE3) return easyUnicode_utf32ToUtf8_ssse3(src, srcLen, dst, dstCap, srcUsed);
+	if(level >= EASY_STRING_SIMD_SSE2) return easyUnicode_utf32ToUtf8_sse2(src, srcLen, dst, dstCap, srcUsed);
+#endif
+	size_t at = 0;
+	while(at < srcLen && at < dstCap && src[at] < 0x80) {
+		dst[at] = (unsigned char)src[at];
+		at++;
+	}
+	*srcUsed = at;
+	return at;
+}
+
+static size_t easyUnicode_utf16ToUtf8_fast_(unsigned short *src, size_t srcLen, unsigned char *dst, size_t dstCap, size_t *srcUsed) {
+#if EASY_STRING_X86
+	EasyString_SimdLevel level = easyString_getSimdLevel();
+	if(level >= EASY_STRING_SIMD_SSSE3) return easyUnicode_utf16ToUtf8_ssse3(src, srcLen, dst, dstCap, srcUsed);
+	if(level >= EASY_STRING_SIMD_SSE2) return easyUnicode_utf16ToUtf8_sse2(src, srcLen, dst, dstCap, srcUsed);
+#endif
+	size_t at = 0;
+	while(at < srcLen && at < dstCap && src[at] < 0x80) {
+		dst[at] = (unsigned char)src[at];
+		at++;
+	}
+	*srcUsed = at;
+	return at;
+}
+
+static size_t easyUnicode_utf8ToUtf16_fast_(unsigned char *src, size_t srcLen, unsigned short *dst, size_t dstCap, size_t *srcUsed) {
+#if EASY_STRING_X86
+	EasyString_SimdLevel level = easyString_getSimdLevel();
+	if(level >= EASY_STRING_SIMD_SSSE3) return easyUnicode_utf8ToUtf16_ssse3(src, srcLen, dst, dstCap, srcUsed);
+	if(level >= EASY_STRING_SIMD_SSE2) return easyUnicode_utf8ToUtf16_sse2(src, srcLen, dst, dstCap, srcUsed);
+#endif
+	size_t at = 0;
+	while(at < srcLen && at < dstCap && src[at] < 0x80) {
+		dst[at] = src[at];
+		at++;
+	}
+	*srcUsed = at;
+	return at;
+}
+
+static size_t easyUnicode_utf16ToUtf32_fast_(unsigned short *src, size_t srcLen, unsigned int *dst, size_t dstCap, size_t *srcUsed) {
+#if EASY_STRING_X86
+	EasyString_SimdLevel level = easyString_getSimdLevel();
+	if(level >= EASY_STRING_SIMD_AVX2) return easyUnicode_utf16ToUtf32_avx2(src, srcLen, dst, dstCap, srcUsed);
+	if(level >= EASY_STRING_SIMD_SSE2) return easyUnicode_utf16ToUtf32_sse2(src, srcLen, dst, dstCap, srcUsed);
+#endif
+	size_t at = 0;
+	while(at < srcLen && at < dstCap && (src[at] & 0xF800) != 0xD800) {
+		dst[at] = src[at];
+		at++;
+	}
+	*srcUsed = at;
+	return at;
+}
+
+static size_t easyUnicode_utf32ToUtf16_fast_(unsigned int *src, size_t srcLen, unsigned short *dst, size_t dstCap, size_t *srcUsed) {
+#if EASY_STRING_X86
+	EasyString_SimdLevel level = easyString_getSimdLevel();
+	if(level >= EASY_STRING_SIMD_AVX2) return easyUnicode_utf32ToUtf16_avx2(src, srcLen, dst, dstCap, srcUsed);
+	if(level >= EASY_STRING_SIMD_SSE2) return easyUnicode_utf32ToUtf16_sse2(src, srcLen, dst, dstCap, srcUsed);
+#endif
+	size_t at = 0;
+	while(at < srcLen && at < dstCap && src[at] < 0xD800) {
+		dst[at] = (unsigned short)src[at];
+		at++;
+	}
+	*srcUsed = at;
+	return at;
+}
+
+EasyUnicode_Result easyUnicode_utf32ToUtf8(unsigned int *src, size_t srcLen, char *dst, size_t dstCap, EasyUnicode_InvalidPolicy policy) {
+	EasyUnicode_Result result;
+	memset(&result, 0, sizeof(result));
+	unsigned char *out = (unsigned char *)dst;
+	while(result.codeUnitsConsumed < srcLen) {
+		size_t used = 0;
+		result.codeUnitsWritten += easyUnicode_utf32ToUtf8_fast_(src + result.codeUnitsConsumed, srcLen - result.codeUnitsConsumed, out + result.codeUnitsWritten, dstCap - result.codeUnitsWritten, &used);
+		result.codeUnitsConsumed += used;
+		if(result.codeUnitsConsumed == srcLen) break;
+
+		unsigned int codepoint = src[result.codeUnitsConsumed];
+		EasyUnicode_Error error = easyUnicode_checkCodepoint_(codepoint);
+		if(error != EASY_UNICODE_ERROR_NONE) {
+			if(!easyUnicode_handleInvalid_(&result, error, policy)) return result;
+			codepoint = EASY_UNICODE_REPLACEMENT_CHARACTER;
+		}
+		if((size_t)easyUnicode_utf8Length_(codepoint) > dstCap - result.codeUnitsWritten) {
+			result.status = EASY_UNICODE_OUTPUT_FULL;
+			return result;
+		}
+		result.codeUnitsWritten += easyUnicode_encodeUtf8_(codepoint, out + result.codeUnitsWritten);
+		result.codeUnitsConsumed++;
+	}
+	result.status = EASY_UNICODE_OK;
+	return result;
+}
+
+EasyUnicode_Result easyUnicode_utf16ToUtf8(unsigned short *src, size_t srcLen, char *dst, size_t dstCap, EasyUnicode_InvalidPolicy policy) {
+	EasyUnicode_Result result;
+	memset(&result, 0, sizeof(result));
+	unsigned char *out = (unsigned char *)dst;
+	while(result.codeUnitsConsumed < srcLen) {
+		size_t used = 0;
+		result.codeUnitsWritten += easyUnicode_utf16ToUtf8_fast_(src + result.codeUnitsConsumed, srcLen - result.codeUnitsConsumed, out + result.codeUnitsWritten, dstCap - result.codeUnitsWritten, &used);
+		result.codeUnitsConsumed += used;
+		if(result.codeUnitsConsumed == srcLen) break;
+
+		EasyUnicode_Error error;
+		unsigned int codepoint = easyUnicode_readUtf16_(src + result.codeUnitsConsumed, srcLen - result.codeUnitsConsumed, &used, &error);
+		if(error != EASY_UNICODE_ERROR_NONE && !easyUnicode_handleInvalid_(&result, error, policy)) return result;
+		if((size_t)easyUnicode_utf8Length_(codepoint) > dstCap - result.codeUnitsWritten) {
+			result.status = EASY_UNICODE_OUTPUT_FULL;
+			return result;
+		}
+		result.codeUnitsWritten += easyUnicode_encodeUtf8_(codepoint, out + result.codeUnitsWritten);
+		result.codeUnitsConsumed += used;
+	}
+	result.status = EASY_UNICODE_OK;
+	return result;
+}
+
+EasyUnicode_Result easyUnicode_utf8ToUtf16(char *src, size_t srcLen, unsigned short *dst, size_t dstCap, EasyUnicode_InvalidPolicy policy) {
+	EasyUnicode_Result result;
+	memset(&result, 0, sizeof(result));
+	unsigned char *at = (unsigned char *)src;
+
+	while(result.codeUnitsConsumed < srcLen) {
+		//NOTE: same windowing as easyUnicode_utf8ToUtf32_validating, a codepoint never needs more than 4 bytes per unit written
+		size_t window = srcLen - result.codeUnitsConsumed;
+		size_t room = dstCap - result.codeUnitsWritten;
+		if(room < window / 4) { window = room*4 + 3; }
+
+		EasyUnicode_Error error;
+		size_t errorLength;
+		size_t validEnd = result.codeUnitsConsumed + easyUnicode_findUtf8Error_(at + result.codeUnitsConsumed, window, &error, &errorLength);
+
+		while(result.codeUnitsConsumed < validEnd) {
+			size_t used = 0;
+			result.codeUnitsWritten += easyUnicode_utf8ToUtf16_fast_(at + result.codeUnitsConsumed, validEnd - result.codeUnitsConsumed, dst + result.codeUnitsWritten, dstCap - result.codeUnitsWritten, &used);
+			result.codeUnitsConsumed += used;
+			if(result.codeUnitsConsumed == validEnd) break;
+
+			char *next = (char *)at + result.codeUnitsConsumed;
+			char *read = next;
+			unsigned int codepoint = easyUnicode_utf8_codepoint_To_Utf32_codepoint(&read, 1);
+			size_t units = (codepoint >= 0x10000) ? 2 : 1;
+			if(units > dstCap - result.codeUnitsWritten) {
+				result.status = EASY_UNICODE_OUTPUT_FULL;
+				return result;
+			}
+			if(units == 2) {
+				dst[result.codeUnitsWritten++] = (unsigned short)(0xD800 + ((codepoint - 0x10000) >> 10));
+				dst[result.codeUnitsWritten++] = (unsigned short)(0xDC00 + ((codepoint - 0x10000) & 0x3FF));
+			} else {
+				dst[result.codeUnitsWritten++] = (unsigned short)codepoint;
+			}
+			result.codeUnitsConsumed += (size_t)(read - next);
+		}
+		if(result.codeUnitsWritten == dstCap && result.codeUnitsConsumed < srcLen) {
+			//NOTE: the window may have been cut short part way through a codepoint, that isn't an error
+			result.status = EASY_UNICODE_OUTPUT_FULL;
+			return result;
+		}
+		if(error == EASY_UNICODE_ERROR_NONE) continue;
+
+		if(!easyUnicode_handleInvalid_(&result, error, policy)) return result;
+		if(result.codeUnitsWritten == dstCap) {
+			result.status = EASY_UNICODE_OUTPUT_FULL;
+			return result;
+		}
+		dst[result.codeUnitsWritten++] = EASY_UNICODE_REPLACEMENT_CHARACTER;
+		result.codeUnitsConsumed += errorLength;
+	}
+	result.status = EASY_UNICODE_OK;
+	return result;
+}
+
+EasyUnicode_Result easyUnicode_utf16ToUtf32(unsigned short *src, size_t srcLen, unsigned int *dst, size_t dstCap, EasyUnicode_InvalidPolicy policy) {
+	EasyUnicode_Result result;
+	memset(&result, 0, sizeof(result));
+	while(result.codeUnitsConsumed < srcLen) {
+		size_t used = 0;
+		result.codeUnitsWritten += easyUnicode_utf16ToUtf32_fast_(src + result.codeUnitsConsumed, srcLen - result.codeUnitsConsumed, dst + result.codeUnitsWritten, dstCap - result.codeUnitsWritten, &used);
+		result.codeUnitsConsumed += used;
+		if(result.codeUnitsConsumed == srcLen) break;
+
+		EasyUnicode_Error error;
+		unsigned int codepoint = easyUnicode_readUtf16_(src + result.codeUnitsConsumed, srcLen - result.codeUnitsConsumed, &used, &error);
+		if(error != EASY_UNICODE_ERROR_NONE && !easyUnicode_handleInvalid_(&result, error, policy)) return result;
+		if(result.codeUnitsWritten == dstCap) {
+			result.status = EASY_UNICODE_OUTPUT_FULL;
+			return result;
+		}
+		dst[result.codeUnitsWritten++] = codepoint;
+		result.codeUnitsConsumed += used;
+	}
+	result.status = EASY_UNICODE_OK;
+	return result;
+}
+
+EasyUnicode_Result easyUnicode_utf32ToUtf16(unsigned int *src, size_t srcLen, unsigned short *dst, size_t dstCap, EasyUnicode_InvalidPolicy policy) {
+	EasyUnicode_Result result;
+	memset(&result, 0, sizeof(result));
+	while(result.codeUnitsConsumed < srcLen) {
+		size_t used = 0;
+		result.codeUnitsWritten += easyUnicode_utf32ToUtf16_fast_(src + result.codeUnitsConsumed, srcLen - result.codeUnitsConsumed, dst + result.codeUnitsWritten, dstCap - result.codeUnitsWritten, &used);
+		result.codeUnitsConsumed += used;
+		if(result.codeUnitsConsumed == srcLen) break;
+
+		unsigned int codepoint = src[result.codeUnitsConsumed];
+		EasyUnicode_Error error = easyUnicode_checkCodepoint_(codepoint);
+		if(error != EASY_UNICODE_ERROR_NONE) {
+			if(!easyUnicode_handleInvalid_(&result, error, policy)) return result;
+			codepoint = EASY_UNICODE_REPLACEMENT_CHARACTER;
+		}
+		size_t units = (codepoint >= 0x10000) ? 2 : 1;
+		if(units > dstCap - result.codeUnitsWritten) {
+			result.status = EASY_UNICODE_OUTPUT_FULL;
+			return result;
+		}
+		if(units == 2) {
+			dst[result.codeUnitsWritten++] = (unsigned short)(0xD800 + ((codepoint - 0x10000) >> 10));
+			dst[result.codeUnitsWritten++] = (unsigned short)(0xDC00 + ((codepoint - 0x10000) & 0x3FF));
+		} else {
+			dst[result.codeUnitsWritten++] = (unsigned short)codepoint;
+		}
+		result.codeUnitsConsumed++;
+	}
+	result.status = EASY_UNICODE_OK;
+	return result;
+}
+
+//NOTE: The sizes are exact for EASY_UNICODE_REPLACE_INVALID (every bad codepoint or sequence is one U+FFFD). 
+//EASY_UNICODE_STOP_ON_INVALID writes a prefix of that so they're enough for it too.
+
+size_t easyUnicode_utf32ToUtf8_requiredSize(unsigned int *src, size_t srcLen) {
+	size_t result = 0;
+	for(size_t i = 0; i < srcLen; ++i) {
+		unsigned int codepoint = src[i];
+		//NOTE: branch free so the compiler can vectorize it. Surrogates are 3 bytes either way, anything too large is replaced by 3 bytes not 4
+		result += 1 + (codepoint >= 0x80) + (codepoint >= 0x800) + (codepoint >= 0x10000) - (codepoint > 0x10FFFF);
+	}
+	return result;
+}
+
+size_t easyUnicode_utf16ToUtf8_requiredSize(unsigned short *src, size_t srcLen) {
+	size_t result = 0;
+	size_t i = 0;
+	while(i < srcLen) {
+		unsigned int unit = src[i];
+		if((unit & 0xF800) != 0xD800) {
+			result += 1 + (unit >= 0x80) + (unit >= 0x800);
+			i++;
+		} else if(unit < 0xDC00 && i + 1 < srcLen && (src[i + 1] & 0xFC00) == 0xDC00) {
+			result += 4;
+			i += 2;
+		} else {
+			result += 3; //U+FFFD
+			i++;
+		}
+	}
+	return result;
+}
+
+size_t easyUnicode_utf8ToUtf16_requiredSize(char *src, size_t srcLen) {
+	unsigned char *at = (unsigned char *)src;
+	EasyString_Utf8Validation validation = easyString_validate_utf8(src, srcLen);
+	if(validation.valid) {
+		//NOTE: one unit per codepoint, and a second for every 4 byte sequence (lead byte 0xF0 or above)
+		size_t result = easyUnicode_countCodepoints_(at, srcLen);
+		size_t i = 0;
+		for(; i + 8 <= srcLen; i += 8) {
+			unsigned long long x;
+			memcpy(&x, at + i, 8);
+			unsigned long long fourByteLeads = ((x & (x << 1) & (x << 2) & (x << 3)) & 0x8080808080808080ULL) >> 7;
+			result += (size_t)((fourByteLeads*0x0101010101010101ULL) >> 56);
+		}
+		for(; i < srcLen; ++i) { result += (at[i] >= 0xF0); }
+		return result;
+	}
+
+	//NOTE: has bad sequences in it, count them the same way the converter replaces them
+	size_t result = 0;
+	char *stream = src;
+	char *end = src + srcLen;
+	while(stream < end) {
+		unsigned int codepoint = easyUnicode_utf8_codepoint_To_Utf32_codepoint_validated(&stream, end, 0);
+		result += (codepoint >= 0x10000) ? 2 : 1;
+	}
+	return result;
+}
+
+size_t easyUnicode_utf16ToUtf32_requiredSize(unsigned short *src, size_t srcLen) {
+	size_t result = srcLen;
+	for(size_t i = 0; i + 1 < srcLen; ++i) {
+		if((src[i] & 0xFC00) == 0xD800 && (src[i + 1] & 0xFC00) == 0xDC00) {
+			result--;
+			i++;
+		}
+	}
+	return result;
+}
+
+size_t easyUnicode_utf32ToUtf16_requiredSize(unsigned int *src, size_t srcLen) {
+	size_t result = srcLen;
+	for(size_t i = 0; i < srcLen; ++i) {
+		result += (src[i] >= 0x10000 && src[i] <= 0x10FFFF);
+	}
+	return result;
+}
+
+///////////////////////*********** Comparing **************////////////////////
+
+//NOTE: Index of the first byte that differs, or len if they're the same
+inline static size_t easyString_firstDifference_scalar(unsigned char *a, unsigned char *b, size_t len) {
+	size_t at = 0;
+#if EASY_STRING_LITTLE_ENDIAN
+	//NOTE: the last word is loaded overlapping instead of finishing with a byte loop. The overlap already matched so the first difference is still the first.
+	if(len >= 8) {
+		unsigned long long x, y;
+		while(at + 8 <= len) {
+			memcpy(&x, a + at, 8);
+			memcpy(&y, b + at, 8);
+			if(x != y) return at + (easyString_ctz64(x ^ y) >> 3);
+			at += 8;
+		}
+		if(at == len) return len;
+		at = len - 8;
+		memcpy(&x, a + at, 8);
+		memcpy(&y, b + at, 8);
+		return (x != y) ? at + (easyString_ctz64(x ^ y) >> 3) : len;
+	} else if(len >= 4) {
+		unsigned int x, y;
+		memcpy(&x, a, 4);
+		memcpy(&y, b, 4);
+		if(x != y) return easyString_ctz32(x ^ y) >> 3;
+		at = len - 4;
+		memcpy(&x, a + at, 4);
+		memcpy(&y, b + at, 4);
+		return (x != y) ? at + (easyString_ctz32(x ^ y) >> 3) : len;
+	}
+#endif
+	while(at < len && a[at] == b[at]) { at++; }
+	return at;
+}
+
+#if EASY_STRING_X86
+
+//NOTE: len has to be at least 16
+EASY_STRING_TARGET("sse2") static size_t easyString_firstDifference_sse2(unsigned char *a, unsigned char *b, size_t len) {
+	size_t at = 0;
+	while(at + 64 <= len) {
+		__m128i e0 = _mm_cmpeq_epi8(_mm_loadu_si128((__m128i *)(a + at + 0)), _mm_loadu_si128((__m128i *)(b + at + 0)));
+		__m128i e1 = _mm_cmpeq_epi8(_mm_loadu_si128((__m128i *)(a + at + 16)), _mm_loadu_si128((__m128i *)(b + at + 16)));
+		__m128i e2 = _mm_cmpeq_epi8(_mm_loadu_si128((__m128i *)(a + at + 32)), _mm_loadu_si128((__m128i *)(b + at + 32)));
+		__m128i e3 = _mm_cmpeq_epi8(_mm_loadu_si128((__m128i *)(a + at + 48)), _mm_loadu_si128((__m128i *)(b + at + 48)));
+		if(_mm_movemask_epi8(_mm_and_si128(_mm_and_si128(e0, e1), _mm_and_si128(e2, e3))) != 0xFFFF) break; //the 16 byte loop finds which one
+		at += 64;
+	}
+	while(at + 16 <= len) {
+		unsigned int diff = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((__m128i *)(a + at)), _mm_loadu_si128((__m128i *)(b + at)))) ^ 0xFFFF;
+		if(diff) return at + easyString_ctz32(diff);
+		at += 16;
+	}
+	if(at < len) {
+		at = len - 16;
+		unsigned int diff = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((__m128i *)(a + at)), _mm_loadu_si128((__m128i *)(b + at)))) ^ 0xFFFF;
+		if(diff) return at + easyString_ctz32(diff);
+	}
+	return len;
+}
+
+//NOTE: len has to be at least 32
+EASY_STRING_TARGET("avx2") static size_t easyString_firstDifference_avx2(unsigned char *a, unsigned char *b, size_t len) {
+	size_t at = 0;
+	while(at + 128 <= len) {
+		__m256i e0 = _mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i *)(a + at + 0)), _mm256_loadu_si256((__m256i *)(b + at + 0)));
+		__m256i e1 = _mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i *)(a + at + 32)), _mm256_loadu_si256((__m256i *)(b + at + 32)));
+		__m256i e2 = _mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i *)(a + at + 64)), _mm256_loadu_si256((__m256i *)(b + at + 64)));
+		__m256i e3 = _mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i *)(a + at + 96)), _mm256_loadu_si256((__m256i *)(b + at + 96)));
+		if(_mm256_movemask_epi8(_mm256_and_si256(_mm256_and_si256(e0, e1), _mm256_and_si256(e2, e3))) != -1) break;
+		at += 128;
+	}
+	while(at + 32 <= len) {
+		unsigned int diff = ~(unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i *)(a + at)), _mm256_loadu_si256((__m256i *)(b + at))));
+		if(diff) return at + easyString_ctz32(diff);
+		at += 32;
+	}
+	if(at < len) {
+		at = len - 32;
+		unsigned int diff = ~(unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i *)(a + at)), _mm256_loadu_si256((__m256i *)(b + at))));
+		if(diff) return at + easyString_ctz32(diff);
+	}
+	return len;
+}
+
+//NOTE: How many bytes from a and from b can be read before either gets to the end of its page
+EASY_STRING_FORCE_INLINE static size_t easyString_pageRoom_(unsigned char *a, unsigned char *b) {
+	size_t roomA = EASY_STRING_PAGE_SIZE - ((size_t)a % EASY_STRING_PAGE_SIZE);
+	size_t roomB = EASY_STRING_PAGE_SIZE - ((size_t)b % EASY_STRING_PAGE_SIZE);
+	return (roomA < roomB) ? roomA : roomB;
+}
+
+//NOTE: strcmp. min(a, a == b) is zero in exactly the bytes where a and b differ or a ends, so the stop mask is where that's zero.
+//The 64 byte version mins the blocks together so there's one test for all of them, the masks only get worked out once something stops.
+EASY_STRING_TARGET("sse2") EASY_STRING_FORCE_INLINE EASY_STRING_NO_SANITIZE static __m128i easyString_stopBytes_sse2(unsigned char *a, unsigned char *b) {
+	__m128i va = _mm_loadu_si128((__m128i *)a);
+	return _mm_min_epu8(va, _mm_cmpeq_epi8(va, _mm_loadu_si128((__m128i *)b)));
+}
+
+EASY_STRING_TARGET("sse2") EASY_STRING_FORCE_INLINE static unsigned int easyString_zeroMask_sse2(__m128i x) {
+	return (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(x, _mm_setzero_si128()));
+}
+
+EASY_STRING_TARGET("sse2") EASY_STRING_FORCE_INLINE EASY_STRING_NO_SANITIZE static unsigned int easyString_stopMask_sse2(unsigned char *a, unsigned char *b) {
+	return easyString_zeroMask_sse2(easyString_stopBytes_sse2(a, b));
+}
+
+EASY_STRING_TARGET("sse2") EASY_STRING_FORCE_INLINE EASY_STRING_NO_SANITIZE static unsigned long long easyString_stopMask64_sse2(unsigned char *a, unsigned char *b) {
+	__m128i s0 = easyString_stopBytes_sse2(a, b);
+	__m128i s1 = easyString_stopBytes_sse2(a + 16, b + 16);
+	__m128i s2 = easyString_stopBytes_sse2(a + 32, b + 32);
+	__m128i s3 = easyString_stopBytes_sse2(a + 48, b + 48);
+	if(!easyString_zeroMask_sse2(_mm_min_epu8(_mm_min_epu8(s0, s1), _mm_min_epu8(s2, s3)))) return 0;
+	return (unsigned long long)(easyString_zeroMask_sse2(s0) | (easyString_zeroMask_sse2(s1) << 16)) | 
+		((unsigned long long)(easyString_zeroMask_sse2(s2) | (easyString_zeroMask_sse2(s3) << 16)) << 32);
+}
+
+EASY_STRING_TARGET("avx2") EASY_STRING_FORCE_INLINE EASY_STRING_NO_SANITIZE static __m256i easyString_stopBytes_avx2(unsigned char *a, unsigned char *b) {
+	__m256i va = _mm256_loadu_si256((__m256i *)a);
+	return _mm256_min_epu8(va, _mm256_cmpeq_epi8(va, _mm256_loadu_si256((__m256i *)b)));
+}
+
+EASY_STRING_TARGET("avx2") EASY_STRING_FORCE_INLINE static unsigned int easyString_zeroMask_avx2(__m256i x) {
+	return (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, _mm256_setzero_si256()));
+}
+
+EASY_STRING_TARGET("avx2") EASY_STRING_FORCE_INLINE EASY_STRING_NO_SANITIZE static unsigned int easyString_stopMask_avx2(unsigned char *a, unsigned char *b) {
+	return easyString_zeroMask_avx2(easyString_stopBytes_avx2(a, b));
+}
+
+EASY_STRING_TARGET("avx2") EASY_STRING_FORCE_INLINE EASY_STRING_NO_SANITIZE static unsigned long long easyString_stopMask64_avx2(unsigned char *a, unsigned char *b) {
+	__m256i s0 = easyString_stopBytes_avx2(a, b);
+	__m256i s1 = easyString_stopBytes_avx2(a + 32, b + 32);
+	if(!easyString_zeroMask_avx2(_mm256_min_epu8(s0, s1))) return 0;
+	return (unsigned long long)easyString_zeroMask_avx2(s0) | ((unsigned long long)easyString_zeroMask_avx2(s1) << 32);
+}
+
+//NOTE: The null terminated compares go a page at a time. Where the nearer page end is gets worked out once, then nothing is 
+//checked until it. Each page starts with an unaligned step, then a gets lined up so its loads never split a cache line. The last 
+//block before the page end is loaded ending right on it, overlapping bytes that already matched, so there's only a byte loop when 
+//a string starts less than one block before a page end.
+EASY_STRING_TARGET("sse2") EASY_STRING_NO_SANITIZE static size_t easyString_firstDifferenceNullTerminated_sse2(unsigned char *a, unsigned char *b) {
+	size_t at = 0;
+	for(;;) {
+		size_t end = at + easyString_pageRoom_(a + at, b + at);
+		unsigned int stop;
+		if(at + 64 <= end) {
+			if((stop = easyString_stopMask_sse2(a + at, b + at))) return at + easyString_ctz32(stop);
+			at += 16 - ((size_t)(a + at) & 15);
+			while(at + 64 <= end) {
+				unsigned long long stop64 = easyString_stopMask64_sse2(a + at, b + at);
+				if(stop64) return at + easyString_ctz64(stop64);
+				at += 64;
+			}
+		}
+		while(at + 16 <= end) {
+			if((stop = easyString_stopMask_sse2(a + at, b + at))) return at + easyString_ctz32(stop);
+			at += 16;
+		}
+		if(at < end) {
+			if(end >= 16) {
+				if((stop = easyString_stopMask_sse2(a + end - 16, b + end - 16))) return end - 16 + easyString_ctz32(stop);
+			} else {
+				for(; at < end; ++at) {
+					if(a[at] != b[at] || a[at] == 0) return at;
+				}
+			}
+			at = end;
+		}
+	}
+}
+
+//NOTE: Same as sse2 but the first step is a whole 64 bytes, two blocks cost about the same as one here and most strings end in them
+EASY_STRING_TARGET("avx2") EASY_STRING_NO_SANITIZE static size_t easyString_firstDifferenceNullTerminated_avx2(unsigned char *a, unsigned char *b) {
+	size_t at = 0;
+	for(;;) {
+		size_t end = at + easyString_pageRoom_(a + at, b + at);
+		unsigned int stop;
+		if(at + 64 <= end) {
+			unsigned long long stop64 = easyString_stopMask64_avx2(a + at, b + at);
+			if(stop64) return at + easyString_ctz64(stop64);
+			at += 64 - ((size_t)(a + at) & 31);
+			while(at + 64 <= end) {
+				stop64 = easyString_stopMask64_avx2(a + at, b + at);
+				if(stop64) return at + easyString_ctz64(stop64);
+				at += 64;
+			}
+		}
+		while(at + 32 <= end) {
+			if((stop = easyString_stopMask_avx2(a + at, b + at))) return at + easyString_ctz32(stop);
+			at += 32;
+		}
+		if(at < end) {
+			if(end >= 32) {
+				if((stop = easyString_stopMask_avx2(a + end - 32, b + end - 32))) return end - 32 + easyString_ctz32(stop);
+			} else {
+				for(; at < end; ++at) {
+					if(a[at] != b[at] || a[at] == 0) return at;
+				}
+			}
+			at = end;
+		}
+	}
+}
+
+//NOTE: strnlen. Aligned 16 byte loads never cross a page so they're safe to do past the terminator.
+EASY_STRING_TARGET("sse2") EASY_STRING_NO_SANITIZE static size_t easyString_byteLength_sse2(unsigned char *s, size_t maxLen) {
+	__m128i zero = _mm_setzero_si128();
+	size_t offset = (size_t)s & 15;
+	//NOTE: first block starts before s, shift off the bytes that aren't ours
+	unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128((__m128i *)(s - offset)), zero)) >> offset;
+	size_t at = 0;
+	if(!mask) {
+		at = 16 - offset;
+		while(at < maxLen) {
+			mask = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128((__m128i *)(s + at)), zero));
+			if(mask) break;
+			at += 16;
+		}
+	}
+	if(mask) { at += easyString_ctz32(mask); }
+	return (at < maxLen) ? at : maxLen;
+}
+
+EASY_STRING_TARGET("avx2") EASY_STRING_NO_SANITIZE static size_t easyString_byteLength_avx2(unsigned char *s, size_t maxLen) {
+	__m256i zero = _mm256_setzero_si256();
+	size_t offset = (size_t)s & 31;
+	unsigned int mask = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256((__m256i *)(s - offset)), zero)) >> offset;
+	size_t at = 0;
+	if(!mask) {
+		at = 32 - offset;
+		//NOTE: one block on its own to get to 64 byte alignment, so both blocks in the loop are always in the same page
+		if(((size_t)(s + at) & 32) && at < maxLen) {
+			mask = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256((__m256i *)(s + at)), zero));
+			if(!mask) { at += 32; }
+		}
+		//NOTE: two blocks per loop, or'd together so there's one test
+		while(!mask && at + 32 < maxLen) {
+			__m256i first = _mm256_cmpeq_epi8(_mm256_load_si256((__m256i *)(s + at)), zero);
+			__m256i second = _mm256_cmpeq_epi8(_mm256_load_si256((__m256i *)(s + at + 32)), zero);
+			if(_mm256_movemask_epi8(_mm256_or_si256(first, second))) {
+				mask = (unsigned int)_mm256_movemask_epi8(first);
+				if(!mask) {
+					at += 32;
+					mask = (unsigned int)_mm256_movemask_epi8(second);
+				}
+				break;
+			}
+			at += 64;
+		}
+		if(!mask && at < maxLen) {
+			mask = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256((__m256i *)(s + at)), zero));
+			if(!mask) { at += 32; }
+		}
+	}
+	if(mask) { at += easyString_ctz32(mask); }
+	return (at < maxLen) ? at : maxLen;
+}
+
+#endif // EASY_STRING_X86
+
+//NOTE: 8 byte aligned reads, so same as the simd versions it never reads into a page the string isn't in
+EASY_STRING_NO_SANITIZE static size_t easyString_byteLength_scalar(unsigned char *s, size_t maxLen) {
+	size_t at = 0;
+	while(at < maxLen && ((size_t)(s + at) & 7)) {
+		if(!s[at]) return at;
+		at++;
+	}
+	while(at < maxLen) {
+		unsigned long long x;
+		memcpy(&x, s + at, 8);
+		//NOTE: sets the top bit of a byte if it's zero (and maybe a byte after it, so the exact one is found below)
+		if((x - 0x0101010101010101ULL) & ~x & 0x8080808080808080ULL) break;
+		at += 8;
+	}
+	while(at < maxLen && s[at]) { at++; }
+	return (at < maxLen) ? at : maxLen;
+}
+
+static size_t easyString_byteLength_(unsigned char *s, size_t maxLen) {
+#if EASY_STRING_X86
+	EasyString_SimdLevel level = easyString_getSimdLevel();
+	if(level >= EASY_STRING_SIMD_AVX2) return easyString_byteLength_avx2(s, maxLen);
+	if(level >= EASY_STRING_SIMD_SSE2) return easyString_byteLength_sse2(s, maxLen);
+#endif
+	return easyString_byteLength_scalar(s, maxLen);
+}
+
+size_t easyString_byteLength_utf8(char *string) {
+	return easyString_byteLength_((unsigned char *)string, (size_t)-1);
+}
+
+size_t easyString_codepointCount_utf8(char *string, size_t byteCount) {
+	return easyUnicode_countCodepoints_((unsigned char *)string, byteCount);
+}
+
+size_t easyString_codepointCount_nullTerminated(char *string) {
+	return easyUnicode_countCodepoints_((unsigned char *)string, easyString_byteLength_((unsigned char *)string, (size_t)-1));
+}
+
+size_t easyString_codepointByteOffset_utf8(char *string, size_t byteCount, size_t codepoint) {
+	EasyString_CodepointSample found;
+	size_t counted = 0;
+	if(easyString_sampleCodepoints_((unsigned char *)string, byteCount, codepoint, 1, 0, 0, &found, 1, &counted)) {
+		return found.byte;
+	}
+	return byteCount;
+}
+
+//NOTE: The level without a call, the compare dispatch is on every lookup so it shouldn't cost more than the compare does
+EASY_STRING_FORCE_INLINE static int easyString_currentSimdLevel_(void) {
+	return (easyString_simdLevel_ >= 0) ? easyString_simdLevel_ : (int)easyString_getSimdLevel();
+}
+
+//NOTE: Out of line so the short key path that gets inlined into every compare stays small
+static size_t easyString_firstDifferenceLong_(unsigned char *a, unsigned char *b, size_t len) {
+#if EASY_STRING_X86
+	int level = easyString_currentSimdLevel_();
+	if(len >= 32 && level >= EASY_STRING_SIMD_AVX2) return easyString_firstDifference_avx2(a, b, len);
+	if(level >= EASY_STRING_SIMD_SSE2) return easyString_firstDifference_sse2(a, b, len);
+#endif
+	return easyString_firstDifference_scalar(a, b, len);
+}
+
+inline static size_t easyString_firstDifference_(unsigned char *a, unsigned char *b, size_t len) {
+	//NOTE: Short keys go straight to the word compare (up to 16 bytes is two overlapping words), no dispatch
+	if(len <= 16) return easyString_firstDifference_scalar(a, b, len);
+	return easyString_firstDifferenceLong_(a, b, len);
+}
+
+inline static size_t easyString_firstDifferenceNullTerminated_(unsigned char *a, unsigned char *b) {
+#if EASY_STRING_X86
+	int level = easyString_currentSimdLevel_();
+	if(level >= EASY_STRING_SIMD_AVX2) return easyString_firstDifferenceNullTerminated_avx2(a, b);
+	if(level >= EASY_STRING_SIMD_SSE2) return easyString_firstDifferenceNullTerminated_sse2(a, b);
+#endif
+	size_t at = 0;
+	while(a[at] == b[at] && a[at]) { at++; }
+	return at;
+}
+
+int easyString_stringsMatch_withCount(char *a, int aLength, char *b, int bLength) {
+	if(aLength != bLength) return 0;
+	int result = easyString_firstDifference_((unsigned char *)a, (unsigned char *)b, (size_t)aLength) == (size_t)aLength;
+	return result;
+} 
+
+int easyString_stringsMatch_null_and_count(char *a, char *b, int bLen) {
+	//NOTE: only need to know if a is exactly bLen long, so don't look further than one byte past that
+	size_t aLen = easyString_byteLength_((unsigned char *)a, (size_t)bLen + 1);
+	int result = (aLen == (size_t)bLen) && easyString_firstDifference_((unsigned char *)a, (unsigned char *)b, aLen) == aLen;
+	return result;
+}
+
+int easyString_stringsMatch_nullTerminated(char *a, char *b) {
+	size_t at = easyString_firstDifferenceNullTerminated_((unsigned char *)a, (unsigned char *)b);
+	int result = (a[at] == b[at]);
+	return result;
+}
+
+int easyString_compare(char *a, size_t aLength, char *b, size_t bLength) {
+	size_t minLength = (aLength < bLength) ? aLength : bLength;
+	size_t at = easyString_firstDifference_((unsigned char *)a, (unsigned char *)b, minLength);
+	if(at < minLength) {
+		return (int)((unsigned char *)a)[at] - (int)((unsigned char *)b)[at];
+	}
+	return (aLength > bLength) - (aLength < bLength);
+}
+
+int easyString_compare_nullTerminated(char *a, char *b) {
+	size_t at = easyString_firstDifferenceNullTerminated_((unsigned char *)a, (unsigned char *)b);
+	return (int)((unsigned char *)a)[at] - (int)((unsigned char *)b)[at];
+}
+
+///////////////////////*********** Hashing **************////////////////////
+
+#if EASY_STRING_X86
+
+//NOTE: Same accumulator as easyString_hashLong_scalar_, two/four lanes at a time. _mm_mul_epu32 does the low half times high half multiply.
+EASY_STRING_TARGET("sse2") static unsigned long long easyString_hashLong_sse2(char *p, size_t len, unsigned long long seed) {
+	unsigned long long accOut[8];
+	easyString_hashInitAccumulators_(accOut, seed);
+	__m128i acc[4];
+	for(int i = 0; i < 4; ++i) { acc[i] = _mm_loadu_si128((__m128i *)(accOut + 2*i)); }
+	__m128i prime = _mm_set1_epi32((int)0x9E3779B1);
+
+	size_t stripes = (len - 1) / 64;
+	for(size_t n = 0; n <= stripes; ++n) {
+		char *stripe = (n < stripes) ? p + 64*n : p + len - 64;
+		int keyOffset = (n < stripes) ? (int)(n % 16) : 7;
+		for(int i = 0; i < 4; ++i) {
+			__m128i data = _mm_loadu_si128((__m128i *)(stripe + 16*i));
+			__m128i key = _mm_xor_si128(data, _mm_loadu_si128((__m128i *)(easyString_hashSecret_ + keyOffset + 2*i)));
+			__m128i product = _mm_mul_epu32(key, _mm_srli_epi64(key, 32));
+			acc[i] = _mm_add_epi64(acc[i], _mm_add_epi64(product, _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2))));
+		}
+		if(n < stripes && n % 16 == 15) {
+			for(int i = 0; i < 4; ++i) {
+				__m128i a = _mm_xor_si128(acc[i], _mm_srli_epi64(acc[i], 47));
+				a = _mm_xor_si128(a, _mm_loadu_si128((__m128i *)(easyString_hashSecret_ + 16 + 2*i)));
+				//NOTE: 64 bit times 32 bit from two 32x32 multiplies
+				__m128i lo = _mm_mul_epu32(a, prime);
+				__m128i hi = _mm_mul_epu32(_mm_srli_epi64(a, 32), prime);
+				acc[i] = _mm_add_epi64(lo, _mm_slli_epi64(hi, 32));
+			}
+		}
+	}
+
+	for(int i = 0; i < 4; ++i) { _mm_storeu_si128((__m128i *)(accOut + 2*i), acc[i]); }
+	return easyString_hashMergeAccumulators_(accOut);
+}
+
+EASY_STRING_TARGET("avx2") static unsigned long long easyString_hashLong_avx2(char *p, size_t len, unsigned long long seed) {
+	unsigned long long accOut[8];
+	easyString_hashInitAccumulators_(accOut, seed);
+	__m256i acc0 = _mm256_loadu_si256((__m256i *)(accOut + 0));
+	__m256i acc1 = _mm256_loadu_si256((__m256i *)(accOut + 4));
+	__m256i prime = _mm256_set1_epi32((int)0x9E3779B1);
+
+	size_t stripes = (len - 1) / 64;
+	for(size_t n = 0; n <= stripes; ++n) {
+		char *stripe = (n < stripes) ? p + 64*n : p + len - 64;
+		int keyOffset = (n < stripes) ? (int)(n % 16) : 7;
+		__m256i data0 = _mm256_loadu_si256((__m256i *)(stripe + 0));
+		__m256i data1 = _mm256_loadu_si256((__m256i *)(stripe + 32));
+		__m256i key0 = _mm256_xor_si256(data0, _mm256_loadu_si256((__m256i *)(easyString_hashSecret_ + keyOffset + 0)));
+		__m256i key1 = _mm256_xor_si256(data1, _mm256_loadu_si256((__m256i *)(easyString_hashSecret_ + keyOffset + 4)));
+		acc0 = _mm256_add_epi64(acc0, _mm256_add_epi64(_mm256_mul_epu32(key0, _mm256_srli_epi64(key0, 32)), _mm256_shuffle_epi32(data0, _MM_SHUFFLE(1, 0, 3, 2))));
+		acc1 = _mm256_add_epi64(acc1, _mm256_add_epi64(_mm256_mul_epu32(key1, _mm256_srli_epi64(key1, 32)), _mm256_shuffle_epi32(data1, _MM_SHUFFLE(1, 0, 3, 2))));
+		if(n < stripes && n % 16 == 15) {
+			__m256i a0 = _mm256_xor_si256(_mm256_xor_si256(acc0, _mm256_srli_epi64(acc0, 47)), _mm256_loadu_si256((__m256i *)(easyString_hashSecret_ + 16)));
+			__m256i a1 = _mm256_xor_si256(_mm256_xor_si256(acc1, _mm256_srli_epi64(acc1, 47)), _mm256_loadu_si256((__m256i *)(easyString_hashSecret_ + 20)));
+			acc0 = _mm256_add_epi64(_mm256_mul_epu32(a0, prime), _mm256_slli_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a0, 32), prime), 32));
+			acc1 = _mm256_add_epi64(_mm256_mul_epu32(a1, prime), _mm256_slli_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a1, 32), prime), 32));
+		}
+	}
+
+	_mm256_storeu_si256((__m256i *)(accOut + 0), acc0);
+	_mm256_storeu_si256((__m256i *)(accOut + 4), acc1);
+	return easyString_hashMergeAccumulators_(accOut);
+}
+
+#endif // EASY_STRING_X86
+
+unsigned long long easyString_hash64(char *string, size_t length, unsigned long long seed) {
+#if EASY_STRING_LITTLE_ENDIAN
+	//NOTE: Same as easyString_hashShort_ but with plain loads, the byte by byte reads it needs for constexpr don't all get merged
+	if(length <= 16) {
+		unsigned long long a = 0;
+		unsigned long long b = 0;
+		if(length >= 4) {
+			size_t mid = (length >> 3) << 2;
+			unsigned int first, firstMid, last, lastMid;
+			memcpy(&first, string, 4);
+			memcpy(&firstMid, string + mid, 4);
+			memcpy(&last, string + length - 4, 4);
+			memcpy(&lastMid, string + length - 4 - mid, 4);
+			a = ((unsigned long long)first << 32) | firstMid;
+			b = ((unsigned long long)last << 32) | lastMid;
+		} else if(length > 0) {
+			a = ((unsigned long long)(unsigned char)string[0] << 16) | ((unsigned long long)(unsigned char)string[length >> 1] << 8) | (unsigned long long)(unsigned char)string[length - 1];
+			b = a;
+		}
+		return easyString_hashMix_(a ^ EASY_STRING_HASH_P1 ^ length, b ^ easyString_hashSeed_(seed));
+	}
+#else
+	if(length <= 16) return easyString_hashShort_(string, length, easyString_hashSeed_(seed));
+#endif
+	unsigned long long longHash = 0;
+	if(length > 256) {
+#if EASY_STRING_X86
+		EasyString_SimdLevel level = easyString_getSimdLevel();
+		if(level >= EASY_STRING_SIMD_AVX2) { longHash = easyString_hashLong_avx2(string, length, seed); }
+		else if(level >= EASY_STRING_SIMD_SSE2) { longHash = easyString_hashLong_sse2(string, length, seed); }
+		else
+#endif
+		{ longHash = easyString_hashLong_scalar_(string, length, seed); }
+	}
+	return easyString_hash64_finish_(string, length, seed, longHash);
+}
+
+///////////////////////*********** Interning **************////////////////////
+
+static unsigned int easyString_internHash_(unsigned char *string, size_t length) {
+	unsigned long long hash = easyString_hash64((char *)string, length, 0);
+	return (unsigned int)(hash ^ (hash >> 32));
+}
+
+#define EASY_STRING_INTERN_BLOCK_SIZE (64*1024)
+
+static char *easyString_internStore_(EasyString_InternTable *table, char *string, size_t length) {
+	EasyString_InternBlock *block = table->blocks;
+	if(!block || block->used + length + 1 > block->size) {
+		size_t size = (length + 1 > EASY_STRING_INTERN_BLOCK_SIZE) ? length + 1 : EASY_STRING_INTERN_BLOCK_SIZE;
+		block = (EasyString_InternBlock *)EASY_HEADERS_ALLOC(sizeof(EasyString_InternBlock) + size);
+		EASY_HEADERS_ASSERT(block);
+		block->next = table->blocks;
+		block->used = 0;
+		block->size = size;
+		table->blocks = block;
+	}
+	char *result = (char *)(block + 1) + block->used;
+	memcpy(result, string, length);
+	result[length] = '\0';
+	block->used += length + 1;
+	return result;
+}
+
+//NOTE: Returns the slot the string is in, or the empty slot it would go in
+static EasyString_InternSlot *easyString_internProbe_(EasyString_InternTable *table, char *string, size_t length, unsigned int hash) {
+	unsigned int mask = table->slotCount - 1;
+	unsigned int index = hash & mask;
+	for(;;) {
+		EasyString_InternSlot *slot = table->slots + index;
+		if(slot->id == 0) return slot;
+		if(slot->hash == hash) {
+			EasyString_InternEntry *entry = table->entries + (slot->id - 1);
+			if(entry->length == length && easyString_firstDifference_((unsigned char *)entry->string, (unsigned char *)string, length) == length) {
+				return slot;
+			}
+		}
+		index = (index + 1) & mask;
+	}
+}
+
+static void easyString_internResize_(EasyString_InternTable *table, unsigned int entryCount) {
+	//NOTE: keep the table at most half full so nearly every lookup is one probe
+	unsigned int slotCount = 16;
+	while(slotCount < entryCount*2) { slotCount *= 2; }
+	if(slotCount > table->slotCount) {
+		EasyString_InternSlot *oldSlots = table->slots;
+		unsigned int oldSlotCount = table->slotCount;
+
+		table->slots = (EasyString_InternSlot *)EASY_HEADERS_ALLOC(slotCount*sizeof(EasyString_InternSlot));
+		EASY_HEADERS_ASSERT(table->slots);
+		memset(table->slots, 0, slotCount*sizeof(EasyString_InternSlot));
+		table->slotCount = slotCount;
+
+		for(unsigned int i = 0; i < oldSlotCount; ++i) {
+			if(oldSlots[i].id) {
+				unsigned int index = oldSlots[i].hash & (slotCount - 1);
+				while(table->slots[index].id) { index = (index + 1) & (slotCount - 1); }
+				table->slots[index] = oldSlots[i];
+			}
+		}
+		if(oldSlots) { EASY_HEADERS_FREE(oldSlots); }
+	}
+
+	if(entryCount > table->entryCapacity) {
+		unsigned int capacity = table->entryCapacity ? table->entryCapacity : 16;
+		while(capacity < entryCount) { capacity *= 2; }
+		EasyString_InternEntry *entries = (EasyString_InternEntry *)EASY_HEADERS_ALLOC(capacity*sizeof(EasyString_InternEntry));
+		EASY_HEADERS_ASSERT(entries);
+		if(table->entries) {
+			memcpy(entries, table->entries, table->entryCount*sizeof(EasyString_InternEntry));
+			EASY_HEADERS_FREE(table->entries);
+		}
+		table->entries = entries;
+		table->entryCapacity = capacity;
+	}
+}
+
+static unsigned int easyString_internWithHash_(EasyString_InternTable *table, char *string, size_t length, unsigned int hash) {
+	EASY_HEADERS_ASSERT(!table->frozen);
+	EasyString_InternSlot *slot = easyString_internProbe_(table, string, length, hash);
+	if(slot->id == 0) {
+		if((table->entryCount + 1)*2 > table->slotCount) {
+			easyString_internResize_(table, table->entryCount + 1);
+			slot = easyString_internProbe_(table, string, length, hash);
+		} else if(table->entryCount + 1 > table->entryCapacity) {
+			easyString_internResize_(table, table->entryCount + 1);
+		}
+		EasyString_InternEntry *entry = table->entries + table->entryCount++;
+		entry->string = easyString_internStore_(table, string, length);
+		entry->length = (unsigned int)length;
+		entry->hash = hash;
+
+		slot->id = table->entryCount;
+		slot->hash = hash;
+	}
+	return slot->id;
+}
+
+void easyString_initInternTable(EasyString_InternTable *table, unsigned int expectedCount) {
+	memset(table, 0, sizeof(EasyString_InternTable));
+	easyString_internResize_(table, expectedCount ? expectedCount : 1);
+}
+
+void easyString_freeInternTable(EasyString_InternTable *table) {
+	EasyString_InternBlock *block = table->blocks;
+	while(block) {
+		EasyString_InternBlock *next = block->next;
+		EASY_HEADERS_FREE(block);
+		block = next;
+	}
+	if(table->slots) { EASY_HEADERS_FREE(table->slots); }
+	if(table->entries) { EASY_HEADERS_FREE(table->entries); }
+	memset(table, 0, sizeof(EasyString_InternTable));
+}
+
+unsigned int easyString_intern(EasyString_InternTable *table, char *string, size_t length) {
+	return easyString_internWithHash_(table, string, length, easyString_internHash_((unsigned char *)string, length));
+}
+
+unsigned int easyString_intern_nullTerminated(EasyString_InternTable *table, char *string) {
+	return easyString_intern(table, string, easyString_byteLength_((unsigned char *)string, (size_t)-1));
+}
+
+unsigned int easyString_internFind(EasyString_InternTable *table, char *string, size_t length) {
+	EasyString_InternSlot *slot = easyString_internProbe_(table, string, length, easyString_internHash_((unsigned char *)string, length));
+	return slot->id;
+}
+
+void easyString_internMany(EasyString_InternTable *table, char **strings, size_t *lengths, size_t count, unsigned int *idsOut) {
+	//NOTE: grow once up front for the worst case (all new) instead of rehashing part way through
+	easyString_internResize_(table, table->entryCount + (unsigned int)count);
+	for(size_t i = 0; i < count; ++i) {
+		size_t length = lengths ? lengths[i] : easyString_byteLength_((unsigned char *)strings[i], (size_t)-1);
+		idsOut[i] = easyString_intern(table, strings[i], length);
+	}
+}
+
+char *easyString_internString(EasyString_InternTable *table, unsigned int id, size_t *length) {
+	EASY_HEADERS_ASSERT(id > 0 && id <= table->entryCount);
+	EasyString_InternEntry *entry = table->entries + (id - 1);
+	if(length) { *length = entry->length; }
+	return entry->string;
+}
+
+void easyString_freezeInternTable(EasyString_InternTable *table) {
+	//NOTE: pick the simd level now, so readers on other threads never write the cached value
+	easyString_getSimdLevel();
+	table->frozen = 1;
+}
+
+///////////////////////*********** Codepoint index **************////////////////////
+
+unsigned int easyUnicode_utf8_previousCodepoint_To_Utf32_codepoint(char **streamPtr, char *streamStart) {
+	unsigned char *at = (unsigned char *)(*streamPtr);
+	EASY_HEADERS_ASSERT((char *)at > streamStart);
+	at--;
+	//NOTE: at most 3 continuation bytes before the lead byte
+	for(int i = 0; i < 3 && (char *)at > streamStart && (*at & 0xC0) == 0x80; ++i) { at--; }
+	*streamPtr = (char *)at;
+	char *read = (char *)at;
+	return easyUnicode_utf8_codepoint_To_Utf32_codepoint(&read, 0);
+}
+
+static void easyString_codepointIndexReserve_(EasyString_CodepointIndex *index, size_t sampleCount) {
+	if(sampleCount > index->sampleCapacity) {
+		size_t capacity = index->sampleCapacity ? index->sampleCapacity : 16;
+		while(capacity < sampleCount) { capacity *= 2; }
+		EasyString_CodepointSample *samples = (EasyString_CodepointSample *)EASY_HEADERS_ALLOC(capacity*sizeof(EasyString_CodepointSample));
+		EASY_HEADERS_ASSERT(samples);
+		if(index->samples) {
+			memcpy(samples, index->samples, index->sampleCount*sizeof(EasyString_CodepointSample));
+			EASY_HEADERS_FREE(index->samples);
+		}
+		index->samples = samples;
+		index->sampleCapacity = capacity;
+	}
+}
+
+//NOTE: the last sample at or before the codepoint. Straight after building the guess is always right, after edits it's usually right or close
+static size_t easyString_findSampleByCodepoint_(EasyString_CodepointIndex *index, size_t codepoint) {
+	EasyString_CodepointSample *samples = index->samples;
+	size_t guess = codepoint >> index->sampleShift;
+	if(guess >= index->sampleCount) { guess = index->sampleCount - 1; }
+	if(samples[guess].codepoint <= codepoint && (guess + 1 == index->sampleCount || samples[guess + 1].codepoint > codepoint)) {
+		return guess;
+	}
+	size_t low = 0;
+	size_t high = index->sampleCount;
+	while(high - low > 1) {
+		size_t mid = low + (high - low) / 2;
+		if(samples[mid].codepoint <= codepoint) { low = mid; } else { high = mid; }
+	}
+	return low;
+}
+
+static size_t easyString_findSampleByByte_(EasyString_CodepointIndex *index, size_t byteOffset) {
+	EasyString_CodepointSample *samples = index->samples;
+	size_t low = 0;
+	size_t high = index->sampleCount;
+	while(high - low > 1) {
+		size_t mid = low + (high - low) / 2;
+		if(samples[mid].byte <= byteOffset) { low = mid; } else { high = mid; }
+	}
+	return low;
+}
+
+void easyString_initCodepointIndex(EasyString_CodepointIndex *index, char *string, size_t byteCount, unsigned int sampleEvery) {
+	memset(index, 0, sizeof(EasyString_CodepointIndex));
+	if(sampleEvery == 0) { sampleEvery = 64; }
+	//NOTE: a power of two so the first guess is a shift, and at least 16 so a simd block never has more than a couple of samples in it
+	index->sampleEvery = 16;
+	index->sampleShift = 4;
+	while(index->sampleEvery < sampleEvery) { index->sampleEvery *= 2; index->sampleShift++; }
+
+	index->string = string;
+	index->byteCount = byteCount;
+
+	//NOTE: there can't be more codepoints than bytes, so this is enough for one pass
+	easyString_codepointIndexReserve_(index, byteCount / index->sampleEvery + 1);
+	index->samples[0].codepoint = 0;
+	index->samples[0].byte = 0;
+	index->sampleCount = 1 + easyString_sampleCodepoints_((unsigned char *)string, byteCount, index->sampleEvery, index->sampleEvery, 0, 0, index->samples + 1, (size_t)-1, &index->codepointCount);
+}
+
+void easyString_freeCodepointIndex(EasyString_CodepointIndex *index) {
+	if(index->samples) { EASY_HEADERS_FREE(index->samples); }
+	memset(index, 0, sizeof(EasyString_CodepointIndex));
+}
+
+size_t easyString_codepointToByteOffset(EasyString_CodepointIndex *index, size_t codepoint) {
+	EASY_HEADERS_ASSERT(codepoint <= index->codepointCount);
+	if(codepoint == index->codepointCount) return index->byteCount;
+
+	size_t sampleIndex = easyString_findSampleByCodepoint_(index, codepoint);
+	EasyString_CodepointSample *sample = index->samples + sampleIndex;
+	size_t gapEnd = (sampleIndex + 1 < index->sampleCount) ? index->samples[sampleIndex + 1].byte : index->byteCount;
+	//NOTE: scan the gap to the next sample for the one codepoint we want
+	EasyString_CodepointSample found;
+	size_t counted = 0;
+	size_t written = easyString_sampleCodepoints_((unsigned char *)index->string + sample->byte, gapEnd - sample->byte, codepoint - sample->codepoint, 1, sample->byte, sample->codepoint, &found, 1, &counted);
+	EASY_HEADERS_ASSERT(written == 1);
+	return found.byte;
+}
+
+size_t easyString_byteOffsetToCodepoint(EasyString_CodepointIndex *index, size_t byteOffset) {
+	EASY_HEADERS_ASSERT(byteOffset <= index->byteCount);
+	if(byteOffset == index->byteCount) return index->codepointCount;
+
+	EasyString_CodepointSample *sample = index->samples + easyString_findSampleByByte_(index, byteOffset);
+	return sample->codepoint + easyUnicode_countCodepoints_((unsigned char *)index->string + sample->byte + 1, byteOffset - sample->byte);
+}
+
+char *easyString_sliceCodepoints(EasyString_CodepointIndex *index, size_t codepointStart, size_t codepointEnd, size_t *byteLength) {
+	EASY_HEADERS_ASSERT(codepointStart <= codepointEnd);
+	size_t start = easyString_codepointToByteOffset(index, codepointStart);
+	size_t end = easyString_codepointToByteOffset(index, codepointEnd);
+	if(byteLength) { *byteLength = end - start; }
+	return index->string + start;
+}
+
+void easyString_codepointIndexInsert(EasyString_CodepointIndex *index, char *newString, size_t byteOffset, size_t insertedByteCount) {
+	EASY_HEADERS_ASSERT(byteOffset <= index->byteCount);
+	index->string = newString;
+	if(insertedByteCount == 0) return;
+
+	size_t insertedCodepoints = easyUnicode_countCodepoints_((unsigned char *)newString + byteOffset, insertedByteCount);
+
+	//NOTE: everything after the insert moves along, the samples before it don't change
+	size_t before = easyString_findSampleByByte_(index, byteOffset);
+	for(size_t i = before + 1; i < index->sampleCount; ++i) {
+		index->samples[i].codepoint += insertedCodepoints;
+		index->samples[i].byte += insertedByteCount;
+	}
+	index->byteCount += insertedByteCount;
+	index->codepointCount += insertedCodepoints;
+
+	//NOTE: if the gap the text went into is now too wide, sample it again. Only scans that gap, so it's the inserted bytes plus at most 2*sampleEvery codepoints
+	EasyString_CodepointSample gapStart = index->samples[before];
+	size_t gapEndCodepoint = (before + 1 < index->sampleCount) ? index->samples[before + 1].codepoint : index->codepointCount;
+	size_t gapEndByte = (before + 1 < index->sampleCount) ? index->samples[before + 1].byte : index->byteCount;
+	size_t gapCodepoints = gapEndCodepoint - gapStart.codepoint;
+	if(gapCodepoints > 2*(size_t)index->sampleEvery) {
+		size_t newSamples = (gapCodepoints - 1) / index->sampleEvery;
+		easyString_codepointIndexReserve_(index, index->sampleCount + newSamples);
+		EasyString_CodepointSample *gap = index->samples + before + 1;
+		memmove(gap + newSamples, gap, (index->sampleCount - (before + 1))*sizeof(EasyString_CodepointSample));
+		index->sampleCount += newSamples;
+
+		size_t counted = 0;
+		size_t written = easyString_sampleCodepoints_((unsigned char *)newString + gapStart.byte, gapEndByte - gapStart.byte, index->sampleEvery, index->sampleEvery, gapStart.byte, gapStart.codepoint, gap, (size_t)-1, &counted);
+		EASY_HEADERS_ASSERT(written == newSamples && counted == gapCodepoints);
+	}
+}
+
+void easyString_codepointIndexRemove(EasyString_CodepointIndex *index, size_t byteOffset, size_t removedByteCount) {
+	EASY_HEADERS_ASSERT(byteOffset + removedByteCount <= index->byteCount);
+	if(removedByteCount == 0) return;
+	size_t end = byteOffset + removedByteCount;
+
+	size_t removedCodepoints = easyUnicode_countCodepoints_((unsigned char *)index->string + byteOffset, removedByteCount);
+
+	//NOTE: drop the samples inside the removed bytes and move the ones after it back. A sample right at the end of the removed bytes 
+	//lands on byteOffset, keep it unless there's already one there.
+	size_t before = easyString_findSampleByByte_(index, byteOffset);
+	size_t writeAt = before + 1;
+	for(size_t i = before + 1; i < index->sampleCount; ++i) {
+		EasyString_CodepointSample sample = index->samples[i];
+		if(sample.byte < end) continue;
+		if(sample.byte == end && index->samples[before].byte == byteOffset) continue;
+		sample.codepoint -= removedCodepoints;
+		sample.byte -= removedByteCount;
+		index->samples[writeAt++] = sample;
+	}
+	index->sampleCount = writeAt;
+	size_t oldByteCount = index->byteCount;
+	index->byteCount -= removedByteCount;
+	index->codepointCount -= removedCodepoints;
+
+	//NOTE: the gap either side of the removed bytes is now one gap, sample it again if it's too wide. The text is still in the old place, 
+	//so it's scanned as the piece before the removed bytes then the piece after them.
+	EasyString_CodepointSample gapStart = index->samples[before];
+	size_t gapEndCodepoint = (before + 1 < index->sampleCount) ? index->samples[before + 1].codepoint : index->codepointCount;
+	size_t gapEndByte = (before + 1 < index->sampleCount) ? index->samples[before + 1].byte + removedByteCount : oldByteCount;
+	size_t gapCodepoints = gapEndCodepoint - gapStart.codepoint;
+	if(gapCodepoints > 2*(size_t)index->sampleEvery) {
+		size_t newSamples = (gapCodepoints - 1) / index->sampleEvery;
+		easyString_codepointIndexReserve_(index, index->sampleCount + newSamples);
+		EasyString_CodepointSample *gap = index->samples + before + 1;
+		memmove(gap + newSamples, gap, (index->sampleCount - (before + 1))*sizeof(EasyString_CodepointSample));
+		index->sampleCount += newSamples;
+
+		size_t countedBefore = 0;
+		size_t countedAfter = 0;
+		unsigned char *string = (unsigned char *)index->string;
+		size_t written = easyString_sampleCodepoints_(string + gapStart.byte, byteOffset - gapStart.byte, index->sampleEvery, index->sampleEvery, gapStart.byte, gapStart.codepoint, gap, (size_t)-1, &countedBefore);
+		size_t nextSample = (written + 1)*index->sampleEvery - countedBefore;
+		written += easyString_sampleCodepoints_(string + end, gapEndByte - end, nextSample, index->sampleEvery, byteOffset, gapStart.codepoint + countedBefore, gap + written, (size_t)-1, &countedAfter);
+		EASY_HEADERS_ASSERT(written == newSamples && countedBefore + countedAfter == gapCodepoints);
+	}
 }
 
 #endif // END OF IMPLEMENTATION
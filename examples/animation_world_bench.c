@@ -0,0 +1,85 @@
+/*
+Plays the same looping animations on N controllers and in an EasyAnimation_World, checks they show the same frame on every update,
+then times an update of each.
+
+gcc -std=c99 -O2 -I.. animation_world_bench.c -o animation_world_bench -lm
+./animation_world_bench 100000 - how many sprites, 20000 if you leave it off
+*/
+#include "example_common.h"
+
+#define EASY_STRING_IMPLEMENTATION 1
+#define EASY_ANIMATION_2D_IMPLEMENTATION 1
+#include "../easy_animation_2d.h"
+
+#define ANIMATION_COUNT 64
+#define CHECK_UPDATES 500
+#define UPDATES_PER_TIMING 10
+#define REPEATS 30
+#define DT 0.016f
+
+int main(int argc, char **argv) {
+    int spriteCount = (argc > 1) ? atoi(argv[1]) : 20000;
+
+    static Animation animations[ANIMATION_COUNT];
+    EasyAnimation_Frame frames[16];
+    for(int i = 0; i < 16; ++i) { frames[i] = (EasyAnimation_Frame)i; }
+    for(int i = 0; i < ANIMATION_COUNT; ++i) { easyAnimation_initAnimation(&animations[i], frames, 4 + i % 12, 0, (char *)"animation"); }
+
+    EasyAnimation_Controller *controllers = (EasyAnimation_Controller *)malloc(spriteCount*sizeof(EasyAnimation_Controller));
+    EasyAnimation_Frame *controllerFrames = (EasyAnimation_Frame *)malloc(spriteCount*sizeof(EasyAnimation_Frame));
+    void **spacers = (void **)malloc(spriteCount*sizeof(void *));
+    EasyAnimation_ListItem *freeList = 0;
+    EasyAnimation_World world;
+    easyAnimation_initWorld(&world);
+
+    for(int i = 0; i < spriteCount; ++i) {
+        Animation *animation = &animations[example_random() % ANIMATION_COUNT];
+        float period = 0.05f + (float)(example_random() % 100)*0.001f;
+
+        easyAnimation_initController(&controllers[i]);
+        //NOTE: Something else allocated in between so the list items aren't next to each other, like they wouldn't be in a game
+        spacers[i] = malloc(16 + example_random() % 200);
+        easyAnimation_addAnimationToController(&controllers[i], &freeList, animation, period);
+        easyAnimation_addToWorld(&world, animation, period);
+    }
+
+    long mismatches = 0;
+    for(int update = 0; update < CHECK_UPDATES; ++update) {
+        for(int i = 0; i < spriteCount; ++i) { controllerFrames[i] = easyAnimation_updateAnimation(&controllers[i], &freeList, DT, 0, 0); }
+        easyAnimation_updateWorld(&world, DT);
+        for(int i = 0; i < spriteCount; ++i) { mismatches += (controllerFrames[i] != world.frameOn[i]); }
+    }
+    printf("%d sprites over %d updates: %ld frames differ between the controllers and the world\n", spriteCount, CHECK_UPDATES, mismatches);
+
+    double bestControllers = 1e30;
+    double bestWorld = 1e30;
+    for(int repeat = 0; repeat < REPEATS; ++repeat) {
+        double start = example_seconds();
+        for(int update = 0; update < UPDATES_PER_TIMING; ++update) {
+            for(int i = 0; i < spriteCount; ++i) { controllerFrames[i] = easyAnimation_updateAnimation(&controllers[i], &freeList, DT, 0, 0); }
+            example_barrier();
+        }
+        double controllerTime = (example_seconds() - start) / UPDATES_PER_TIMING;
+
+        start = example_seconds();
+        for(int update = 0; update < UPDATES_PER_TIMING; ++update) {
+            easyAnimation_updateWorld(&world, DT);
+            example_barrier();
+        }
+        double worldTime = (example_seconds() - start) / UPDATES_PER_TIMING;
+
+        if(controllerTime < bestControllers) { bestControllers = controllerTime; }
+        if(worldTime < bestWorld) { bestWorld = worldTime; }
+    }
+
+    printf("controllers: %8.1f us an update (%.2f ns each)\n", bestControllers*1e6, bestControllers*1e9 / spriteCount);
+    printf("world:       %8.1f us an update (%.2f ns each)  %.1fx faster\n", bestWorld*1e6, bestWorld*1e9 / spriteCount, bestControllers / bestWorld);
+
+    for(int i = 0; i < spriteCount; ++i) { free(spacers[i]); }
+    free(spacers);
+    free(controllerFrames);
+    free(controllers);
+    easyAnimation_freeWorld(&world);
+    for(int i = 0; i < ANIMATION_COUNT; ++i) { easyAnimation_freeAnimation(&animations[i]); }
+    return mismatches ? 1 : 0;
+}
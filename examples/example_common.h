@@ -0,0 +1,59 @@
+/*
+The timer and random numbers the benchmark and fuzz programs in this folder share. Not part of the library.
+
+Include it before anything else, it sets _POSIX_C_SOURCE so clock_gettime is there with -std=c99.
+
+example_seconds() - a monotonic clock in seconds
+example_random() - xorshift, the same numbers on every machine so runs can be compared
+example_randomFloat(min, max)
+example_barrier() - stops the compiler moving work out of a timed loop or throwing it away
+*/
+#ifndef EXAMPLE_COMMON_H
+#define EXAMPLE_COMMON_H
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <intrin.h>
+static inline double example_seconds(void) {
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+}
+#define example_barrier() _ReadWriteBarrier()
+#else
+#include <time.h>
+static inline double example_seconds(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec + (double)time.tv_nsec*1e-9;
+}
+#define example_barrier() __asm__ volatile("" ::: "memory")
+#endif
+
+static unsigned long long example_randomState = 88172645463325252ULL;
+
+static inline void example_seedRandom(unsigned long long seed) {
+    example_randomState = seed ? seed : 88172645463325252ULL;
+}
+
+static inline unsigned int example_random(void) {
+    example_randomState ^= example_randomState << 13;
+    example_randomState ^= example_randomState >> 7;
+    example_randomState ^= example_randomState << 17;
+    return (unsigned int)(example_randomState >> 16);
+}
+
+static inline float example_randomFloat(float min, float max) {
+    return min + (max - min)*((float)(example_random() & 0xFFFFFF) / (float)0xFFFFFF);
+}
+
+#endif // EXAMPLE_COMMON_H
@@ -0,0 +1,115 @@
+/*
+Times gjk_collideBatch on the same pairs with a pool of 1, 2, 4... threads, and checks every thread count (plus a custom runner
+and no pool at all) gives exactly the same results as testing the pairs one by one.
+
+gcc -std=c99 -O2 -I.. gjk_batch_bench.c -o gjk_batch_bench -lm -lpthread
+./gjk_batch_bench 16 - the most threads to try, 8 if you leave it off
+*/
+#include "example_common.h"
+#include <math.h>
+
+#define GJK_IMPLEMENTATION 1
+#include "../easy_gjk.h"
+
+#define SHAPE_COUNT 4000
+#define PAIR_COUNT 20000
+#define MAX_SHAPE_POINTS 64
+#define REPEATS 20
+
+static gjk_v2 points[SHAPE_COUNT][MAX_SHAPE_POINTS];
+static int pointCounts[SHAPE_COUNT];
+static Gjk_Shape shapes[SHAPE_COUNT];
+static Gjk_ShapePair pairs[PAIR_COUNT];
+static Gjk_EPA_Info expected[PAIR_COUNT];
+static Gjk_EPA_Info results[PAIR_COUNT];
+
+static void makePolygon(gjk_v2 *out, int count, gjk_v2 center, float radius, float rotation) {
+    for(int i = 0; i < count; ++i) {
+        float angle = rotation + 6.2831853f*i / count;
+        out[i] = gjk_V2(center.x + radius*cosf(angle), center.y + radius*sinf(angle));
+    }
+}
+
+//NOTE: Bit for bit, the threads don't change what gets computed for a pair, only where
+static int resultsMatch(void) {
+    for(int i = 0; i < PAIR_COUNT; ++i) {
+        if(results[i].collided != expected[i].collided ||
+           memcmp(&results[i].normal, &expected[i].normal, sizeof(gjk_v2)) != 0 ||
+           memcmp(&results[i].distance, &expected[i].distance, sizeof(gjk_real)) != 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+//NOTE: Runs the tasks backwards on the calling thread, so the results can't depend on the order they're run in
+static void backwardsRunner(void *userData, Gjk_TaskFunction *task, void *taskData, int taskCount) {
+    (void)userData;
+    for(int i = taskCount - 1; i >= 0; --i) { task(taskData, i); }
+}
+
+int main(int argc, char **argv) {
+    int maxThreads = (argc > 1) ? atoi(argv[1]) : 8;
+
+    //NOTE: Mostly small polygons with the odd big one, and half the pairs put right next to each other so EPA has work to do
+    for(int i = 0; i < SHAPE_COUNT; ++i) {
+        pointCounts[i] = 3 + (int)(example_random() % ((i % 50 == 0) ? 60 : 14));
+        gjk_v2 center = gjk_V2(example_randomFloat(0, 20), example_randomFloat(0, 20));
+        makePolygon(points[i], pointCounts[i], center, example_randomFloat(0.5f, 1.5f), example_randomFloat(0, 6.2831853f));
+        shapes[i] = gjk_polygonShape(points[i], pointCounts[i]);
+    }
+    for(int i = 0; i < PAIR_COUNT; ++i) {
+        int a = (int)(example_random() % SHAPE_COUNT);
+        int b = (int)(example_random() % SHAPE_COUNT);
+        if(i % 2) {
+            b = (a + 1) % SHAPE_COUNT;
+            makePolygon(points[b], pointCounts[b], points[a][0], example_randomFloat(0.5f, 1.5f), example_randomFloat(0, 6.2831853f));
+        }
+        pairs[i].a = &shapes[a];
+        pairs[i].b = &shapes[b];
+    }
+
+    double start = example_seconds();
+    for(int i = 0; i < PAIR_COUNT; ++i) { expected[i] = gjk_shapesCollide_withEPA(pairs[i].a, pairs[i].b); }
+    double serialTime = example_seconds() - start;
+    int hits = 0;
+    for(int i = 0; i < PAIR_COUNT; ++i) { hits += expected[i].collided; }
+    printf("%d pairs, %d overlapping. One by one: %.2f ms\n", PAIR_COUNT, hits, serialTime*1e3);
+
+    double oneThread = 0;
+    for(int threadCount = 1; threadCount <= maxThreads; threadCount *= 2) {
+        Gjk_ThreadPool pool;
+        gjk_initThreadPool(&pool, threadCount);
+
+        double best = 1e9;
+        for(int repeat = 0; repeat < REPEATS; ++repeat) {
+            memset(results, 0xCD, sizeof(results));
+            start = example_seconds();
+            gjk_collideBatch(pairs, PAIR_COUNT, results, &pool);
+            double time = example_seconds() - start;
+            if(time < best) { best = time; }
+            if(!resultsMatch()) {
+                printf("results with %d threads don't match testing the pairs one by one\n", threadCount);
+                return 1;
+            }
+        }
+        gjk_freeThreadPool(&pool);
+
+        if(threadCount == 1) { oneThread = best; }
+        printf("%3d threads: %7.2f ms  %.2fx one thread\n", threadCount, best*1e3, oneThread / best);
+    }
+
+    Gjk_TaskRunner runner;
+    runner.runTasks = backwardsRunner;
+    runner.userData = 0;
+    memset(results, 0, sizeof(results));
+    gjk_collideBatch_withRunner(pairs, PAIR_COUNT, results, &runner);
+    if(!resultsMatch()) { printf("results from a custom runner don't match\n"); return 1; }
+
+    memset(results, 0, sizeof(results));
+    gjk_collideBatch(pairs, PAIR_COUNT, results, 0);
+    if(!resultsMatch()) { printf("results with no pool don't match\n"); return 1; }
+
+    printf("every thread count, the custom runner and no pool match testing the pairs one by one\n");
+    return 0;
+}
@@ -0,0 +1,60 @@
+/*
+What it costs to call the small vector functions (gjk_dot, gjk_perp2D) from a file that doesn't have GJK_IMPLEMENTATION.
+They're inline static in the header part so they should inline here, this compares that against the same math behind a call
+the compiler can't inline, over 4096 points.
+
+gcc -std=c99 -O2 -I.. gjk_call_bench.c -o gjk_call_bench
+*/
+#include "example_common.h"
+
+//NOTE: No GJK_IMPLEMENTATION, this is what every other file in a program sees
+#include "../easy_gjk.h"
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define BENCH_NOINLINE __declspec(noinline)
+#else
+#define BENCH_NOINLINE __attribute__((noinline))
+#endif
+
+#define POINT_COUNT 4096
+#define PASSES 250
+#define REPEATS 20
+
+BENCH_NOINLINE static gjk_real outOfLine_dot(gjk_v2 a, gjk_v2 b) {
+    return a.x*b.x + a.y*b.y;
+}
+
+BENCH_NOINLINE static gjk_v2 outOfLine_perp2D(gjk_v2 a) {
+    return gjk_V2(-a.y, a.x);
+}
+
+static gjk_v2 points[POINT_COUNT];
+
+static double bestNanoseconds(int inlined) {
+    double best = 1e30;
+    volatile gjk_real sink = 0;
+    for(int repeat = 0; repeat < REPEATS; ++repeat) {
+        gjk_real sum = 0;
+        double start = example_seconds();
+        for(int pass = 0; pass < PASSES; ++pass) {
+            if(inlined) {
+                for(int i = 0; i + 1 < POINT_COUNT; ++i) { sum += gjk_dot(gjk_perp2D(points[i]), points[i + 1]); }
+            } else {
+                for(int i = 0; i + 1 < POINT_COUNT; ++i) { sum += outOfLine_dot(outOfLine_perp2D(points[i]), points[i + 1]); }
+            }
+        }
+        double nanoseconds = (example_seconds() - start)*1e9 / ((double)PASSES*(POINT_COUNT - 1));
+        sink = sum;
+        if(nanoseconds < best) { best = nanoseconds; }
+    }
+    (void)sink;
+    return best;
+}
+
+int main(void) {
+    for(int i = 0; i < POINT_COUNT; ++i) { points[i] = gjk_V2((gjk_real)(i % 17) - 8, (gjk_real)(i % 13) - 6); }
+
+    printf("perp+dot inline from the header: %.2f ns\n", bestNanoseconds(1));
+    printf("perp+dot behind a call:          %.2f ns\n", bestNanoseconds(0));
+    return 0;
+}
@@ -0,0 +1,523 @@
+/*
+Fuzz & regression test for gjk_objectsTest/gjk_shapesTest. Millions of random convex pairs are checked against a separating axis
+test done in doubles, mixed in with the cases GJK finds hard: polygons on a grid sharing corners and edges, boxes exactly touching
+or a hair apart, points all on one line, a vertex sitting on the other shape's edge, and many sided round polygons only just
+touching. It runs at sizes from 1e-3 to 1e5 so the relative tolerance gets tested too.
+
+The answer has to match SAT unless SAT says they're within the touching tolerance, then anything goes but GJK_TOUCHING has to
+really be close. EPA has to agree on the depth and the cached test on the answer. A custom shape counts support calls so no test
+can go past GJK_MAX_ITERATIONS.
+
+The other queries get checked on the same pairs. The distance and its closest points have to match the smallest distance between
+any two edges, worked out in doubles. Time of impact throws b at a and has to stop them within GJK_TOI_TOLERANCE without going
+through anything on the way, and a miss can't overlap anywhere along the move. Each manifold contact point has to be on the incident
+edge and, pushed out by its depth, on the reference edge's side. The cached manifold and test have to give the same answer as the
+uncached ones.
+
+gcc -std=c99 -O2 -I.. gjk_fuzz.c -o gjk_fuzz -lm
+./gjk_fuzz 10000000 - how many pairs, 2 million if you leave it off
+*/
+#include "example_common.h"
+#include <math.h>
+#include <assert.h>
+
+static long fuzz_asserts = 0;
+#define GJK_ASSERT(statement) if(!(statement)) { fuzz_asserts++; fprintf(stderr, "gjk assert %s on line %d\n", #statement, __LINE__); abort(); }
+#define GJK_IMPLEMENTATION 1
+#include "../easy_gjk.h"
+
+#define MAX_POLYGON_POINTS 64
+#define ROUND_POINTS 48
+#define PAIR_KIND_COUNT 6
+
+typedef struct {
+    gjk_v2 points[MAX_POLYGON_POINTS];
+    int count;
+} Polygon;
+
+static double randomDouble(void) {
+    return (double)(example_random() & 0xFFFFFF) / (double)0x1000000;
+}
+
+static gjk_v2 v2(double x, double y) {
+    return gjk_V2((gjk_real)x, (gjk_real)y);
+}
+
+static void addPoint(Polygon *polygon, double x, double y) {
+    polygon->points[polygon->count++] = v2(x, y);
+}
+
+///////////////////////*********** Convex hull **************////////////////////
+
+static int comparePoints(const void *aPtr, const void *bPtr) {
+    const gjk_v2 *a = (const gjk_v2 *)aPtr;
+    const gjk_v2 *b = (const gjk_v2 *)bPtr;
+    if(a->x != b->x) return (a->x < b->x) ? -1 : 1;
+    if(a->y != b->y) return (a->y < b->y) ? -1 : 1;
+    return 0;
+}
+
+static double cross(gjk_v2 o, gjk_v2 a, gjk_v2 b) {
+    return ((double)a.x - o.x)*((double)b.y - o.y) - ((double)a.y - o.y)*((double)b.x - o.x);
+}
+
+//NOTE: Monotone chain. Collinear points are dropped, so 2 points left means a segment and 1 a point.
+static void makeHull(Polygon *polygon) {
+    gjk_v2 sorted[MAX_POLYGON_POINTS];
+    gjk_v2 hull[2*MAX_POLYGON_POINTS];
+    int count = 0;
+
+    qsort(polygon->points, polygon->count, sizeof(gjk_v2), comparePoints);
+    for(int i = 0; i < polygon->count; ++i) {
+        if(count == 0 || comparePoints(&sorted[count - 1], &polygon->points[i]) != 0) { sorted[count++] = polygon->points[i]; }
+    }
+    if(count < 3) {
+        memcpy(polygon->points, sorted, count*sizeof(gjk_v2));
+        polygon->count = count;
+        return;
+    }
+
+    int k = 0;
+    for(int i = 0; i < count; ++i) {
+        while(k >= 2 && cross(hull[k - 2], hull[k - 1], sorted[i]) <= 0) { k--; }
+        hull[k++] = sorted[i];
+    }
+    for(int i = count - 2, lower = k + 1; i >= 0; --i) {
+        while(k >= lower && cross(hull[k - 2], hull[k - 1], sorted[i]) <= 0) { k--; }
+        hull[k++] = sorted[i];
+    }
+    polygon->count = k - 1;
+    memcpy(polygon->points, hull, polygon->count*sizeof(gjk_v2));
+}
+
+///////////////////////*********** Separating axis reference **************////////////////////
+
+static void project(Polygon *polygon, double nx, double ny, double *min, double *max) {
+    *min = 1e300;
+    *max = -1e300;
+    for(int i = 0; i < polygon->count; ++i) {
+        double value = polygon->points[i].x*nx + polygon->points[i].y*ny;
+        if(value < *min) *min = value;
+        if(value > *max) *max = value;
+    }
+}
+
+static double axisGap(Polygon *a, Polygon *b, double nx, double ny) {
+    double minA, maxA, minB, maxB;
+    project(a, nx, ny, &minA, &maxA);
+    project(b, nx, ny, &minB, &maxB);
+    return (minB - maxA > minA - maxB) ? minB - maxA : minA - maxB;
+}
+
+//NOTE: Signed separation in doubles, > 0 is that far apart and < 0 is overlapping by that much. Every edge normal and edge direction
+//is tried, the edge directions cover segments. A point has no edges, so against a point the direction to each vertex is tried too.
+static double satSeparation(Polygon *a, Polygon *b) {
+    double best = -1e300;
+    Polygon *polygons[2] = {a, b};
+    for(int which = 0; which < 2; ++which) {
+        Polygon *polygon = polygons[which];
+        for(int i = 0; i < polygon->count; ++i) {
+            gjk_v2 e0 = polygon->points[i];
+            gjk_v2 e1 = polygon->points[(i + 1) % polygon->count];
+            double ex = (double)e1.x - e0.x;
+            double ey = (double)e1.y - e0.y;
+            double length = sqrt(ex*ex + ey*ey);
+            if(length == 0) continue;
+            double gap = axisGap(a, b, -ey / length, ex / length);
+            if(gap > best) best = gap;
+            gap = axisGap(a, b, ex / length, ey / length);
+            if(gap > best) best = gap;
+        }
+    }
+
+    if(a->count == 1 && b->count == 1) {
+        double dx = (double)a->points[0].x - b->points[0].x;
+        double dy = (double)a->points[0].y - b->points[0].y;
+        best = sqrt(dx*dx + dy*dy);
+    } else if(a->count == 1 || b->count == 1) {
+        Polygon *point = (a->count == 1) ? a : b;
+        Polygon *other = (a->count == 1) ? b : a;
+        for(int i = 0; i < other->count; ++i) {
+            double nx = (double)other->points[i].x - point->points[0].x;
+            double ny = (double)other->points[i].y - point->points[0].y;
+            double length = sqrt(nx*nx + ny*ny);
+            if(length == 0) continue;
+            double gap = axisGap(point, other, nx / length, ny / length);
+            if(gap > best) best = gap;
+        }
+    }
+    return best;
+}
+
+///////////////////////*********** Brute force distance **************////////////////////
+
+static double pointSegmentDistance(double px, double py, gjk_v2 s0, gjk_v2 s1) {
+    double ex = (double)s1.x - s0.x;
+    double ey = (double)s1.y - s0.y;
+    double lengthSqr = ex*ex + ey*ey;
+    double t = 0;
+    if(lengthSqr > 0) {
+        t = ((px - s0.x)*ex + (py - s0.y)*ey) / lengthSqr;
+        if(t < 0) t = 0;
+        if(t > 1) t = 1;
+    }
+    double dx = px - (s0.x + t*ex);
+    double dy = py - (s0.y + t*ey);
+    return sqrt(dx*dx + dy*dy);
+}
+
+//NOTE: How far a point is from the polygon, 0 inside it. Less than 3 points is a segment or a point.
+static double pointPolygonDistance(Polygon *polygon, double px, double py) {
+    double best = 1e300;
+    int inside = polygon->count >= 3;
+    for(int i = 0; i < polygon->count; ++i) {
+        gjk_v2 e0 = polygon->points[i];
+        gjk_v2 e1 = polygon->points[(i + 1) % polygon->count];
+        double distance = pointSegmentDistance(px, py, e0, e1);
+        if(distance < best) best = distance;
+        if(((double)e1.x - e0.x)*(py - e0.y) - ((double)e1.y - e0.y)*(px - e0.x) < 0) inside = 0;
+    }
+    return inside ? 0 : best;
+}
+
+//NOTE: For shapes that don't overlap the closest two points are an end of one edge against the other edge, so the smallest of 
+//those over every pair of edges is the distance. b is moved by offset first.
+static double bruteDistance(Polygon *a, Polygon *b, double offsetX, double offsetY) {
+    double best = 1e300;
+    for(int i = 0; i < a->count; ++i) {
+        gjk_v2 a0 = a->points[i];
+        gjk_v2 a1 = a->points[(i + 1) % a->count];
+        for(int j = 0; j < b->count; ++j) {
+            gjk_v2 b0 = v2(b->points[j].x + offsetX, b->points[j].y + offsetY);
+            gjk_v2 b1 = v2(b->points[(j + 1) % b->count].x + offsetX, b->points[(j + 1) % b->count].y + offsetY);
+            double distances[4] = {
+                pointSegmentDistance(a0.x, a0.y, b0, b1), pointSegmentDistance(a1.x, a1.y, b0, b1),
+                pointSegmentDistance(b0.x, b0.y, a0, a1), pointSegmentDistance(b1.x, b1.y, a0, a1)
+            };
+            for(int k = 0; k < 4; ++k) { if(distances[k] < best) best = distances[k]; }
+        }
+    }
+    return best;
+}
+
+static void movePolygon(Polygon *result, Polygon *polygon, double offsetX, double offsetY) {
+    result->count = 0;
+    for(int i = 0; i < polygon->count; ++i) { addPoint(result, polygon->points[i].x + offsetX, polygon->points[i].y + offsetY); }
+}
+
+//NOTE: How far a point is from the line along the edge starting at point index. Together with being on the polygon that puts it on 
+//the side the edge is part of. Points rounding kept in the middle of a flat side split it into edges, and the manifold uses all of them.
+static double distanceFromSide(Polygon *polygon, int index, double px, double py) {
+    gjk_v2 e0 = polygon->points[index];
+    gjk_v2 e1 = polygon->points[(index + 1) % polygon->count];
+    double ex = (double)e1.x - e0.x;
+    double ey = (double)e1.y - e0.y;
+    return fabs(ex*(py - e0.y) - ey*(px - e0.x)) / sqrt(ex*ex + ey*ey);
+}
+
+///////////////////////*********** Support call counting **************////////////////////
+
+typedef struct {
+    Polygon *polygon;
+    long calls;
+} CountedPolygon;
+
+static gjk_v2 countedSupport(void *userData, gjk_v2 d) {
+    CountedPolygon *counted = (CountedPolygon *)userData;
+    counted->calls++;
+    Polygon *polygon = counted->polygon;
+    int best = 0;
+    gjk_real bestDist = gjk_dot(polygon->points[0], d);
+    for(int i = 1; i < polygon->count; ++i) {
+        gjk_real dist = gjk_dot(polygon->points[i], d);
+        if(dist > bestDist) { bestDist = dist; best = i; }
+    }
+    return polygon->points[best];
+}
+
+///////////////////////*********** Pairs **************////////////////////
+
+static void makeRoundPolygon(Polygon *polygon, double cx, double cy, double radius, double rotation) {
+    for(int i = 0; i < ROUND_POINTS; ++i) {
+        double angle = rotation + 6.283185307179586*i / ROUND_POINTS;
+        addPoint(polygon, cx + radius*cos(angle), cy + radius*sin(angle));
+    }
+}
+
+//NOTE: Most of these are built to touch exactly or to be flat
+static void makePair(Polygon *a, Polygon *b, int kind, double scale) {
+    a->count = 0;
+    b->count = 0;
+    switch(kind) {
+        case 0: { //random hulls at random places
+            int countA = 1 + (int)(example_random() % 12);
+            int countB = 1 + (int)(example_random() % 12);
+            double radiusA = scale*(0.2 + randomDouble());
+            double radiusB = scale*(0.2 + randomDouble());
+            double bx = scale*(randomDouble()*3 - 1.5);
+            double by = scale*(randomDouble()*3 - 1.5);
+            for(int i = 0; i < countA; ++i) { addPoint(a, radiusA*(randomDouble()*2 - 1), radiusA*(randomDouble()*2 - 1)); }
+            for(int i = 0; i < countB; ++i) { addPoint(b, bx + radiusB*(randomDouble()*2 - 1), by + radiusB*(randomDouble()*2 - 1)); }
+            makeHull(a);
+            makeHull(b);
+        } break;
+        case 1: { //points on a grid, so shared corners and edges all over
+            int countA = 1 + (int)(example_random() % 6);
+            int countB = 1 + (int)(example_random() % 6);
+            for(int i = 0; i < countA; ++i) { addPoint(a, scale*(example_random() % 5), scale*(example_random() % 5)); }
+            for(int i = 0; i < countB; ++i) { addPoint(b, scale*(example_random() % 5 + 2), scale*(example_random() % 5)); }
+            makeHull(a);
+            makeHull(b);
+        } break;
+        case 2: { //boxes side by side, exactly touching or a hair apart or in
+            double width = scale*(0.5 + randomDouble());
+            double height = scale*(0.5 + randomDouble());
+            double offset = scale*(randomDouble() - 0.5);
+            double gap = (example_random() % 3 == 0) ? 0 : scale*1e-3*(randomDouble()*2 - 1);
+            addPoint(a, 0, 0); addPoint(a, width, 0); addPoint(a, width, height); addPoint(a, 0, height);
+            addPoint(b, width + gap, offset); addPoint(b, 2*width + gap, offset);
+            addPoint(b, 2*width + gap, offset + height); addPoint(b, width + gap, offset + height);
+        } break;
+        case 3: { //collinear points, segments along the same line
+            double angle = randomDouble()*6.283185307179586;
+            double dx = cos(angle);
+            double dy = sin(angle);
+            int countA = 2 + (int)(example_random() % 3);
+            int countB = 2 + (int)(example_random() % 3);
+            double shift = scale*(randomDouble()*2 - 0.5);
+            for(int i = 0; i < countA; ++i) { double t = scale*randomDouble(); addPoint(a, t*dx, t*dy); }
+            for(int i = 0; i < countB; ++i) { double t = shift + scale*randomDouble(); addPoint(b, t*dx, t*dy); }
+            makeHull(a);
+            makeHull(b);
+        } break;
+        case 4: { //a vertex exactly on the other's edge
+            double x = scale*(randomDouble()*2 - 1);
+            double height = scale*(0.1 + randomDouble());
+            Polygon *edge = (example_random() & 1) ? a : b;
+            Polygon *vertex = (edge == a) ? b : a;
+            addPoint(edge, -scale, 0); addPoint(edge, scale, 0); addPoint(edge, 0, -scale);
+            addPoint(vertex, x, 0); addPoint(vertex, x + height, height); addPoint(vertex, x - height, height);
+        } break;
+        case 5: { //round polygons with lots of points just touching, these take GJK the most support points
+            double radiusA = scale*(0.5 + randomDouble());
+            double radiusB = scale*(0.5 + randomDouble());
+            double angle = randomDouble()*6.283185307179586;
+            double distance = (radiusA + radiusB)*(1 + 1e-4*(randomDouble()*2 - 1));
+            makeRoundPolygon(a, 0, 0, radiusA, randomDouble());
+            makeRoundPolygon(b, distance*cos(angle), distance*sin(angle), radiusB, randomDouble());
+        } break;
+    }
+}
+
+int main(int argc, char **argv) {
+    long pairCount = (argc > 1) ? atol(argv[1]) : 2000000;
+    double scales[] = {1e-3, 1.0, 1e3, 1e5};
+    long kindCounts[PAIR_KIND_COUNT] = {0};
+    long results[3] = {0};
+    long wrong = 0;
+    long epaWrong = 0;
+    long distanceWrong = 0;
+    long toiWrong = 0;
+    long manifoldWrong = 0;
+    long toiTests = 0;
+    long toiHits = 0;
+    long maxSupportCalls = 0;
+    long long supportCalls = 0;
+    double worstTouching = 0;
+
+    for(long pairIndex = 0; pairIndex < pairCount; ++pairIndex) {
+        Polygon a, b;
+        int kind = (int)(example_random() % PAIR_KIND_COUNT);
+        double scale = scales[example_random() % 4];
+        makePair(&a, &b, kind, scale);
+        if(a.count == 0 || b.count == 0) continue;
+        kindCounts[kind]++;
+
+        //NOTE: Answers within the touching tolerance of SAT's are all fine
+        double separation = satSeparation(&a, &b);
+        double size = 0;
+        for(int i = 0; i < a.count; ++i) {
+            for(int j = 0; j < b.count; ++j) {
+                double dx = fabs((double)a.points[i].x - b.points[j].x);
+                double dy = fabs((double)a.points[i].y - b.points[j].y);
+                if(dx > size) size = dx;
+                if(dy > size) size = dy;
+            }
+        }
+        double band = 4*GJK_RELATIVE_EPSILON*size + 1e-6*size;
+
+        Gjk_Result polygonResult = gjk_objectsTest(a.points, a.count, b.points, b.count);
+
+        CountedPolygon countedA = {&a, 0};
+        CountedPolygon countedB = {&b, 0};
+        Gjk_Shape shapeA = gjk_customShape(countedSupport, &countedA, gjk_transform(v2(0, 0), 0));
+        Gjk_Shape shapeB = gjk_customShape(countedSupport, &countedB, gjk_transform(v2(0, 0), 0));
+        Gjk_Result customResult = gjk_shapesTest(&shapeA, &shapeB);
+
+        //NOTE: One support point to start, then at most one more per iteration
+        assert(countedA.calls <= GJK_MAX_ITERATIONS + 1);
+        assert(countedA.calls == countedB.calls);
+        supportCalls += countedA.calls;
+        if(countedA.calls > maxSupportCalls) maxSupportCalls = countedA.calls;
+
+        for(int which = 0; which < 2; ++which) {
+            Gjk_Result result = which ? customResult : polygonResult;
+            int ok = 1;
+            if(!which && (a.count < 3 || b.count < 3)) {
+                //NOTE: The polygon versions don't count less than 3 points as a shape
+                ok = (result == GJK_SEPARATED);
+            } else {
+                if(separation > band && result != GJK_SEPARATED) ok = 0;
+                if(separation < -band && result != GJK_OVERLAPPING) ok = 0;
+                if(result == GJK_TOUCHING && fabs(separation) > band) ok = 0;
+            }
+            if(!ok) {
+                if(wrong < 10) {
+                    printf("wrong answer: kind %d scale %g sat %g band %g gjk %d (%s) points %d %d\n", kind, scale, separation, band, (int)result,
+                           which ? "custom" : "polygon", a.count, b.count);
+                }
+                wrong++;
+            }
+        }
+        results[polygonResult]++;
+        if(polygonResult == GJK_TOUCHING && size > 0 && fabs(separation) / size > worstTouching) { worstTouching = fabs(separation) / size; }
+
+        //NOTE: EPA has to agree it's overlapping and get SAT's depth
+        Gjk_EPA_Info epa = gjk_objectsCollide_withEPA(a.points, a.count, b.points, b.count);
+        if(epa.collided != (polygonResult == GJK_OVERLAPPING)) { epaWrong++; }
+        double epaDepth = (double)epa.distance - GJK_EPA_SEPARATION;
+        if(epa.collided && separation < -band && fabs(epaDepth + separation) > 1e-3*size + band) {
+            if(epaWrong < 10) { printf("wrong EPA depth: kind %d depth %g sat %g size %g\n", kind, epaDepth, separation, size); }
+            epaWrong++;
+        }
+
+        //NOTE: Distance has to match the brute force one when they're apart, and its closest points have to be on the shapes that far apart
+        Gjk_Distance_Info distance = gjk_shapesDistance(&shapeA, &shapeB);
+        double distanceTolerance = 1e-4*size + band;
+        if(separation > band) {
+            double brute = bruteDistance(&a, &b, 0, 0);
+            double pointsApart = sqrt(((double)distance.pointA.x - distance.pointB.x)*((double)distance.pointA.x - distance.pointB.x) + 
+                                      ((double)distance.pointA.y - distance.pointB.y)*((double)distance.pointA.y - distance.pointB.y));
+            if(distance.overlapping || fabs((double)distance.distance - brute) > distanceTolerance || fabs(pointsApart - brute) > distanceTolerance ||
+               pointPolygonDistance(&a, distance.pointA.x, distance.pointA.y) > distanceTolerance || 
+               pointPolygonDistance(&b, distance.pointB.x, distance.pointB.y) > distanceTolerance) {
+                if(distanceWrong < 10) {
+                    printf("wrong distance: kind %d scale %g gjk %g (overlapping %d) brute force %g points %g apart\n", kind, scale, (double)distance.distance,
+                           (int)distance.overlapping, brute, pointsApart);
+                }
+                distanceWrong++;
+            }
+        } else if(separation < -band && !distance.overlapping) {
+            if(distanceWrong < 10) { printf("distance missed an overlap: kind %d scale %g sat %g\n", kind, scale, separation); }
+            distanceWrong++;
+        }
+
+        //NOTE: Time of impact, with b thrown at a. A hit has to leave them apart by no more than GJK_TOI_TOLERANCE, and not have gone 
+        //through anything before it. A miss can't overlap anywhere along the move. At 1e5 the tolerance is less than a float can 
+        //tell apart, so that scale is left out.
+        if(separation > band && scale <= 1e3) {
+            double throwScale = 3*randomDouble();
+            double moveAX = scale*0.2*(randomDouble()*2 - 1);
+            double moveAY = scale*0.2*(randomDouble()*2 - 1);
+            double moveBX = throwScale*((double)a.points[0].x - b.points[0].x) + scale*0.2*(randomDouble()*2 - 1);
+            double moveBY = throwScale*((double)a.points[0].y - b.points[0].y) + scale*0.2*(randomDouble()*2 - 1);
+            Gjk_TOI_Info toi = gjk_shapesTimeOfImpact(&shapeA, v2(moveAX, moveAY), &shapeB, v2(moveBX, moveBY));
+            double relativeX = moveBX - moveAX;
+            double relativeY = moveBY - moveAY;
+            double toiSlack = GJK_RELATIVE_EPSILON*size; //floats can't place them any closer than about this at their size
+            int ok = 1;
+            double end = 1;
+            toiTests++;
+            if(toi.hit) {
+                toiHits++;
+                Polygon movedB;
+                movePolygon(&movedB, &b, relativeX*toi.t, relativeY*toi.t);
+                double gap = bruteDistance(&a, &b, relativeX*toi.t, relativeY*toi.t);
+                if(toi.t < 0 || toi.t > 1 || satSeparation(&a, &movedB) < -toiSlack || gap > GJK_TOI_TOLERANCE + toiSlack) ok = 0;
+                end = toi.t;
+            }
+            for(int step = 0; step <= 64 && ok; ++step) {
+                double t = end*step / 64;
+                Polygon movedB;
+                movePolygon(&movedB, &b, relativeX*t, relativeY*t);
+                if(satSeparation(&a, &movedB) < -band) ok = 0;
+            }
+            if(!ok) {
+                if(toiWrong < 10) { printf("wrong time of impact: kind %d scale %g hit %d t %g\n", kind, scale, (int)toi.hit, (double)toi.t); }
+                toiWrong++;
+            }
+        }
+
+        //NOTE: Every contact point has to be on the incident side, and pushed out by its depth along the normal it has to land on the 
+        //reference side. Less than 3 points isn't a shape for the polygon versions.
+        if(a.count >= 3 && b.count >= 3) {
+            Gjk_Shape polygonA = gjk_polygonShape(a.points, a.count);
+            Gjk_Shape polygonB = gjk_polygonShape(b.points, b.count);
+            Gjk_Manifold manifold = gjk_shapesManifold(&polygonA, &polygonB);
+            double manifoldTolerance = 1e-3*size + band;
+            int ok = 1;
+            if(separation < -band && (!manifold.collided || manifold.pointCount < 1 || manifold.pointCount > 2)) ok = 0;
+            if(separation > band && manifold.collided) ok = 0;
+            for(int i = 0; i < manifold.pointCount && manifold.collided && ok && separation < -band; ++i) {
+                Gjk_ContactPoint *contact = manifold.points + i;
+                Polygon *reference = manifold.referenceIsB ? &b : &a;
+                Polygon *incident = manifold.referenceIsB ? &a : &b;
+                //NOTE: the manifold's normal points from b to a, the reference normal points out of the reference shape
+                double normalX = manifold.referenceIsB ? manifold.normal.x : -manifold.normal.x;
+                double normalY = manifold.referenceIsB ? manifold.normal.y : -manifold.normal.y;
+                double depth = contact->depth;
+                if(depth < -manifoldTolerance || depth > -separation + manifoldTolerance) ok = 0;
+                if(pointPolygonDistance(incident, contact->point.x, contact->point.y) > manifoldTolerance) ok = 0;
+                if(manifold.incidentEdge >= 0 && distanceFromSide(incident, manifold.incidentEdge, contact->point.x, contact->point.y) > manifoldTolerance) ok = 0;
+                if(manifold.referenceEdge >= 0 && manifold.incidentEdge >= 0) {
+                    double qx = contact->point.x + normalX*depth;
+                    double qy = contact->point.y + normalY*depth;
+                    if(pointPolygonDistance(reference, qx, qy) > manifoldTolerance || 
+                       distanceFromSide(reference, manifold.referenceEdge, qx, qy) > manifoldTolerance) {
+                        ok = 0;
+                    }
+                }
+            }
+
+            //NOTE: the cached version, on its second go, has to give the same contacts
+            Gjk_PairCache cache;
+            memset(&cache, 0, sizeof(cache));
+            gjk_shapesManifold_cached(&polygonA, &polygonB, &cache);
+            Gjk_Manifold cached = gjk_shapesManifold_cached(&polygonA, &polygonB, &cache);
+            if(fabs(separation) > band && (cached.collided != manifold.collided || fabs((double)cached.depth - manifold.depth) > manifoldTolerance)) ok = 0;
+            Gjk_Result cachedResult = gjk_shapesTest_cached(&polygonA, &polygonB, &cache);
+            if(fabs(separation) > band && cachedResult != polygonResult) ok = 0;
+
+            if(!ok) {
+                if(manifoldWrong < 10) {
+                    printf("wrong manifold: kind %d scale %g sat %g collided %d points %d depth %g (cached %d %g)\n", kind, scale, separation, 
+                           (int)manifold.collided, manifold.pointCount, (double)manifold.depth, (int)cached.collided, (double)cached.depth);
+                }
+                manifoldWrong++;
+            }
+        }
+
+        //NOTE: The cached test walks from point to neighbouring point, so it needs real polygons. Called twice so the second uses the cache.
+        if(a.count >= 3 && b.count >= 3) {
+            Gjk_PairCache cache;
+            memset(&cache, 0, sizeof(cache));
+            bool first = gjk_objectsCollide_cached(a.points, a.count, b.points, b.count, &cache);
+            bool second = gjk_objectsCollide_cached(a.points, a.count, b.points, b.count, &cache);
+            if((separation > band && (first || second)) || (separation < -band && (!first || !second))) {
+                if(wrong < 10) { printf("wrong cached answer: kind %d sat %g gave %d then %d\n", kind, separation, first, second); }
+                wrong++;
+            }
+        }
+    }
+
+    printf("%ld pairs (", pairCount);
+    for(int kind = 0; kind < PAIR_KIND_COUNT; ++kind) { printf("%s%ld", kind ? " " : "", kindCounts[kind]); }
+    printf(" of each kind)\n");
+    printf("separated %ld, overlapping %ld, touching %ld. Furthest touching pair from SAT: %g of their size\n", results[GJK_SEPARATED], results[GJK_OVERLAPPING],
+           results[GJK_TOUCHING], worstTouching);
+    printf("support calls per test: %.2f on average, %ld at most (GJK_MAX_ITERATIONS is %d)\n", (double)supportCalls / pairCount, maxSupportCalls, GJK_MAX_ITERATIONS);
+    printf("time of impact: %ld hits out of %ld throws\n", toiHits, toiTests);
+    printf("wrong answers %ld, wrong EPA %ld, wrong distance %ld, wrong time of impact %ld, wrong manifold %ld, gjk asserts %ld\n", wrong, epaWrong, 
+           distanceWrong, toiWrong, manifoldWrong, fuzz_asserts);
+    return (wrong || epaWrong || distanceWrong || toiWrong || manifoldWrong) ? 1 : 0;
+}
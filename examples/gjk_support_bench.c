@@ -0,0 +1,115 @@
+/*
+Times each support function kernel (the furthest point of a polygon in a direction) on its own at 4 to 2048 points, so the
+switch over points in easy_gjk.h can be checked: the plain loop below GJK_SIMD_MIN_POINTS (16), sse2 up to GJK_AVX_MIN_POINTS (512)
+on gjk_v2 arrays and GJK_AVX_MIN_POINTS_SOA (64) on a Gjk_SoaPolygon. The last column is what gjk picks at that size.
+It also checks every kernel picks the same point as the plain loop on random point clouds.
+
+gcc -std=c99 -O2 -I.. gjk_support_bench.c -o gjk_support_bench -lm
+*/
+#include "example_common.h"
+#include <math.h>
+
+#define GJK_IMPLEMENTATION 1
+#include "../easy_gjk.h"
+
+#define MAX_POINTS 2048
+#define SHAPE_COUNT 64
+#define BENCH_POINTS 10000000
+#define REPEATS 5
+
+static gjk_v2 shapes[SHAPE_COUNT][MAX_POINTS];
+static Gjk_SoaPolygon soaShapes[SHAPE_COUNT];
+
+static void makePolygon(gjk_v2 *points, int count) {
+    float radius = example_randomFloat(1, 3);
+    float rotation = example_randomFloat(0, 6.2831853f);
+    for(int i = 0; i < count; ++i) {
+        float angle = i*6.2831853f / count + rotation;
+        points[i] = gjk_V2(radius*cosf(angle), radius*sinf(angle));
+    }
+}
+
+static int checkKernelsAgree(void) {
+    static gjk_v2 points[MAX_POINTS];
+    int mismatches = 0;
+    Gjk_SimdLevel detected = gjk_getSimdLevel();
+
+    for(int iteration = 0; iteration < 20000; ++iteration) {
+        int count = 1 + (int)(example_random() % MAX_POINTS);
+        for(int i = 0; i < count; ++i) { points[i] = gjk_V2(example_randomFloat(-100, 100), example_randomFloat(-100, 100)); }
+        //NOTE: Repeated points make ties, which every kernel has to break the same way
+        if(iteration % 3 == 0) {
+            for(int i = 0; i < count; ++i) { points[i] = points[example_random() % (i + 1)]; }
+        }
+
+        gjk_v2 d = gjk_V2(example_randomFloat(-1, 1), example_randomFloat(-1, 1));
+        Gjk_SoaPolygon soa;
+        gjk_initSoaPolygon(&soa, points, count);
+        int expected = gjk_furthestPoint_scalar(points, count, d);
+        for(int level = GJK_SIMD_NONE; level <= (int)detected; ++level) {
+            gjk_setSimdLevel((Gjk_SimdLevel)level);
+            if(gjk_furthestPoint_(points, count, d) != expected) { mismatches++; }
+            if(gjk_furthestPointSoa_(&soa, d) != expected) { mismatches++; }
+        }
+        gjk_freeSoaPolygon(&soa);
+    }
+
+    gjk_setSimdLevel(detected);
+    return mismatches;
+}
+
+//NOTE: best of REPEATS, one run on its own moves around too much to see where the kernels cross over
+#define TIME_KERNEL(result, call) { \
+        volatile int sink = 0; \
+        result = 1e30; \
+        for(int repeat = 0; repeat < REPEATS; ++repeat) { \
+            double start = example_seconds(); \
+            for(int r = 0; r < reps; ++r) { \
+                gjk_v2 d = directions[r & 255]; \
+                int shape = r & (SHAPE_COUNT - 1); \
+                sink += call; \
+            } \
+            double nanoseconds = (example_seconds() - start)*1e9 / reps; \
+            if(nanoseconds < result) { result = nanoseconds; } \
+        } \
+        (void)sink; \
+    }
+
+int main(void) {
+    int mismatches = checkKernelsAgree();
+    printf("kernels that disagree with the plain loop: %d\n\n", mismatches);
+    if(mismatches) { return 1; }
+
+    gjk_v2 directions[256];
+    for(int i = 0; i < 256; ++i) { directions[i] = gjk_V2(cosf((float)i), sinf((float)i)); }
+
+    int sizes[] = {4, 8, 16, 32, 64, 128, 256, 512, 1024, 2048};
+    printf("  points   scalar     sse2      avx | soa sse2  soa avx |   picked  soa picked (ns per call)\n");
+    for(int sizeIndex = 0; sizeIndex < (int)(sizeof(sizes) / sizeof(sizes[0])); ++sizeIndex) {
+        int count = sizes[sizeIndex];
+        int reps = BENCH_POINTS / count + 100000;
+        for(int shape = 0; shape < SHAPE_COUNT; ++shape) {
+            makePolygon(shapes[shape], count);
+            gjk_initSoaPolygon(&soaShapes[shape], shapes[shape], count);
+        }
+
+        double scalar = 0, sse2 = 0, avx = 0, soaSse2 = 0, soaAvx = 0, picked = 0, soaPicked = 0;
+        TIME_KERNEL(scalar, gjk_furthestPoint_scalar(shapes[shape], count, d));
+#if GJK_X86
+        int padded = gjk_paddedCount_(count);
+        TIME_KERNEL(sse2, gjk_furthestPoint_sse2(shapes[shape], count, d));
+        TIME_KERNEL(soaSse2, gjk_furthestPointSoa_sse2(soaShapes[shape].x, soaShapes[shape].y, padded, d));
+        if(gjk_getSimdLevel() == GJK_SIMD_AVX) {
+            TIME_KERNEL(avx, gjk_furthestPoint_avx(shapes[shape], count, d));
+            TIME_KERNEL(soaAvx, gjk_furthestPointSoa_avx(soaShapes[shape].x, soaShapes[shape].y, padded, d));
+        }
+#endif
+        TIME_KERNEL(picked, gjk_furthestPoint_(shapes[shape], count, d));
+        TIME_KERNEL(soaPicked, gjk_furthestPointSoa_(&soaShapes[shape], d));
+
+        printf("%8d %8.1f %8.1f %8.1f | %8.1f %8.1f | %8.1f %8.1f\n", count, scalar, sse2, avx, soaSse2, soaAvx, picked, soaPicked);
+
+        for(int shape = 0; shape < SHAPE_COUNT; ++shape) { gjk_freeSoaPolygon(&soaShapes[shape]); }
+    }
+    return 0;
+}
@@ -0,0 +1,132 @@
+/*
+Checks easyString_compare & the stringsMatch functions against strcmp on random strings at every simd level, then times them against memcmp & strcmp.
+
+gcc -std=c99 -O2 -I.. string_compare_bench.c -o string_compare_bench
+*/
+#include "example_common.h"
+
+#define EASY_STRING_IMPLEMENTATION 1
+#include "../easy_string_utf8.h"
+
+#define FUZZ_ITERATIONS 1000000
+#define FUZZ_MAX_LENGTH 70
+
+static int sign(int x) {
+    return (x > 0) - (x < 0);
+}
+
+static int fuzzCompare(void) {
+    //NOTE: The strings sit right at the end of their buffers so the simd paths have to stop at the terminator
+    char *bufferA = (char *)malloc(FUZZ_MAX_LENGTH + 1);
+    char *bufferB = (char *)malloc(FUZZ_MAX_LENGTH + 1);
+    EasyString_SimdLevel detected = easyString_getSimdLevel();
+    int failed = 0;
+
+    for(int iteration = 0; iteration < FUZZ_ITERATIONS && !failed; ++iteration) {
+        easyString_setSimdLevel((EasyString_SimdLevel)(iteration % 4));
+
+        int lengthA = (int)(example_random() % FUZZ_MAX_LENGTH);
+        int lengthB = (example_random() % 3 == 0) ? lengthA : (int)(example_random() % FUZZ_MAX_LENGTH);
+        char *a = bufferA + FUZZ_MAX_LENGTH - lengthA;
+        char *b = bufferB + FUZZ_MAX_LENGTH - lengthB;
+
+        //NOTE: Only two letters so most pairs share a long prefix
+        for(int i = 0; i < lengthA; ++i) { a[i] = (char)('a' + example_random() % 2); }
+        for(int i = 0; i < lengthB; ++i) { b[i] = (i < lengthA && example_random() % 20) ? a[i] : (char)('a' + example_random() % 2); }
+        if(lengthA && example_random() % 4 == 0) { a[example_random() % lengthA] = (char)0xE1; } //check the compare is unsigned
+        a[lengthA] = 0;
+        b[lengthB] = 0;
+
+        int expected = sign(strcmp(a, b));
+        int compare = sign(easyString_compare(a, lengthA, b, lengthB));
+        int compareNull = sign(easyString_compare_nullTerminated(a, b));
+        int match = easyString_stringsMatch_withCount(a, lengthA, b, lengthB);
+        int matchNull = easyString_stringsMatch_nullTerminated(a, b);
+        int matchNullAndCount = easyString_stringsMatch_null_and_count(a, b, lengthB);
+
+        if(compare != expected || compareNull != expected || match != (expected == 0) || matchNull != (expected == 0) || matchNullAndCount != (expected == 0)) {
+            printf("mismatch at iteration %d, lengths %d %d: strcmp %d compare %d compare_nullTerminated %d matches %d %d %d\n", iteration, lengthA, lengthB, expected, compare, compareNull, match, matchNull, matchNullAndCount);
+            failed = 1;
+        }
+    }
+
+    free(bufferA);
+    free(bufferB);
+    easyString_setSimdLevel(detected);
+    return failed;
+}
+
+//NOTE: Long strings starting on either side of a page end, in both orders, so the simd paths have to get the page crossing right
+#define PAGE_FUZZ_ITERATIONS 300000
+#define PAGE_FUZZ_MAX_LENGTH 300
+
+static int fuzzPageCrossing(void) {
+    static char buffer[4*4096];
+    char *pageEnd = buffer + 2*4096 - ((size_t)buffer % 4096);
+    EasyString_SimdLevel detected = easyString_getSimdLevel();
+    int failed = 0;
+
+    for(int iteration = 0; iteration < PAGE_FUZZ_ITERATIONS && !failed; ++iteration) {
+        easyString_setSimdLevel((EasyString_SimdLevel)(iteration % 4));
+
+        int length = (int)(example_random() % PAGE_FUZZ_MAX_LENGTH);
+        char *a = pageEnd - 1 - (int)(example_random() % PAGE_FUZZ_MAX_LENGTH);
+        char *b = pageEnd - 4096 + 1 + (int)(example_random() % (4096 - PAGE_FUZZ_MAX_LENGTH - 2)); //anywhere in the page before
+        if(iteration & 4) { char *swap = a; a = b; b = swap; }
+        for(int i = 0; i < length; ++i) { a[i] = b[i] = (char)('a' + example_random() % 26); }
+        a[length] = b[length] = 0;
+        if(length && example_random() % 2) { b[example_random() % length] ^= 1; }
+
+        int expected = sign(strcmp(a, b));
+        if(sign(easyString_compare_nullTerminated(a, b)) != expected || easyString_stringsMatch_nullTerminated(a, b) != (expected == 0) ||
+           sign(easyString_compare(a, length, b, length)) != expected) {
+            printf("page crossing mismatch at iteration %d, length %d\n", iteration, length);
+            failed = 1;
+        }
+    }
+
+    easyString_setSimdLevel(detected);
+    return failed;
+}
+
+//NOTE: Best of a few runs, one run on a busy machine can be off by 2x
+#define BENCH_BYTES 20000000
+#define REPEATS 15
+#define TIME_BEST(best, expression) do { \
+    best = 1e30; \
+    for(int repeat = 0; repeat < REPEATS; ++repeat) { \
+        double start = example_seconds(); \
+        for(int k = 0; k < reps; ++k) { sink += (expression); example_barrier(); } \
+        double time = (example_seconds() - start)*1e9 / reps; \
+        if(time < best) { best = time; } \
+    } \
+} while(0)
+
+int main(void) {
+    if(fuzzCompare()) { return 1; }
+    if(fuzzPageCrossing()) { return 1; }
+    printf("%d random pairs (and %d across page ends) agree with strcmp at every simd level\n\n", FUZZ_ITERATIONS, PAGE_FUZZ_ITERATIONS);
+
+    static char a[4097];
+    static char b[4097];
+    int sizes[] = {4, 8, 16, 24, 32, 64, 256, 4096};
+    volatile int sink = 0;
+
+    //NOTE: Equal strings, so every function has to look at every byte
+    for(int sizeIndex = 0; sizeIndex < (int)(sizeof(sizes) / sizeof(sizes[0])); ++sizeIndex) {
+        int size = sizes[sizeIndex];
+        int reps = BENCH_BYTES / (size + 16);
+        for(int i = 0; i < size; ++i) { a[i] = b[i] = (char)('a' + i % 26); }
+        a[size] = b[size] = 0;
+
+        double memcmpTime, compareTime, strcmpTime, compareNullTime;
+        TIME_BEST(memcmpTime, memcmp(a, b, size));
+        TIME_BEST(compareTime, easyString_compare(a, size, b, size));
+        TIME_BEST(strcmpTime, strcmp(a, b));
+        TIME_BEST(compareNullTime, easyString_compare_nullTerminated(a, b));
+
+        printf("%5d bytes: memcmp %6.2f ns  easyString_compare %6.2f ns  |  strcmp %6.2f ns  easyString_compare_nullTerminated %6.2f ns\n", size,
+               memcmpTime, compareTime, strcmpTime, compareNullTime);
+    }
+    return 0;
+}
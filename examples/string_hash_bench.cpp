@@ -0,0 +1,109 @@
+/*
+Checks easyString_hash64 gives the same hash at every simd level & in the constexpr version, then times it against FNV-1a and std::hash.
+
+g++ -std=c++17 -O2 -I.. string_hash_bench.cpp -o string_hash_bench
+*/
+#include "example_common.h"
+
+#include <string_view>
+#include <functional>
+
+#define EASY_STRING_IMPLEMENTATION 1
+#include "../easy_string_utf8.h"
+
+//NOTE: The literal macro has to work in a constant expression, i.e. a case label
+static_assert(EASY_STRING_HASH_LITERAL("walk_left", 0) != 0, "hash literal isn't constexpr");
+constexpr unsigned long long walkLeftHash = EASY_STRING_HASH_LITERAL("walk_left", 7);
+
+static unsigned long long fnv1a64(const char *string, size_t length) {
+    unsigned long long hash = 0xcbf29ce484222325ULL;
+    for(size_t i = 0; i < length; ++i) {
+        hash ^= (unsigned char)string[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+static int countBits(unsigned long long x) {
+    int result = 0;
+    while(x) { x &= x - 1; result++; }
+    return result;
+}
+
+#define BUFFER_SIZE 8192
+#define BENCH_BYTES 40000000L
+#define REPEATS 10
+
+int main(void) {
+    static char buffer[BUFFER_SIZE];
+    for(int i = 0; i < BUFFER_SIZE; ++i) { buffer[i] = (char)(i*131 + 7); }
+
+    if(easyString_hash64((char *)"walk_left", 9, 7) != walkLeftHash) {
+        printf("the constexpr hash doesn't match the runtime one\n");
+        return 1;
+    }
+
+    //NOTE: Every length up to well past the 256 byte switch to the long hash, and unaligned starts
+    EasyString_SimdLevel detected = easyString_getSimdLevel();
+    for(size_t length = 0; length < 3000; ++length) {
+        for(unsigned long long seed = 0; seed < 3; ++seed) {
+            unsigned long long expected = easyString_hash64_constexpr(buffer + seed, length, seed);
+            for(int level = EASY_STRING_SIMD_NONE; level <= EASY_STRING_SIMD_AVX2; ++level) {
+                easyString_setSimdLevel((EasyString_SimdLevel)level);
+                if(easyString_hash64(buffer + seed, length, seed) != expected) {
+                    printf("hash mismatch at length %zu seed %llu simd level %d\n", length, seed, level);
+                    return 1;
+                }
+            }
+        }
+    }
+    easyString_setSimdLevel(detected);
+    printf("every simd level and the constexpr hash agree\n");
+
+    //NOTE: Flipping one input bit should flip about half of the 64 output bits
+    double flippedBits = 0;
+    int flips = 0;
+    for(int length = 1; length < 600; length += 7) {
+        for(int bit = 0; bit < length*8; bit += 5) {
+            unsigned long long before = easyString_hash64(buffer, length, 0);
+            buffer[bit / 8] ^= (char)(1 << (bit % 8));
+            unsigned long long after = easyString_hash64(buffer, length, 0);
+            buffer[bit / 8] ^= (char)(1 << (bit % 8));
+            flippedBits += countBits(before ^ after);
+            flips++;
+        }
+    }
+    printf("one bit in flips %.2f bits out on average (32 is ideal)\n\n", flippedBits / flips);
+
+    //NOTE: Best of a few runs, and the hashes are summed in a local so the loop isn't waiting on a store to sink every time
+    int lengths[] = {4, 8, 16, 32, 64, 256, 1024, 4096};
+    volatile unsigned long long sink = 0;
+    for(int lengthIndex = 0; lengthIndex < (int)(sizeof(lengths) / sizeof(lengths[0])); ++lengthIndex) {
+        int length = lengths[lengthIndex];
+        long reps = BENCH_BYTES / (length + 32);
+        double easyTime = 1e30, fnvTime = 1e30, stdTime = 1e30;
+        for(int repeat = 0; repeat < REPEATS; ++repeat) {
+            unsigned long long total = 0;
+            double start = example_seconds();
+            for(long k = 0; k < reps; ++k) { total += easyString_hash64(buffer + (k & 7), length, 0); }
+            double time = example_seconds() - start;
+            if(time < easyTime) { easyTime = time; }
+
+            start = example_seconds();
+            for(long k = 0; k < reps; ++k) { total += fnv1a64(buffer + (k & 7), length); }
+            time = example_seconds() - start;
+            if(time < fnvTime) { fnvTime = time; }
+
+            start = example_seconds();
+            for(long k = 0; k < reps; ++k) { total += std::hash<std::string_view>()(std::string_view(buffer + (k & 7), length)); }
+            time = example_seconds() - start;
+            if(time < stdTime) { stdTime = time; }
+            sink = total;
+        }
+
+        (void)sink;
+        printf("%5d bytes: easyString_hash64 %6.2f ns  FNV-1a %6.2f ns  std::hash %6.2f ns\n", length,
+               easyTime*1e9 / reps, fnvTime*1e9 / reps, stdTime*1e9 / reps);
+    }
+    return 0;
+}
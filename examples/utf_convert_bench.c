@@ -0,0 +1,76 @@
+/*
+Throughput of every utf conversion direction at each simd level, in millions of codepoints a second, for mostly ascii,
+cyrillic (2 byte utf8) and cjk (3 byte utf8) text.
+
+gcc -std=c99 -O2 -I.. utf_convert_bench.c -o utf_convert_bench
+*/
+#include "example_common.h"
+
+#define EASY_STRING_IMPLEMENTATION 1
+#include "../easy_string_utf8.h"
+
+#define CODEPOINT_COUNT (1 << 20)
+#define REPEATS 20
+
+static unsigned int text32[CODEPOINT_COUNT];
+static unsigned short text16[CODEPOINT_COUNT*2];
+static char text8[CODEPOINT_COUNT*4];
+static unsigned int out32[CODEPOINT_COUNT];
+static unsigned short out16[CODEPOINT_COUNT*2];
+static char out8[CODEPOINT_COUNT*4];
+
+static unsigned int randomCodepoint(int kind) {
+    switch(kind) {
+        case 0: return 32 + example_random() % 90;
+        case 1: return (example_random() % 5 == 0) ? 32 : 0x430 + example_random() % 32;
+        default: return (example_random() % 8 == 0) ? 32 : 0x4E00 + example_random() % 2000;
+    }
+}
+
+int main(void) {
+    const char *kindNames[] = {"ascii", "cyrillic", "cjk"};
+    const char *levelNames[] = {"scalar", "sse2", "ssse3", "avx2"};
+    EasyString_SimdLevel detected = easyString_getSimdLevel();
+
+    for(int kind = 0; kind < 3; ++kind) {
+        for(int i = 0; i < CODEPOINT_COUNT; ++i) { text32[i] = randomCodepoint(kind); }
+        size_t length8 = easyUnicode_utf32ToUtf8(text32, CODEPOINT_COUNT, text8, sizeof(text8), EASY_UNICODE_REPLACE_INVALID).codeUnitsWritten;
+        size_t length16 = easyUnicode_utf32ToUtf16(text32, CODEPOINT_COUNT, text16, CODEPOINT_COUNT*2, EASY_UNICODE_REPLACE_INVALID).codeUnitsWritten;
+
+        for(int level = EASY_STRING_SIMD_NONE; level <= (int)detected; ++level) {
+            easyString_setSimdLevel((EasyString_SimdLevel)level);
+            double seconds[6];
+
+            double start = example_seconds();
+            for(int r = 0; r < REPEATS; ++r) { easyUnicode_utf8ToUtf32(text8, length8, out32, CODEPOINT_COUNT); example_barrier(); }
+            seconds[0] = example_seconds() - start;
+
+            start = example_seconds();
+            for(int r = 0; r < REPEATS; ++r) { easyUnicode_utf32ToUtf8(text32, CODEPOINT_COUNT, out8, sizeof(out8), EASY_UNICODE_REPLACE_INVALID); example_barrier(); }
+            seconds[1] = example_seconds() - start;
+
+            start = example_seconds();
+            for(int r = 0; r < REPEATS; ++r) { easyUnicode_utf16ToUtf8(text16, length16, out8, sizeof(out8), EASY_UNICODE_REPLACE_INVALID); example_barrier(); }
+            seconds[2] = example_seconds() - start;
+
+            start = example_seconds();
+            for(int r = 0; r < REPEATS; ++r) { easyUnicode_utf8ToUtf16(text8, length8, out16, CODEPOINT_COUNT*2, EASY_UNICODE_REPLACE_INVALID); example_barrier(); }
+            seconds[3] = example_seconds() - start;
+
+            start = example_seconds();
+            for(int r = 0; r < REPEATS; ++r) { easyUnicode_utf16ToUtf32(text16, length16, out32, CODEPOINT_COUNT, EASY_UNICODE_REPLACE_INVALID); example_barrier(); }
+            seconds[4] = example_seconds() - start;
+
+            start = example_seconds();
+            for(int r = 0; r < REPEATS; ++r) { easyUnicode_utf32ToUtf16(text32, CODEPOINT_COUNT, out16, CODEPOINT_COUNT*2, EASY_UNICODE_REPLACE_INVALID); example_barrier(); }
+            seconds[5] = example_seconds() - start;
+
+            double codepoints = (double)CODEPOINT_COUNT*REPEATS / 1e6;
+            printf("%-8s %-6s Mcp/s: 8->32 %5.0f  32->8 %5.0f  16->8 %5.0f  8->16 %5.0f  16->32 %5.0f  32->16 %5.0f\n", kindNames[kind], levelNames[level],
+                   codepoints / seconds[0], codepoints / seconds[1], codepoints / seconds[2], codepoints / seconds[3], codepoints / seconds[4], codepoints / seconds[5]);
+        }
+    }
+
+    easyString_setSimdLevel(detected);
+    return 0;
+}
@@ -0,0 +1,259 @@
+/*
+Round trip fuzz for the utf8/utf16/utf32 conversions. Random codepoints (sometimes with surrogates & out of range values mixed in) are
+converted every way at every simd level and checked against the simple one-codepoint-at-a-time encoders below, in one call and
+in small chunks of output, with both invalid policies.
+
+gcc -std=c99 -O2 -I.. utf_convert_fuzz.c -o utf_convert_fuzz
+*/
+#include "example_common.h"
+
+#define EASY_STRING_IMPLEMENTATION 1
+#include "../easy_string_utf8.h"
+
+#define FUZZ_ITERATIONS 20000
+#define MAX_CODEPOINTS 3000
+
+static int isBadCodepoint(unsigned int codepoint) {
+    return codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF);
+}
+
+static unsigned int randomCodepoint(int validOnly) {
+    //NOTE: Spread over the 1, 2, 3 & 4 byte ranges
+    unsigned int kind = example_random() % 10;
+    unsigned int codepoint;
+    if(kind < 3) { codepoint = example_random() % 0x80; }
+    else if(kind < 5) { codepoint = 0x80 + example_random() % 0x780; }
+    else if(kind < 8) { codepoint = 0x800 + example_random() % 0xF800; }
+    else { codepoint = 0x10000 + example_random() % 0x100000; }
+
+    if(validOnly && codepoint >= 0xD800 && codepoint <= 0xDFFF) { codepoint -= 0x800; }
+    if(!validOnly && example_random() % 8 == 0) {
+        codepoint = (example_random() % 2) ? 0xD800 + example_random() % 0x800 : 0x110000 + example_random() % 0x1000000;
+    }
+    return codepoint;
+}
+
+///////////////////////*********** Reference encoders **************////////////////////
+
+static size_t reference32To8(unsigned int *src, size_t count, unsigned char *dst) {
+    size_t at = 0;
+    for(size_t i = 0; i < count; ++i) {
+        unsigned int c = isBadCodepoint(src[i]) ? EASY_UNICODE_REPLACEMENT_CHARACTER : src[i];
+        if(c < 0x80) {
+            dst[at++] = (unsigned char)c;
+        } else if(c < 0x800) {
+            dst[at++] = (unsigned char)(0xC0 | (c >> 6));
+            dst[at++] = (unsigned char)(0x80 | (c & 0x3F));
+        } else if(c < 0x10000) {
+            dst[at++] = (unsigned char)(0xE0 | (c >> 12));
+            dst[at++] = (unsigned char)(0x80 | ((c >> 6) & 0x3F));
+            dst[at++] = (unsigned char)(0x80 | (c & 0x3F));
+        } else {
+            dst[at++] = (unsigned char)(0xF0 | (c >> 18));
+            dst[at++] = (unsigned char)(0x80 | ((c >> 12) & 0x3F));
+            dst[at++] = (unsigned char)(0x80 | ((c >> 6) & 0x3F));
+            dst[at++] = (unsigned char)(0x80 | (c & 0x3F));
+        }
+    }
+    return at;
+}
+
+static size_t reference32To16(unsigned int *src, size_t count, unsigned short *dst) {
+    size_t at = 0;
+    for(size_t i = 0; i < count; ++i) {
+        unsigned int c = isBadCodepoint(src[i]) ? EASY_UNICODE_REPLACEMENT_CHARACTER : src[i];
+        if(c >= 0x10000) {
+            dst[at++] = (unsigned short)(0xD800 + ((c - 0x10000) >> 10));
+            dst[at++] = (unsigned short)(0xDC00 + ((c - 0x10000) & 0x3FF));
+        } else {
+            dst[at++] = (unsigned short)c;
+        }
+    }
+    return at;
+}
+
+static size_t reference16To32(unsigned short *src, size_t count, unsigned int *dst) {
+    size_t at = 0;
+    for(size_t i = 0; i < count; ++i) {
+        unsigned int unit = src[i];
+        if(unit >= 0xD800 && unit < 0xDC00 && i + 1 < count && src[i + 1] >= 0xDC00 && src[i + 1] < 0xE000) {
+            dst[at++] = 0x10000 + ((unit - 0xD800) << 10) + (src[i + 1] - 0xDC00);
+            i++;
+        } else if(unit >= 0xD800 && unit < 0xE000) {
+            dst[at++] = EASY_UNICODE_REPLACEMENT_CHARACTER; //lone surrogate
+        } else {
+            dst[at++] = unit;
+        }
+    }
+    return at;
+}
+
+///////////////////////*********** Fuzz **************////////////////////
+
+static unsigned int codepoints[MAX_CODEPOINTS];
+static unsigned int expected32[MAX_CODEPOINTS*4];
+static unsigned int out32[MAX_CODEPOINTS*4];
+static unsigned short input16[MAX_CODEPOINTS*4];
+static unsigned short expected16[MAX_CODEPOINTS*4];
+static unsigned short out16[MAX_CODEPOINTS*4];
+static unsigned char input8[MAX_CODEPOINTS*8];
+static unsigned char expected8[MAX_CODEPOINTS*8];
+static unsigned char out8[MAX_CODEPOINTS*8];
+
+static int fuzzLevel_;
+static int fuzzIteration_;
+
+#define CHECK(condition) do { if(!(condition)) { printf("failed %s on line %d at simd level %d iteration %d\n", #condition, __LINE__, fuzzLevel_, fuzzIteration_); exit(1); } } while(0)
+
+//NOTE: Random output caps so the conversions have to stop part way through a codepoint's units and pick up again
+static size_t randomCap(size_t written, size_t total, unsigned int maxCap) {
+    size_t cap = example_random() % maxCap;
+    if(written + cap > total) { cap = total - written; }
+    return cap;
+}
+
+static void fuzzUtf32ToUtf8(size_t count, int validOnly) {
+    size_t expectedLength = reference32To8(codepoints, count, expected8);
+    CHECK(easyUnicode_utf32ToUtf8_requiredSize(codepoints, count) == expectedLength);
+
+    EasyUnicode_Result result = easyUnicode_utf32ToUtf8(codepoints, count, (char *)out8, expectedLength, EASY_UNICODE_REPLACE_INVALID);
+    CHECK(result.status == EASY_UNICODE_OK && result.codeUnitsWritten == expectedLength && result.codeUnitsConsumed == count);
+    CHECK(memcmp(out8, expected8, expectedLength) == 0);
+    if(validOnly) { CHECK(result.error == EASY_UNICODE_ERROR_NONE); }
+
+    size_t written = 0;
+    size_t consumed = 0;
+    while(consumed < count) {
+        size_t cap = randomCap(written, expectedLength, 20);
+        EasyUnicode_Result part = easyUnicode_utf32ToUtf8(codepoints + consumed, count - consumed, (char *)out8 + written, cap, EASY_UNICODE_REPLACE_INVALID);
+        CHECK(part.status == EASY_UNICODE_OK || part.status == EASY_UNICODE_OUTPUT_FULL);
+        written += part.codeUnitsWritten;
+        consumed += part.codeUnitsConsumed;
+    }
+    CHECK(written == expectedLength && memcmp(out8, expected8, expectedLength) == 0);
+
+    //NOTE: Stopping has to land exactly on the first bad codepoint with everything before it written
+    size_t firstBad = count;
+    for(size_t i = 0; i < count; ++i) {
+        if(isBadCodepoint(codepoints[i])) { firstBad = i; break; }
+    }
+    result = easyUnicode_utf32ToUtf8(codepoints, count, (char *)out8, expectedLength, EASY_UNICODE_STOP_ON_INVALID);
+    CHECK(result.codeUnitsConsumed == firstBad);
+    CHECK(result.status == ((firstBad == count) ? EASY_UNICODE_OK : EASY_UNICODE_INVALID));
+    CHECK(memcmp(out8, expected8, result.codeUnitsWritten) == 0);
+}
+
+static size_t fuzzUtf32ToUtf16(size_t count) {
+    size_t expectedLength = reference32To16(codepoints, count, expected16);
+    CHECK(easyUnicode_utf32ToUtf16_requiredSize(codepoints, count) == expectedLength);
+
+    EasyUnicode_Result result = easyUnicode_utf32ToUtf16(codepoints, count, out16, expectedLength, EASY_UNICODE_REPLACE_INVALID);
+    CHECK(result.status == EASY_UNICODE_OK && result.codeUnitsWritten == expectedLength && result.codeUnitsConsumed == count);
+    CHECK(memcmp(out16, expected16, expectedLength*sizeof(unsigned short)) == 0);
+    return expectedLength;
+}
+
+static void fuzzUtf16(size_t count16, int validOnly) {
+    memcpy(input16, expected16, count16*sizeof(unsigned short));
+    if(!validOnly && count16) {
+        for(int i = 0; i < 3; ++i) { input16[example_random() % count16] = (unsigned short)(0xD800 + example_random() % 0x800); }
+    }
+
+    //NOTE: utf16 -> utf32
+    size_t expectedLength = reference16To32(input16, count16, expected32);
+    CHECK(easyUnicode_utf16ToUtf32_requiredSize(input16, count16) == expectedLength);
+
+    EasyUnicode_Result result = easyUnicode_utf16ToUtf32(input16, count16, out32, expectedLength, EASY_UNICODE_REPLACE_INVALID);
+    CHECK(result.status == EASY_UNICODE_OK && result.codeUnitsWritten == expectedLength && result.codeUnitsConsumed == count16);
+    CHECK(memcmp(out32, expected32, expectedLength*sizeof(unsigned int)) == 0);
+
+    size_t written = 0;
+    size_t consumed = 0;
+    while(consumed < count16) {
+        size_t cap = randomCap(written, expectedLength, 20);
+        EasyUnicode_Result part = easyUnicode_utf16ToUtf32(input16 + consumed, count16 - consumed, out32 + written, cap, EASY_UNICODE_REPLACE_INVALID);
+        written += part.codeUnitsWritten;
+        consumed += part.codeUnitsConsumed;
+    }
+    CHECK(written == expectedLength && memcmp(out32, expected32, expectedLength*sizeof(unsigned int)) == 0);
+
+    //NOTE: utf16 -> utf8, the reference is the utf32 we just checked
+    size_t expectedLength8 = reference32To8(expected32, expectedLength, expected8);
+    CHECK(easyUnicode_utf16ToUtf8_requiredSize(input16, count16) == expectedLength8);
+
+    result = easyUnicode_utf16ToUtf8(input16, count16, (char *)out8, expectedLength8, EASY_UNICODE_REPLACE_INVALID);
+    CHECK(result.status == EASY_UNICODE_OK && result.codeUnitsWritten == expectedLength8 && result.codeUnitsConsumed == count16);
+    CHECK(memcmp(out8, expected8, expectedLength8) == 0);
+
+    written = 0;
+    consumed = 0;
+    while(consumed < count16) {
+        size_t cap = randomCap(written, expectedLength8, 30);
+        EasyUnicode_Result part = easyUnicode_utf16ToUtf8(input16 + consumed, count16 - consumed, (char *)out8 + written, cap, EASY_UNICODE_REPLACE_INVALID);
+        written += part.codeUnitsWritten;
+        consumed += part.codeUnitsConsumed;
+    }
+    CHECK(written == expectedLength8 && memcmp(out8, expected8, expectedLength8) == 0);
+
+    //NOTE: A high surrogate at the very end is half a codepoint, not an error yet
+    if(validOnly && count16 && (expected16[count16 - 1] & 0xFC00) == 0xDC00) {
+        result = easyUnicode_utf16ToUtf8(expected16, count16 - 1, (char *)out8, sizeof(out8), EASY_UNICODE_STOP_ON_INVALID);
+        CHECK(result.status == EASY_UNICODE_NEED_MORE_INPUT && result.error == EASY_UNICODE_ERROR_TRUNCATED);
+    }
+}
+
+static void fuzzUtf8ToUtf16(size_t length8, int validOnly) {
+    memcpy(input8, expected8, length8);
+    if(!validOnly && length8) {
+        for(int i = 0; i < 3; ++i) { input8[example_random() % length8] = (unsigned char)example_random(); }
+    }
+
+    //NOTE: The validating utf8 -> utf32 decoder is the reference for how broken utf8 gets replaced
+    EasyUnicode_Result decoded = easyUnicode_utf8ToUtf32_validating((char *)input8, length8, expected32, MAX_CODEPOINTS*4, EASY_UNICODE_REPLACE_INVALID);
+    size_t expectedLength = reference32To16(expected32, decoded.codeUnitsWritten, expected16);
+    CHECK(easyUnicode_utf8ToUtf16_requiredSize((char *)input8, length8) == expectedLength);
+
+    EasyUnicode_Result result = easyUnicode_utf8ToUtf16((char *)input8, length8, out16, expectedLength, EASY_UNICODE_REPLACE_INVALID);
+    CHECK(result.status == EASY_UNICODE_OK && result.codeUnitsWritten == expectedLength && result.codeUnitsConsumed == length8);
+    CHECK(memcmp(out16, expected16, expectedLength*sizeof(unsigned short)) == 0);
+    CHECK(result.error == decoded.error);
+
+    size_t written = 0;
+    size_t consumed = 0;
+    while(consumed < length8) {
+        size_t cap = randomCap(written, expectedLength, 20);
+        EasyUnicode_Result part = easyUnicode_utf8ToUtf16((char *)input8 + consumed, length8 - consumed, out16 + written, cap, EASY_UNICODE_REPLACE_INVALID);
+        written += part.codeUnitsWritten;
+        consumed += part.codeUnitsConsumed;
+    }
+    CHECK(written == expectedLength && memcmp(out16, expected16, expectedLength*sizeof(unsigned short)) == 0);
+
+    //NOTE: Both decoders have to stop at the same byte for the same reason
+    EasyUnicode_Result stop32 = easyUnicode_utf8ToUtf32_validating((char *)input8, length8, out32, MAX_CODEPOINTS*4, EASY_UNICODE_STOP_ON_INVALID);
+    EasyUnicode_Result stop16 = easyUnicode_utf8ToUtf16((char *)input8, length8, out16, expectedLength, EASY_UNICODE_STOP_ON_INVALID);
+    CHECK(stop32.status == stop16.status && stop32.codeUnitsConsumed == stop16.codeUnitsConsumed && stop32.error == stop16.error);
+}
+
+int main(void) {
+    EasyString_SimdLevel detected = easyString_getSimdLevel();
+
+    for(fuzzLevel_ = EASY_STRING_SIMD_NONE; fuzzLevel_ <= EASY_STRING_SIMD_AVX2; ++fuzzLevel_) {
+        easyString_setSimdLevel((EasyString_SimdLevel)fuzzLevel_);
+
+        for(fuzzIteration_ = 0; fuzzIteration_ < FUZZ_ITERATIONS; ++fuzzIteration_) {
+            int validOnly = fuzzIteration_ % 2;
+            //NOTE: Mostly short strings so the simd loops' tails get hit, with a long one now and then
+            size_t count = example_random() % ((fuzzIteration_ % 7 == 0) ? MAX_CODEPOINTS : 40);
+            for(size_t i = 0; i < count; ++i) { codepoints[i] = randomCodepoint(validOnly); }
+
+            fuzzUtf32ToUtf8(count, validOnly);
+            size_t count16 = fuzzUtf32ToUtf16(count);
+            fuzzUtf16(count16, validOnly);
+            fuzzUtf8ToUtf16(reference32To8(codepoints, count, expected8), validOnly);
+        }
+    }
+
+    easyString_setSimdLevel(detected);
+    printf("%d random strings round trip at every simd level\n", FUZZ_ITERATIONS);
+    return 0;
+}